@@ -60,6 +60,13 @@ typedef enum SDL_ShaderCross_ShaderStage
    SDL_SHADERCROSS_SHADERSTAGE_COMPUTE
 } SDL_ShaderCross_ShaderStage;
 
+typedef enum SDL_ShaderCross_SPIRVOptimization
+{
+    SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE,         /**< Leave the SPIR-V as it is. */
+    SDL_SHADERCROSS_SPIRVOPTIMIZATION_PERFORMANCE,  /**< The SPIRV-Tools performance recipe, as with `spirv-opt -O`. */
+    SDL_SHADERCROSS_SPIRVOPTIMIZATION_SIZE          /**< The SPIRV-Tools size recipe, as with `spirv-opt -Os`. */
+} SDL_ShaderCross_SPIRVOptimization;
+
 typedef struct SDL_ShaderCross_IOVarMetadata {
     char *name;                             /**< The UTF-8 name of the variable. */
     Uint32 location;                        /**< The location of the variable. */
@@ -97,6 +104,136 @@ typedef struct SDL_ShaderCross_ComputePipelineMetadata
     Uint32 threadcount_z;                   /**< The number of threads in the Z dimension. */
 } SDL_ShaderCross_ComputePipelineMetadata;
 
+typedef struct SDL_ShaderCross_SPIRVEntryPointOutput
+{
+    const char *spirv_entrypoint;                                 /**< The name of the entry point in the SPIRV module. */
+    const char *entrypoint;                                       /**< The name to create the shader with, which differs from spirv_entrypoint on MSL when the name is reserved. */
+    SDL_ShaderCross_ShaderStage shader_stage;                     /**< The shader stage of the entry point. */
+    void *code;                                                   /**< The compiled shader. */
+    size_t code_size;                                             /**< The size of the compiled shader in bytes. */
+    SDL_ShaderCross_GraphicsShaderMetadata *graphics_metadata;    /**< The reflected metadata of a vertex or fragment entry point, NULL for compute. */
+    SDL_ShaderCross_ComputePipelineMetadata *compute_metadata;    /**< The reflected metadata of a compute entry point, NULL otherwise. */
+} SDL_ShaderCross_SPIRVEntryPointOutput;
+
+typedef enum SDL_ShaderCross_MSLArgumentType
+{
+    SDL_SHADERCROSS_MSLARGUMENTTYPE_SAMPLED_TEXTURE,  /**< A texture and its sampler. */
+    SDL_SHADERCROSS_MSLARGUMENTTYPE_STORAGE_TEXTURE,  /**< A readonly or read-write storage texture. */
+    SDL_SHADERCROSS_MSLARGUMENTTYPE_STORAGE_BUFFER    /**< A readonly or read-write storage buffer. */
+} SDL_ShaderCross_MSLArgumentType;
+
+typedef struct SDL_ShaderCross_MSLArgument
+{
+    Uint32 binding;                        /**< The binding index of the resource in its descriptor set. */
+    SDL_ShaderCross_MSLArgumentType type;  /**< The type of the resource. */
+    Uint32 id;                             /**< The [[id(n)]] of the texture or buffer in the argument buffer. */
+    Uint32 sampler_id;                     /**< The [[id(n)]] of the sampler of a sampled texture, 0 otherwise. */
+} SDL_ShaderCross_MSLArgument;
+
+typedef struct SDL_ShaderCross_MSLArgumentBuffer
+{
+    Uint32 descriptor_set;                   /**< The descriptor set the argument buffer replaces. */
+    Uint32 buffer_index;                     /**< The [[buffer(n)]] index to bind the argument buffer to. */
+    Uint32 num_arguments;                    /**< The number of resources in the argument buffer. */
+    SDL_ShaderCross_MSLArgument *arguments;  /**< The resources in the argument buffer, ordered by binding. */
+} SDL_ShaderCross_MSLArgumentBuffer;
+
+typedef enum SDL_ShaderCross_MemoryStage
+{
+    SDL_SHADERCROSS_MEMORYSTAGE_SHADERCROSS,  /**< Allocations made by SDL_shadercross itself. */
+    SDL_SHADERCROSS_MEMORYSTAGE_DXC,          /**< Allocations made by DXC. */
+    SDL_SHADERCROSS_MEMORYSTAGE_SPIRVCROSS,   /**< Allocations made while transpiling with SPIRV-Cross. */
+    SDL_SHADERCROSS_MEMORYSTAGE_FXC,          /**< Allocations made while compiling with FXC or vkd3d. */
+    SDL_SHADERCROSS_MEMORYSTAGE_COUNT
+} SDL_ShaderCross_MemoryStage;
+
+typedef struct SDL_ShaderCross_MemoryStageStats
+{
+    Uint64 num_allocations;  /**< The number of allocations made, including reallocations. */
+    Uint64 total_bytes;      /**< The total number of bytes requested by those allocations. */
+    Uint64 peak_bytes;       /**< The largest number of bytes that were live at the same time. */
+} SDL_ShaderCross_MemoryStageStats;
+
+typedef struct SDL_ShaderCross_MemoryStats
+{
+    SDL_ShaderCross_MemoryStageStats total;                                      /**< The combined statistics of every stage. */
+    SDL_ShaderCross_MemoryStageStats stages[SDL_SHADERCROSS_MEMORYSTAGE_COUNT];  /**< The statistics of each stage, indexed by SDL_ShaderCross_MemoryStage. */
+} SDL_ShaderCross_MemoryStats;
+
+typedef enum SDL_ShaderCross_TimingStage
+{
+    SDL_SHADERCROSS_TIMINGSTAGE_HLSL_TO_SPIRV,  /**< Compiling HLSL to SPIRV with DXC, including SPIRV optimization and stripping. */
+    SDL_SHADERCROSS_TIMINGSTAGE_TRANSPILE,      /**< Transpiling SPIRV to MSL or HLSL with SPIRV-Cross, including SPIRV preprocessing. */
+    SDL_SHADERCROSS_TIMINGSTAGE_BACKEND,        /**< Compiling HLSL to DXIL with DXC, or to DXBC with FXC or vkd3d. */
+    SDL_SHADERCROSS_TIMINGSTAGE_REFLECTION,     /**< Reflecting SPIRV resources with SPIRV-Cross. */
+    SDL_SHADERCROSS_TIMINGSTAGE_COUNT
+} SDL_ShaderCross_TimingStage;
+
+typedef struct SDL_ShaderCross_TimingStageStats
+{
+    Uint64 num_calls;  /**< The number of times the stage ran. */
+    Uint64 wall_ns;    /**< The wall clock time spent in the stage, in nanoseconds. */
+    Uint64 cpu_ns;     /**< The CPU time of the calling thread spent in the stage, in nanoseconds. 0 where the platform doesn't report it. */
+} SDL_ShaderCross_TimingStageStats;
+
+typedef struct SDL_ShaderCross_TimingStats
+{
+    SDL_ShaderCross_TimingStageStats stages[SDL_SHADERCROSS_TIMINGSTAGE_COUNT];  /**< The statistics of each stage, indexed by SDL_ShaderCross_TimingStage. */
+} SDL_ShaderCross_TimingStats;
+
+typedef struct SDL_ShaderCross_SpecializationConstant
+{
+    const char *name;    /**< The UTF-8 name of the constant, or NULL to match it by constant_id instead. Names are unavailable in stripped SPIR-V. */
+    Uint32 constant_id;  /**< The SpecId of the constant. Only used when name is NULL. */
+    Uint64 value;        /**< The value to freeze the constant to. Floats are bit-cast, booleans are true when nonzero. */
+} SDL_ShaderCross_SpecializationConstant;
+
+/**
+ * Shader bundles pack many precompiled shaders into one file, as written by the shadercross CLI with `--manifest` and `--bundle`
+ * and read by SDL_ShaderCross_OpenBundle().
+ *
+ * A bundle starts with an SDL_ShaderCross_BundleHeader. It is followed by the entries, sorted by hash, then name, then format, then a string table of null-terminated UTF-8 strings and finally the shader code.
+ * Every field is little-endian and every offset is from the start of the file.
+ * Code is aligned to SDL_SHADERCROSS_BUNDLE_ALIGNMENT bytes, and entries with identical code share it.
+ */
+#define SDL_SHADERCROSS_BUNDLE_MAGIC 0x4E424353 /* "SCBN" */
+#define SDL_SHADERCROSS_BUNDLE_VERSION 1
+#define SDL_SHADERCROSS_BUNDLE_ALIGNMENT 16
+
+typedef struct SDL_ShaderCross_BundleHeader
+{
+    Uint32 magic;           /**< SDL_SHADERCROSS_BUNDLE_MAGIC. */
+    Uint32 version;         /**< SDL_SHADERCROSS_BUNDLE_VERSION. */
+    Uint32 num_entries;     /**< The number of entries. */
+    Uint32 entry_size;      /**< The size of an entry, sizeof(SDL_ShaderCross_BundleEntry). */
+    Uint64 entries_offset;  /**< The offset of the first entry. */
+    Uint64 strings_offset;  /**< The offset of the string table. */
+    Uint64 strings_size;    /**< The size of the string table in bytes. */
+} SDL_ShaderCross_BundleHeader;
+
+typedef struct SDL_ShaderCross_BundleEntry
+{
+    Uint64 hash;                            /**< The 64-bit FNV-1a hash of the name, without the terminator. */
+    Uint64 code_offset;                     /**< The offset of the code. */
+    Uint64 code_size;                       /**< The size of the code in bytes. MSL code is null-terminated and the size includes the terminator. */
+    Uint32 name_offset;                     /**< The offset of the name in the string table. */
+    Uint32 entrypoint_offset;               /**< The offset in the string table of the entry point to create the shader with. */
+    Uint32 format;                          /**< The SDL_GPUShaderFormat of the code, a single format. */
+    Uint32 shader_stage;                    /**< The SDL_ShaderCross_ShaderStage of the shader. */
+    Uint32 num_samplers;                    /**< The number of samplers. */
+    Uint32 num_readonly_storage_textures;   /**< The number of readonly storage textures, which are all the storage textures of a graphics shader. */
+    Uint32 num_readonly_storage_buffers;    /**< The number of readonly storage buffers, which are all the storage buffers of a graphics shader. */
+    Uint32 num_readwrite_storage_textures;  /**< The number of read-write storage textures. Always 0 for graphics shaders. */
+    Uint32 num_readwrite_storage_buffers;   /**< The number of read-write storage buffers. Always 0 for graphics shaders. */
+    Uint32 num_uniform_buffers;             /**< The number of uniform buffers. */
+    Uint32 threadcount_x;                   /**< The number of threads in the X dimension of a compute shader, 0 otherwise. */
+    Uint32 threadcount_y;                   /**< The number of threads in the Y dimension of a compute shader, 0 otherwise. */
+    Uint32 threadcount_z;                   /**< The number of threads in the Z dimension of a compute shader, 0 otherwise. */
+    Uint32 reserved;                        /**< Reserved, 0. */
+} SDL_ShaderCross_BundleEntry;
+
+typedef struct SDL_ShaderCross_Bundle SDL_ShaderCross_Bundle;
+
 typedef struct SDL_ShaderCross_SPIRV_Info
 {
     const Uint8 *bytecode;                     /**< The SPIRV bytecode. */
@@ -110,9 +247,19 @@ typedef struct SDL_ShaderCross_SPIRV_Info
 #define SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN "SDL_shadercross.spirv.debug.enable"
 #define SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING "SDL_shadercross.spirv.debug.name"
 #define SDL_SHADERCROSS_PROP_SHADER_CULL_UNUSED_BINDINGS_BOOLEAN "SDL_shadercross.spirv.cull_unused_bindings"
+#define SDL_SHADERCROSS_PROP_SHADER_STRIP_DEBUG_INFO_BOOLEAN "SDL_shadercross.spirv.strip_debug_info"
+#define SDL_SHADERCROSS_PROP_SHADER_HLSL_ROUNDTRIP_STRING "SDL_shadercross.hlsl.roundtrip"
+#define SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER "SDL_shadercross.spirv.optimization"
+#define SDL_SHADERCROSS_PROP_SHADER_OPTIMIZATION_LEVEL_NUMBER "SDL_shadercross.optimization.level"
+#define SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER "SDL_shadercross.dxil.shader_model"
+#define SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN "SDL_shadercross.enable_16bit_types"
+#define SDL_SHADERCROSS_PROP_SHADER_INCLUDE_BASE_DIRECTORY_STRING "SDL_shadercross.hlsl.include_base_directory"
 
 #define SDL_SHADERCROSS_PROP_SPIRV_PSSL_COMPATIBILITY_BOOLEAN "SDL_shadercross.spirv.pssl.compatibility"
 #define SDL_SHADERCROSS_PROP_SPIRV_MSL_VERSION_STRING "SDL_shadercross.spirv.msl.version"
+#define SDL_SHADERCROSS_PROP_SPIRV_MSL_ARGUMENT_BUFFERS_BOOLEAN "SDL_shadercross.spirv.msl.argument_buffers"
+#define SDL_SHADERCROSS_PROP_SPIRV_SPECIALIZATION_CONSTANTS_POINTER "SDL_shadercross.spirv.specialization_constants"
+#define SDL_SHADERCROSS_PROP_SPIRV_NUM_SPECIALIZATION_CONSTANTS_NUMBER "SDL_shadercross.spirv.num_specialization_constants"
 
 typedef struct SDL_ShaderCross_HLSL_Define
 {
@@ -131,6 +278,39 @@ typedef struct SDL_ShaderCross_HLSL_Info
     SDL_PropertiesID props;                    /**< A properties ID for extensions. Should be 0 if no extensions are needed. */
 } SDL_ShaderCross_HLSL_Info;
 
+/**
+ * A callback that is invoked for each file DXC includes while compiling HLSL.
+ *
+ * \param userdata the userdata of the SDL_ShaderCross_IncludeCallbackInfo.
+ * \param path the UTF-8 path of the included file, as resolved by DXC.
+ *
+ * \threadsafety This is called on the thread that is compiling the shader.
+ */
+typedef void (SDLCALL *SDL_ShaderCross_IncludeCallback)(void *userdata, const char *path);
+
+/**
+ * An include callback and its userdata, passed by pointer through `SDL_SHADERCROSS_PROP_SHADER_INCLUDE_CALLBACK_POINTER`,
+ * since properties can't hold function pointers. It must stay valid until the compile returns.
+ */
+typedef struct SDL_ShaderCross_IncludeCallbackInfo
+{
+    SDL_ShaderCross_IncludeCallback callback;  /**< Called with the path of every file DXC includes. */
+    void *userdata;                            /**< Passed to the callback. */
+} SDL_ShaderCross_IncludeCallbackInfo;
+
+/**
+ * A callback that is invoked when SDL_shadercross enters or leaves one of its internal stages, see SDL_ShaderCross_SetTraceCallback().
+ *
+ * \param userdata the userdata given to SDL_ShaderCross_SetTraceCallback().
+ * \param name the name of the span, a static string.
+ * \param begin true when the span starts, false when it ends. Spans nest, and end in reverse order on each thread.
+ *
+ * \threadsafety This is called on the thread doing the work, often several threads at once.
+ */
+typedef void (SDLCALL *SDL_ShaderCross_TraceCallback)(void *userdata, const char *name, bool begin);
+
+#define SDL_SHADERCROSS_PROP_SHADER_INCLUDE_CALLBACK_POINTER "SDL_shadercross.hlsl.include_callback"
+
 /**
  * Initializes SDL_shadercross
  *
@@ -160,7 +340,11 @@ extern SDL_DECLSPEC SDL_GPUShaderFormat SDLCALL SDL_ShaderCross_GetSPIRVShaderFo
  *
  * These are the optional properties that can be used:
  *
- * - `SDL_SHADERCROSS_PROP_SPIRV_MSL_VERSION_STRING`: specifies the MSL version that should be emitted. Defaults to 1.2.0.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_MSL_VERSION_STRING`: specifies the MSL version that should be emitted. Defaults to 1.2.0, or 2.0.0 with argument buffers.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_MSL_ARGUMENT_BUFFERS_BOOLEAN`: when true, the textures, samplers and storage buffers of each descriptor set are gathered in an argument buffer instead of being bound one by one. Uniform buffers stay discrete. Use SDL_ShaderCross_ReflectMSLArgumentBuffers() to get the layout to encode. Requires MSL 2.0 or later. Defaults to false.
+ * - `SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER`: an SDL_ShaderCross_SPIRVOptimization recipe to run on the SPIR-V before transpiling. Requires SPIRV-Tools support. Defaults to SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_SPECIALIZATION_CONSTANTS_POINTER`: an array of SDL_ShaderCross_SpecializationConstant. The matching specialization constants become regular constants before transpiling, so the output can be constant-folded. The call fails when one of them doesn't match a specialization constant of the module.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_NUM_SPECIALIZATION_CONSTANTS_NUMBER`: the number of elements in the specialization constant array.
  *
  * \param info a struct describing the shader to transpile.
  * \returns an SDL_malloc'd string containing MSL code.
@@ -176,6 +360,11 @@ extern SDL_DECLSPEC void * SDLCALL SDL_ShaderCross_TranspileMSLFromSPIRV(
  * These are the optional properties that can be used:
  *
  * - `SDL_SHADERCROSS_PROP_SPIRV_PSSL_COMPATIBILITY_BOOLEAN`: generates PSSL-compatible shader.
+ * - `SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER`: an SDL_ShaderCross_SPIRVOptimization recipe to run on the SPIR-V before transpiling. Requires SPIRV-Tools support. Defaults to SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE.
+ * - `SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER`: the shader model the HLSL is written for, as major * 10 + minor. Ignored for PSSL. Must be between 60 and 69, defaults to 60.
+ * - `SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN`: when true, 16-bit SPIR-V types are emitted as native 16-bit types instead of min precision ones. Requires shader model 62 or later, which becomes the default. Defaults to false.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_SPECIALIZATION_CONSTANTS_POINTER`: an array of SDL_ShaderCross_SpecializationConstant. The matching specialization constants become regular constants before transpiling, so the output can be constant-folded. The call fails when one of them doesn't match a specialization constant of the module.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_NUM_SPECIALIZATION_CONSTANTS_NUMBER`: the number of elements in the specialization constant array.
  *
  * \param info a struct describing the shader to transpile.
  * \returns an SDL_malloc'd string containing HLSL code.
@@ -188,6 +377,12 @@ extern SDL_DECLSPEC void * SDLCALL SDL_ShaderCross_TranspileHLSLFromSPIRV(
  *
  * You must SDL_free the returned buffer once you are done with it.
  *
+ * These are the optional properties that can be used:
+ *
+ * - `SDL_SHADERCROSS_PROP_SHADER_OPTIMIZATION_LEVEL_NUMBER`: the optimization level passed to FXC, from 0 (optimization skipped, for fast iteration) to 3 (maximum optimization). Defaults to the compiler's own default.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_SPECIALIZATION_CONSTANTS_POINTER`: an array of SDL_ShaderCross_SpecializationConstant. The matching specialization constants become regular constants before transpiling, so the output can be constant-folded. The call fails when one of them doesn't match a specialization constant of the module.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_NUM_SPECIALIZATION_CONSTANTS_NUMBER`: the number of elements in the specialization constant array.
+ *
  * \param info a struct describing the shader to transpile.
  * \param size filled in with the bytecode buffer size.
  * \returns an SDL_malloc'd buffer containing DXBC bytecode.
@@ -201,6 +396,14 @@ extern SDL_DECLSPEC void * SDLCALL SDL_ShaderCross_CompileDXBCFromSPIRV(
  *
  * You must SDL_free the returned buffer once you are done with it.
  *
+ * These are the optional properties that can be used:
+ *
+ * - `SDL_SHADERCROSS_PROP_SHADER_OPTIMIZATION_LEVEL_NUMBER`: the optimization level passed to DXC, from 0 (optimization skipped, for fast iteration) to 3 (maximum optimization). Defaults to the compiler's own default.
+ * - `SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER`: the shader model to target, as major * 10 + minor (e.g. 65 for SM 6.5). Must be between 60 and 69, defaults to 60.
+ * - `SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN`: when true, 16-bit SPIR-V types are kept as native 16-bit types instead of min precision ones. Requires shader model 62 or later, which becomes the default. Defaults to false.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_SPECIALIZATION_CONSTANTS_POINTER`: an array of SDL_ShaderCross_SpecializationConstant. The matching specialization constants become regular constants before transpiling, so the output can be constant-folded. The call fails when one of them doesn't match a specialization constant of the module.
+ * - `SDL_SHADERCROSS_PROP_SPIRV_NUM_SPECIALIZATION_CONSTANTS_NUMBER`: the number of elements in the specialization constant array.
+ *
  * \param info a struct describing the shader to transpile.
  * \param size filled in with the bytecode buffer size.
  * \returns an SDL_malloc'd buffer containing DXIL bytecode.
@@ -273,6 +476,163 @@ extern SDL_DECLSPEC SDL_ShaderCross_ComputePipelineMetadata * SDLCALL SDL_Shader
     size_t bytecode_size,
     SDL_PropertiesID props);
 
+/**
+ * Reflect graphics shader info from SPIRV code into a caller-provided buffer.
+ *
+ * Call this once with a NULL buffer to get the required size in `buffer_size`, then again with a buffer of at least that size.
+ * On success the buffer starts with an SDL_ShaderCross_GraphicsShaderMetadata struct, followed by the input and output arrays and their names.
+ * The struct's pointers point into the buffer, so it must be suitably aligned for the struct and must not be moved afterwards.
+ *
+ * \param bytecode the SPIRV bytecode.
+ * \param bytecode_size the length of the SPIRV bytecode.
+ * \param props a properties object filled in with extra shader metadata, provided by the user.
+ * \param buffer the buffer to fill in, or NULL to query the required size.
+ * \param buffer_size the size of `buffer` in bytes, filled in with the number of bytes required.
+ * \returns true on success, false otherwise. Fails if `buffer` is too small.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC bool SDLCALL SDL_ShaderCross_ReflectGraphicsSPIRVInto(
+    const Uint8 *bytecode,
+    size_t bytecode_size,
+    SDL_PropertiesID props,
+    void *buffer,
+    size_t *buffer_size);
+
+/**
+ * Reflect compute pipeline info from SPIRV code into a caller-provided buffer.
+ *
+ * Call this once with a NULL buffer to get the required size in `buffer_size`, then again with a buffer of at least that size.
+ * On success the buffer starts with an SDL_ShaderCross_ComputePipelineMetadata struct, so it must be suitably aligned for it.
+ *
+ * \param bytecode the SPIRV bytecode.
+ * \param bytecode_size the length of the SPIRV bytecode.
+ * \param props a properties object filled in with extra shader metadata, provided by the user.
+ * \param buffer the buffer to fill in, or NULL to query the required size.
+ * \param buffer_size the size of `buffer` in bytes, filled in with the number of bytes required.
+ * \returns true on success, false otherwise. Fails if `buffer` is too small.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC bool SDLCALL SDL_ShaderCross_ReflectComputeSPIRVInto(
+    const Uint8 *bytecode,
+    size_t bytecode_size,
+    SDL_PropertiesID props,
+    void *buffer,
+    size_t *buffer_size);
+
+/**
+ * Reflect the argument buffer layout that MSL transpiled with `SDL_SHADERCROSS_PROP_SPIRV_MSL_ARGUMENT_BUFFERS_BOOLEAN` uses.
+ *
+ * There is one argument buffer per descriptor set holding textures, samplers or storage buffers, bound after the uniform buffers.
+ * Within an argument buffer, resources are ordered by binding and numbered from 0, and a sampled texture takes two ids, the texture's then its sampler's.
+ * The layout only depends on the resources of the shader, so it can be encoded once per material and reused for every draw.
+ *
+ * You must SDL_free the returned array once you are done with it. The arguments are stored in the same allocation.
+ *
+ * \param info a struct describing the shader, the same as passed to SDL_ShaderCross_TranspileMSLFromSPIRV().
+ * \param count filled in with the number of argument buffers, which may be 0.
+ * \returns an SDL_malloc'd array of argument buffers ordered by descriptor set, or NULL on failure.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC SDL_ShaderCross_MSLArgumentBuffer * SDLCALL SDL_ShaderCross_ReflectMSLArgumentBuffers(
+    const SDL_ShaderCross_SPIRV_Info *info,
+    int *count);
+
+/**
+ * Compile SPIRV code to a graphics shader in the given format, and reflect it, in one pass.
+ *
+ * This parses the SPIRV and enumerates its resources once, which is cheaper than calling a compile function followed by SDL_ShaderCross_ReflectGraphicsSPIRV().
+ * When `format` is SDL_GPU_SHADERFORMAT_MSL, the returned buffer is a null-terminated string and `size` includes the terminator.
+ *
+ * You must SDL_free the returned buffer and the metadata once you are done with them.
+ *
+ * \param info a struct describing the shader to compile.
+ * \param format the target format, one of SDL_GPU_SHADERFORMAT_DXBC, SDL_GPU_SHADERFORMAT_DXIL or SDL_GPU_SHADERFORMAT_MSL.
+ * \param size filled in with the bytecode buffer size.
+ * \param metadata filled in with an SDL_malloc'd metadata struct, the same as SDL_ShaderCross_ReflectGraphicsSPIRV() returns.
+ * \returns an SDL_malloc'd buffer containing the shader, or NULL on failure.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC void * SDLCALL SDL_ShaderCross_CompileAndReflectGraphicsSPIRV(
+    const SDL_ShaderCross_SPIRV_Info *info,
+    SDL_GPUShaderFormat format,
+    size_t *size,
+    SDL_ShaderCross_GraphicsShaderMetadata **metadata);
+
+/**
+ * Compile SPIRV code to a compute shader in the given format, and reflect it, in one pass.
+ *
+ * This parses the SPIRV and enumerates its resources once, which is cheaper than calling a compile function followed by SDL_ShaderCross_ReflectComputeSPIRV().
+ * When `format` is SDL_GPU_SHADERFORMAT_MSL, the returned buffer is a null-terminated string and `size` includes the terminator.
+ *
+ * You must SDL_free the returned buffer and the metadata once you are done with them.
+ *
+ * \param info a struct describing the shader to compile.
+ * \param format the target format, one of SDL_GPU_SHADERFORMAT_DXBC, SDL_GPU_SHADERFORMAT_DXIL or SDL_GPU_SHADERFORMAT_MSL.
+ * \param size filled in with the bytecode buffer size.
+ * \param metadata filled in with an SDL_malloc'd metadata struct, the same as SDL_ShaderCross_ReflectComputeSPIRV() returns.
+ * \returns an SDL_malloc'd buffer containing the shader, or NULL on failure.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC void * SDLCALL SDL_ShaderCross_CompileAndReflectComputeSPIRV(
+    const SDL_ShaderCross_SPIRV_Info *info,
+    SDL_GPUShaderFormat format,
+    size_t *size,
+    SDL_ShaderCross_ComputePipelineMetadata **metadata);
+
+/**
+ * Compile every vertex, fragment and compute entry point of a SPIRV module to the given format, and reflect each of them.
+ *
+ * The module is parsed, specialized and optimized once, then the entry points are compiled in parallel on worker threads.
+ * Entry points of other execution models are skipped.
+ * When `format` is SDL_GPU_SHADERFORMAT_MSL, each code buffer is a null-terminated string and `code_size` includes the terminator.
+ * Memory statistics of the work done on worker threads are recorded on those threads.
+ *
+ * You must SDL_free the code and metadata of every output, then the returned array, once you are done with them.
+ * The entry point names are stored in the array allocation.
+ *
+ * The same properties as SDL_ShaderCross_TranspileMSLFromSPIRV(), SDL_ShaderCross_CompileDXBCFromSPIRV() and SDL_ShaderCross_CompileDXILFromSPIRV() can be used.
+ *
+ * \param bytecode the SPIRV bytecode.
+ * \param bytecode_size the length of the SPIRV bytecode.
+ * \param props a properties object with the compile options, or 0.
+ * \param format the target format, one of SDL_GPU_SHADERFORMAT_DXBC, SDL_GPU_SHADERFORMAT_DXIL or SDL_GPU_SHADERFORMAT_MSL.
+ * \param count filled in with the number of outputs.
+ * \returns an SDL_malloc'd array of outputs, one per entry point in module order, or NULL on failure.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC SDL_ShaderCross_SPIRVEntryPointOutput * SDLCALL SDL_ShaderCross_CompileAllSPIRVEntryPoints(
+    const Uint8 *bytecode,
+    size_t bytecode_size,
+    SDL_PropertiesID props,
+    SDL_GPUShaderFormat format,
+    int *count);
+
+/**
+ * Compile one entry point of a SPIRV module to the given format, and reflect it, in one pass.
+ *
+ * Unlike SDL_ShaderCross_CompileAndReflectGraphicsSPIRV() and SDL_ShaderCross_CompileAndReflectComputeSPIRV(), this also returns the
+ * name to create the shader with, which SPIRV-Cross changes on MSL when the name is reserved, such as main becoming main0.
+ * When `format` is SDL_GPU_SHADERFORMAT_MSL, the code buffer is a null-terminated string and `code_size` includes the terminator.
+ *
+ * You must SDL_free the code and metadata of the output, then the output, once you are done with them.
+ * The entry point names are stored in the output allocation.
+ *
+ * \param info a struct describing the shader to compile.
+ * \param format the target format, one of SDL_GPU_SHADERFORMAT_DXBC, SDL_GPU_SHADERFORMAT_DXIL or SDL_GPU_SHADERFORMAT_MSL.
+ * \returns an SDL_malloc'd output, or NULL on failure.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC SDL_ShaderCross_SPIRVEntryPointOutput * SDLCALL SDL_ShaderCross_CompileSPIRVEntryPoint(
+    const SDL_ShaderCross_SPIRV_Info *info,
+    SDL_GPUShaderFormat format);
+
 /**
  * Get the supported shader formats that HLSL cross-compilation can output
  *
@@ -292,6 +652,12 @@ extern SDL_DECLSPEC SDL_GPUShaderFormat SDLCALL SDL_ShaderCross_GetHLSLShaderFor
  * - `SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN`: allows debug info to be emitted when relevant. Should only be used with debugging tools like Renderdoc.
  * - `SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN`: a UTF-8 name to be used with the shader. Relevant for use with debugging tools like Renderdoc.
  * - `SDL_SHADERCROSS_PROP_SHADER_CULL_UNUSED_BINDINGS_BOOLEAN`: When true, indicates that the compiler should not cull unused shader resources. This behavior is disabled by default.
+ * - `SDL_SHADERCROSS_PROP_SHADER_HLSL_ROUNDTRIP_STRING`: "always" to always compile via a SPIR-V round trip, "never" to compile the source directly, or "auto" to compile the source directly when nothing the round trip would rewrite is found in it. Currently only compute shaders without includes, Vulkan attributes or read-write resources outside of `space1` qualify. "never" requires the source to already follow the SDL_GPU register conventions and to use TEXCOORD<location> semantics for stage inputs and outputs. Any other value makes the compile fail. Defaults to "always".
+ * - `SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER`: an SDL_ShaderCross_SPIRVOptimization recipe to run on the SPIR-V between the round trip stages. Requires SPIRV-Tools support. Defaults to SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE.
+ * - `SDL_SHADERCROSS_PROP_SHADER_OPTIMIZATION_LEVEL_NUMBER`: the optimization level passed to DXC and FXC, from 0 (optimization skipped, for fast iteration) to 3 (maximum optimization). Defaults to the compiler's own default.
+ * - `SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN`: when true, `half` is treated as a 16-bit type during the round trip. DXBC has no native 16-bit types, so they end up as min precision types. Defaults to false.
+ * - `SDL_SHADERCROSS_PROP_SHADER_INCLUDE_CALLBACK_POINTER`: a pointer to an SDL_ShaderCross_IncludeCallbackInfo whose callback is called with the path of every file DXC includes. Files included by a source that is compiled directly with FXC are not reported.
+ * - `SDL_SHADERCROSS_PROP_SHADER_INCLUDE_BASE_DIRECTORY_STRING`: a directory that DXC resolves relative include paths against, instead of the working directory. The include callback still gets the relative paths.
  *
  * \param info a struct describing the shader to transpile.
  * \param size filled in with the bytecode buffer size.
@@ -313,6 +679,13 @@ extern SDL_DECLSPEC void * SDLCALL SDL_ShaderCross_CompileDXBCFromHLSL(
  * - `SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN`: allows debug info to be emitted when relevant. Should only be used with debugging tools like Renderdoc.
  * - `SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING`: a UTF-8 name to be used with the shader. Relevant for use with debugging tools like Renderdoc.
  * - `SDL_SHADERCROSS_PROP_SHADER_CULL_UNUSED_BINDINGS_BOOLEAN`: when true, indicates that the compiler should not cull unused shader resources. This behavior is disabled by default.
+ * - `SDL_SHADERCROSS_PROP_SHADER_HLSL_ROUNDTRIP_STRING`: "always" to always compile via a SPIR-V round trip, "never" to compile the source directly, or "auto" to compile the source directly when nothing the round trip would rewrite is found in it. Currently only compute shaders without includes, Vulkan attributes or read-write resources outside of `space1` qualify. "never" requires the source to already follow the SDL_GPU register conventions and to use TEXCOORD<location> semantics for stage inputs and outputs. Any other value makes the compile fail. Defaults to "never" on GDK and "always" elsewhere.
+ * - `SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER`: an SDL_ShaderCross_SPIRVOptimization recipe to run on the SPIR-V between the round trip stages. Requires SPIRV-Tools support. Defaults to SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE.
+ * - `SDL_SHADERCROSS_PROP_SHADER_OPTIMIZATION_LEVEL_NUMBER`: the optimization level passed to DXC, from 0 (optimization skipped, for fast iteration) to 3 (maximum optimization). Defaults to the compiler's own default.
+ * - `SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER`: the shader model to target, as major * 10 + minor (e.g. 65 for SM 6.5). Used for the DXC profile and the round trip HLSL. Must be between 60 and 69, defaults to 60.
+ * - `SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN`: when true, `half` and the min precision types are compiled as native 16-bit types. Requires shader model 62 or later, which becomes the default. Defaults to false.
+ * - `SDL_SHADERCROSS_PROP_SHADER_INCLUDE_CALLBACK_POINTER`: a pointer to an SDL_ShaderCross_IncludeCallbackInfo whose callback is called with the path of every file DXC includes. Can be used to generate build dependencies.
+ * - `SDL_SHADERCROSS_PROP_SHADER_INCLUDE_BASE_DIRECTORY_STRING`: a directory that DXC resolves relative include paths against, instead of the working directory. The include callback still gets the relative paths.
  *
  * \param info a struct describing the shader to transpile.
  * \param size filled in with the bytecode buffer size.
@@ -334,6 +707,13 @@ extern SDL_DECLSPEC void * SDLCALL SDL_ShaderCross_CompileDXILFromHLSL(
  * - `SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN`: allows debug info to be emitted when relevant. Should only be used with debugging tools like Renderdoc.
  * - `SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING`: a UTF-8 name to be used with the shader. Relevant for use with debugging tools like Renderdoc.
  * - `SDL_SHADERCROSS_PROP_SHADER_CULL_UNUSED_BINDINGS_BOOLEAN`: when true, indicates that the compiler should not cull unused shader resources. This behavior is disabled by default.
+ * - `SDL_SHADERCROSS_PROP_SHADER_STRIP_DEBUG_INFO_BOOLEAN`: when true, names, source and line info and non-semantic instructions are removed from the output, as with SDL_ShaderCross_StripSPIRV(). Defaults to false.
+ * - `SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER`: an SDL_ShaderCross_SPIRVOptimization recipe to run on the SPIR-V produced by DXC. Requires SPIRV-Tools support. Defaults to SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE.
+ * - `SDL_SHADERCROSS_PROP_SHADER_OPTIMIZATION_LEVEL_NUMBER`: the optimization level passed to DXC, from 0 (optimization skipped, for fast iteration) to 3 (maximum optimization). Defaults to the compiler's own default.
+ * - `SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER`: the shader model used for the DXC profile, as major * 10 + minor. Needed for intrinsics newer than SM 6.0. Must be between 60 and 69, defaults to 60.
+ * - `SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN`: when true, `half` and the min precision types are compiled as native 16-bit types, which MSL output then uses as `half`. Reflection reports such IO variables as SDL_SHADERCROSS_IOVAR_TYPE_FLOAT16. Defaults to false.
+ * - `SDL_SHADERCROSS_PROP_SHADER_INCLUDE_CALLBACK_POINTER`: a pointer to an SDL_ShaderCross_IncludeCallbackInfo whose callback is called with the path of every file DXC includes. Can be used to generate build dependencies.
+ * - `SDL_SHADERCROSS_PROP_SHADER_INCLUDE_BASE_DIRECTORY_STRING`: a directory that DXC resolves relative include paths against, instead of the working directory. The include callback still gets the relative paths.
  *
  * \param info a struct describing the shader to transpile.
  * \param size filled in with the bytecode buffer size.
@@ -345,6 +725,183 @@ extern SDL_DECLSPEC void * SDLCALL SDL_ShaderCross_CompileSPIRVFromHLSL(
     const SDL_ShaderCross_HLSL_Info *info,
     size_t *size);
 
+/**
+ * Enable tracking of allocation counts and peak memory usage.
+ *
+ * This replaces the SDL memory functions with tracking wrappers and routes
+ * DXC allocations through the same accounting, so it must be called before
+ * any other SDL or SDL_shadercross function, including SDL_ShaderCross_Init().
+ * Tracking stays enabled for the lifetime of the process.
+ *
+ * SPIRV-Cross and FXC/vkd3d do not expose allocator hooks, so their stages
+ * only account for the memory SDL_shadercross allocates on their behalf.
+ *
+ * \returns true on success, false otherwise.
+ *
+ * \threadsafety This should only be called once, from a single thread.
+ */
+extern SDL_DECLSPEC bool SDLCALL SDL_ShaderCross_EnableMemoryStats(void);
+
+/**
+ * Reset the memory statistics of the calling thread.
+ *
+ * Call this before a compilation function and SDL_ShaderCross_GetMemoryStats()
+ * after it to measure that call.
+ *
+ * Statistics are kept per thread: only allocations made on the calling thread
+ * are counted. To measure work spread over several threads, reset and read the
+ * statistics on each of them and add them up.
+ *
+ * \returns true on success, false if tracking is not enabled.
+ *
+ * \threadsafety It is safe to call this function from any thread. Statistics are tracked per thread.
+ */
+extern SDL_DECLSPEC bool SDLCALL SDL_ShaderCross_ResetMemoryStats(void);
+
+/**
+ * Get the memory statistics recorded on the calling thread since the last
+ * call to SDL_ShaderCross_ResetMemoryStats().
+ *
+ * \param stats filled in with the recorded statistics.
+ * \returns true on success, false if tracking is not enabled.
+ *
+ * \threadsafety It is safe to call this function from any thread. Statistics are tracked per thread.
+ */
+extern SDL_DECLSPEC bool SDLCALL SDL_ShaderCross_GetMemoryStats(SDL_ShaderCross_MemoryStats *stats);
+
+/**
+ * Reset the timing statistics of the calling thread, enabling them on that
+ * thread the first time.
+ *
+ * Call this before a compilation function and SDL_ShaderCross_GetTimingStats()
+ * after it to see where that call spent its time. When a stage runs inside
+ * another, such as reflection during a transpile, the time is only charged to
+ * the inner stage.
+ *
+ * \returns true on success, false otherwise.
+ *
+ * \threadsafety It is safe to call this function from any thread. Statistics are tracked per thread.
+ */
+extern SDL_DECLSPEC bool SDLCALL SDL_ShaderCross_ResetTimingStats(void);
+
+/**
+ * Get the timing statistics recorded on the calling thread since the last
+ * call to SDL_ShaderCross_ResetTimingStats().
+ *
+ * \param stats filled in with the recorded statistics.
+ * \returns true on success, false if timing was never reset on this thread.
+ *
+ * \threadsafety It is safe to call this function from any thread. Statistics are tracked per thread.
+ */
+extern SDL_DECLSPEC bool SDLCALL SDL_ShaderCross_GetTimingStats(SDL_ShaderCross_TimingStats *stats);
+
+/**
+ * Set a callback to invoke around the internal stages of every compilation, for profiling.
+ *
+ * Spans cover the stages of SDL_ShaderCross_TimingStage and, within them, DxcCreateInstance, IDxcCompiler3::Compile,
+ * spvc_context_parse_spirv, spvc_compiler_compile and D3DCompile.
+ *
+ * \param callback the callback, or NULL to stop tracing.
+ * \param userdata a pointer passed to the callback.
+ *
+ * \threadsafety This should only be called while no compilation is running.
+ */
+extern SDL_DECLSPEC void SDLCALL SDL_ShaderCross_SetTraceCallback(SDL_ShaderCross_TraceCallback callback, void *userdata);
+
+/**
+ * Strip debug and non-semantic information from SPIRV bytecode.
+ *
+ * This removes OpName, OpMemberName, OpString, OpSource*, OpLine, OpNoLine and OpModuleProcessed, as well as every instruction
+ * from NonSemantic.* extended instruction sets, which shrinks shipped shaders and speeds up parsing them. Reflection of the
+ * stripped bytecode no longer reports input and output names.
+ *
+ * You must SDL_free the returned buffer once you are done with it.
+ *
+ * \param bytecode the SPIRV bytecode.
+ * \param bytecode_size the length of the SPIRV bytecode.
+ * \param size filled in with the stripped bytecode buffer size.
+ * \returns an SDL_malloc'd buffer containing the stripped SPIRV bytecode.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC void * SDLCALL SDL_ShaderCross_StripSPIRV(
+    const Uint8 *bytecode,
+    size_t bytecode_size,
+    size_t *size);
+
+/**
+ * Open a shader bundle for a GPU device.
+ *
+ * Only the header is read, so opening takes the same time whatever the number of shaders. Where the platform allows, the file is
+ * mapped into memory instead of read. Shaders are created from the stored reflection the first time they are requested, without
+ * any cross-compilation.
+ *
+ * \param device the SDL GPU device the shaders are created for.
+ * \param path the path of a bundle written by the shadercross CLI.
+ * \returns a bundle on success, NULL otherwise. Close it with SDL_ShaderCross_CloseBundle().
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC SDL_ShaderCross_Bundle * SDLCALL SDL_ShaderCross_OpenBundle(
+    SDL_GPUDevice *device,
+    const char *path);
+
+/**
+ * Open a shader bundle that is already in memory, such as one embedded in the executable.
+ *
+ * \param device the SDL GPU device the shaders are created for.
+ * \param data the bundle. It must stay valid until the bundle is closed.
+ * \param size the size of the bundle in bytes.
+ * \returns a bundle on success, NULL otherwise. Close it with SDL_ShaderCross_CloseBundle().
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC SDL_ShaderCross_Bundle * SDLCALL SDL_ShaderCross_OpenBundleFromMemory(
+    SDL_GPUDevice *device,
+    const void *data,
+    size_t size);
+
+/**
+ * Get a graphics shader from a bundle, creating it on the first request.
+ *
+ * When the bundle has the shader in several formats the device supports, the one with the highest SDL_GPUShaderFormat value is used,
+ * so DXIL is preferred over DXBC. The shader is owned by the bundle and released by SDL_ShaderCross_CloseBundle().
+ *
+ * \param bundle the bundle.
+ * \param name the name of the shader in the bundle.
+ * \returns the shader on success, NULL otherwise.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC SDL_GPUShader * SDLCALL SDL_ShaderCross_GetBundleGraphicsShader(
+    SDL_ShaderCross_Bundle *bundle,
+    const char *name);
+
+/**
+ * Get a compute pipeline from a bundle, creating it on the first request.
+ *
+ * The format is picked as in SDL_ShaderCross_GetBundleGraphicsShader(). The pipeline is owned by the bundle and released by
+ * SDL_ShaderCross_CloseBundle().
+ *
+ * \param bundle the bundle.
+ * \param name the name of the shader in the bundle.
+ * \returns the compute pipeline on success, NULL otherwise.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ */
+extern SDL_DECLSPEC SDL_GPUComputePipeline * SDLCALL SDL_ShaderCross_GetBundleComputePipeline(
+    SDL_ShaderCross_Bundle *bundle,
+    const char *name);
+
+/**
+ * Close a shader bundle, releasing every shader and compute pipeline created from it.
+ *
+ * \param bundle the bundle to close, may be NULL.
+ *
+ * \threadsafety No other thread may be using the bundle.
+ */
+extern SDL_DECLSPEC void SDLCALL SDL_ShaderCross_CloseBundle(SDL_ShaderCross_Bundle *bundle);
+
 #ifdef __cplusplus
 }
 #endif
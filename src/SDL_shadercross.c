@@ -30,6 +30,364 @@
 /* Upper round X to multiple of V. V must be power of 2. */
 #define SDL_upper_multiple_power2(X, V) (((X) + (V) - 1) & ~((V) - 1))
 
+/* Memory Statistics */
+
+/* Every tracked block is prefixed with this header, padded to keep the block aligned */
+typedef union MemoryStatsHeader
+{
+    struct
+    {
+        size_t size;
+        SDL_ShaderCross_MemoryStage stage;
+    } info;
+    Uint8 padding[16];
+} MemoryStatsHeader;
+
+typedef struct MemoryStatsState
+{
+    SDL_ShaderCross_MemoryStage stage; // the stage SDL allocations are attributed to
+    Sint64 liveBytes[SDL_SHADERCROSS_MEMORYSTAGE_COUNT];
+    Sint64 totalLiveBytes;
+    SDL_ShaderCross_MemoryStats stats;
+} MemoryStatsState;
+
+static bool memoryStatsEnabled = false;
+static SDL_TLSID memoryStatsTLS;
+static SDL_malloc_func memoryStatsMalloc;
+static SDL_calloc_func memoryStatsCalloc;
+static SDL_realloc_func memoryStatsRealloc;
+static SDL_free_func memoryStatsFree;
+
+static void SDL_ShaderCross_INTERNAL_RecordAllocation(
+    SDL_ShaderCross_MemoryStageStats *stats,
+    Sint64 *liveBytes,
+    Sint64 delta,
+    size_t size)
+{
+    stats->num_allocations += 1;
+    stats->total_bytes += size;
+    *liveBytes += delta;
+    if (*liveBytes > 0 && (Uint64)*liveBytes > stats->peak_bytes) {
+        stats->peak_bytes = (Uint64)*liveBytes;
+    }
+}
+
+/* Records an allocation of newSize bytes replacing oldSize bytes. oldSize is 0 for fresh allocations, newSize is 0 for frees. */
+static void SDL_ShaderCross_INTERNAL_TrackMemory(
+    SDL_ShaderCross_MemoryStage oldStage,
+    size_t oldSize,
+    SDL_ShaderCross_MemoryStage newStage,
+    size_t newSize,
+    bool isFree)
+{
+    MemoryStatsState *state = (MemoryStatsState *)SDL_GetTLS(&memoryStatsTLS);
+    if (state == NULL) {
+        return;
+    }
+
+    // Blocks allocated before the last reset may be freed afterwards, don't let them go negative
+    state->liveBytes[oldStage] = SDL_max(state->liveBytes[oldStage] - (Sint64)oldSize, 0);
+    state->totalLiveBytes = SDL_max(state->totalLiveBytes - (Sint64)oldSize, 0);
+    if (isFree) {
+        return;
+    }
+
+    SDL_ShaderCross_INTERNAL_RecordAllocation(&state->stats.stages[newStage], &state->liveBytes[newStage], (Sint64)newSize, newSize);
+    SDL_ShaderCross_INTERNAL_RecordAllocation(&state->stats.total, &state->totalLiveBytes, (Sint64)newSize, newSize);
+}
+
+static SDL_ShaderCross_MemoryStage SDL_ShaderCross_INTERNAL_GetMemoryStage(void)
+{
+    MemoryStatsState *state = (MemoryStatsState *)SDL_GetTLS(&memoryStatsTLS);
+    return state != NULL ? state->stage : SDL_SHADERCROSS_MEMORYSTAGE_SHADERCROSS;
+}
+
+/* Returns the previous stage so it can be restored once the stage is done. */
+static SDL_ShaderCross_MemoryStage SDL_ShaderCross_INTERNAL_SetMemoryStage(SDL_ShaderCross_MemoryStage stage)
+{
+    MemoryStatsState *state = memoryStatsEnabled ? (MemoryStatsState *)SDL_GetTLS(&memoryStatsTLS) : NULL;
+    SDL_ShaderCross_MemoryStage previous = SDL_SHADERCROSS_MEMORYSTAGE_SHADERCROSS;
+    if (state != NULL) {
+        previous = state->stage;
+        state->stage = stage;
+    }
+    return previous;
+}
+
+static void *SDL_ShaderCross_INTERNAL_TrackedAlloc(SDL_ShaderCross_MemoryStage stage, size_t size, bool zero)
+{
+    MemoryStatsHeader *header;
+    if (size > SDL_SIZE_MAX - sizeof(MemoryStatsHeader)) {
+        return NULL;
+    }
+
+    header = zero ? memoryStatsCalloc(1, sizeof(MemoryStatsHeader) + size) : memoryStatsMalloc(sizeof(MemoryStatsHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+
+    header->info.size = size;
+    header->info.stage = stage;
+    SDL_ShaderCross_INTERNAL_TrackMemory(stage, 0, stage, size, false);
+    return header + 1;
+}
+
+static void *SDL_ShaderCross_INTERNAL_TrackedRealloc(SDL_ShaderCross_MemoryStage stage, void *mem, size_t size)
+{
+    MemoryStatsHeader *header;
+    size_t oldSize;
+    SDL_ShaderCross_MemoryStage oldStage;
+
+    if (mem == NULL) {
+        return SDL_ShaderCross_INTERNAL_TrackedAlloc(stage, size, false);
+    }
+    if (size > SDL_SIZE_MAX - sizeof(MemoryStatsHeader)) {
+        return NULL;
+    }
+
+    header = (MemoryStatsHeader *)mem - 1;
+    oldSize = header->info.size;
+    oldStage = header->info.stage;
+    header = memoryStatsRealloc(header, sizeof(MemoryStatsHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+
+    header->info.size = size;
+    header->info.stage = stage;
+    SDL_ShaderCross_INTERNAL_TrackMemory(oldStage, oldSize, stage, size, false);
+    return header + 1;
+}
+
+static void SDL_ShaderCross_INTERNAL_TrackedFree(void *mem)
+{
+    MemoryStatsHeader *header;
+    if (mem == NULL) {
+        return;
+    }
+
+    header = (MemoryStatsHeader *)mem - 1;
+    SDL_ShaderCross_INTERNAL_TrackMemory(header->info.stage, header->info.size, header->info.stage, 0, true);
+    memoryStatsFree(header);
+}
+
+static void * SDLCALL SDL_ShaderCross_INTERNAL_MemoryStatsMalloc(size_t size)
+{
+    return SDL_ShaderCross_INTERNAL_TrackedAlloc(SDL_ShaderCross_INTERNAL_GetMemoryStage(), size, false);
+}
+
+static void * SDLCALL SDL_ShaderCross_INTERNAL_MemoryStatsCalloc(size_t nmemb, size_t size)
+{
+    if (size != 0 && nmemb > SDL_SIZE_MAX / size) {
+        return NULL;
+    }
+    return SDL_ShaderCross_INTERNAL_TrackedAlloc(SDL_ShaderCross_INTERNAL_GetMemoryStage(), nmemb * size, true);
+}
+
+static void * SDLCALL SDL_ShaderCross_INTERNAL_MemoryStatsRealloc(void *mem, size_t size)
+{
+    return SDL_ShaderCross_INTERNAL_TrackedRealloc(SDL_ShaderCross_INTERNAL_GetMemoryStage(), mem, size);
+}
+
+static void SDLCALL SDL_ShaderCross_INTERNAL_MemoryStatsFree(void *mem)
+{
+    SDL_ShaderCross_INTERNAL_TrackedFree(mem);
+}
+
+bool SDL_ShaderCross_EnableMemoryStats(void)
+{
+    if (memoryStatsEnabled) {
+        return true;
+    }
+
+    SDL_GetMemoryFunctions(&memoryStatsMalloc, &memoryStatsCalloc, &memoryStatsRealloc, &memoryStatsFree);
+    if (!SDL_SetMemoryFunctions(
+            SDL_ShaderCross_INTERNAL_MemoryStatsMalloc,
+            SDL_ShaderCross_INTERNAL_MemoryStatsCalloc,
+            SDL_ShaderCross_INTERNAL_MemoryStatsRealloc,
+            SDL_ShaderCross_INTERNAL_MemoryStatsFree)) {
+        return false;
+    }
+
+    memoryStatsEnabled = true;
+    return true;
+}
+
+static MemoryStatsState *SDL_ShaderCross_INTERNAL_GetMemoryStatsState(void)
+{
+    MemoryStatsState *state;
+
+    if (!memoryStatsEnabled) {
+        SDL_SetError("%s", "Memory statistics are not enabled, call SDL_ShaderCross_EnableMemoryStats() first");
+        return NULL;
+    }
+
+    state = (MemoryStatsState *)SDL_GetTLS(&memoryStatsTLS);
+    if (state == NULL) {
+        // Allocated before it is installed, so the state's own block is not counted
+        state = (MemoryStatsState *)SDL_calloc(1, sizeof(MemoryStatsState));
+        if (state == NULL) {
+            return NULL;
+        }
+        if (!SDL_SetTLS(&memoryStatsTLS, state, SDL_free)) {
+            SDL_free(state);
+            return NULL;
+        }
+    }
+    return state;
+}
+
+bool SDL_ShaderCross_ResetMemoryStats(void)
+{
+    MemoryStatsState *state = SDL_ShaderCross_INTERNAL_GetMemoryStatsState();
+    if (state == NULL) {
+        return false;
+    }
+
+    SDL_zerop(state);
+    return true;
+}
+
+bool SDL_ShaderCross_GetMemoryStats(SDL_ShaderCross_MemoryStats *stats)
+{
+    MemoryStatsState *state;
+
+    if (stats == NULL) {
+        return SDL_InvalidParamError("stats");
+    }
+
+    state = SDL_ShaderCross_INTERNAL_GetMemoryStatsState();
+    if (state == NULL) {
+        return false;
+    }
+
+    SDL_copyp(stats, &state->stats);
+    return true;
+}
+
+/* Timing Statistics and Tracing */
+
+#if defined(SDL_PLATFORM_UNIX) || defined(SDL_PLATFORM_APPLE)
+#define SDL_SHADERCROSS_THREAD_CPU_TIME
+#include <time.h>
+#endif
+
+/* Not a stage, the time between stages is not charged to any of them */
+#define SDL_SHADERCROSS_TIMINGSTAGE_NONE SDL_SHADERCROSS_TIMINGSTAGE_COUNT
+
+typedef struct TimingStatsState
+{
+    SDL_ShaderCross_TimingStage stage; // the stage the time since the marks is charged to
+    Uint64 markWallNS;
+    Uint64 markCPUNS;
+    SDL_ShaderCross_TimingStats stats;
+} TimingStatsState;
+
+static SDL_TLSID timingStatsTLS;
+static SDL_ShaderCross_TraceCallback traceCallback;
+static void *traceUserdata;
+
+static const char *timingStageNames[SDL_SHADERCROSS_TIMINGSTAGE_COUNT] = { "HLSL to SPIRV", "transpile", "backend", "reflection" };
+
+static void SDL_ShaderCross_INTERNAL_TraceSpan(const char *name, bool begin)
+{
+    if (traceCallback != NULL) {
+        traceCallback(traceUserdata, name, begin);
+    }
+}
+
+void SDL_ShaderCross_SetTraceCallback(SDL_ShaderCross_TraceCallback callback, void *userdata)
+{
+    traceCallback = callback;
+    traceUserdata = userdata;
+}
+
+static Uint64 SDL_ShaderCross_INTERNAL_GetThreadCPUTimeNS(void)
+{
+#ifdef SDL_SHADERCROSS_THREAD_CPU_TIME
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return (Uint64)ts.tv_sec * SDL_NS_PER_SECOND + (Uint64)ts.tv_nsec;
+    }
+#endif
+    return 0;
+}
+
+/* Charges the time since the marks to the current stage and moves the marks to now */
+static void SDL_ShaderCross_INTERNAL_ChargeTime(TimingStatsState *state)
+{
+    Uint64 wallNS = SDL_GetTicksNS();
+    Uint64 cpuNS = SDL_ShaderCross_INTERNAL_GetThreadCPUTimeNS();
+    if (state->stage != SDL_SHADERCROSS_TIMINGSTAGE_NONE) {
+        state->stats.stages[state->stage].wall_ns += wallNS - state->markWallNS;
+        state->stats.stages[state->stage].cpu_ns += cpuNS - state->markCPUNS;
+    }
+    state->markWallNS = wallNS;
+    state->markCPUNS = cpuNS;
+}
+
+/* Returns the previous stage so it can be restored once the stage is done. Nested stages pause the outer one. */
+static SDL_ShaderCross_TimingStage SDL_ShaderCross_INTERNAL_BeginTimingStage(SDL_ShaderCross_TimingStage stage)
+{
+    SDL_ShaderCross_INTERNAL_TraceSpan(timingStageNames[stage], true);
+
+    TimingStatsState *state = (TimingStatsState *)SDL_GetTLS(&timingStatsTLS);
+    if (state == NULL) {
+        return SDL_SHADERCROSS_TIMINGSTAGE_NONE;
+    }
+
+    SDL_ShaderCross_INTERNAL_ChargeTime(state);
+    SDL_ShaderCross_TimingStage previous = state->stage;
+    state->stage = stage;
+    state->stats.stages[stage].num_calls += 1;
+    return previous;
+}
+
+static void SDL_ShaderCross_INTERNAL_EndTimingStage(SDL_ShaderCross_TimingStage stage, SDL_ShaderCross_TimingStage previous)
+{
+    TimingStatsState *state = (TimingStatsState *)SDL_GetTLS(&timingStatsTLS);
+    if (state != NULL) {
+        SDL_ShaderCross_INTERNAL_ChargeTime(state);
+        state->stage = previous;
+    }
+
+    SDL_ShaderCross_INTERNAL_TraceSpan(timingStageNames[stage], false);
+}
+
+bool SDL_ShaderCross_ResetTimingStats(void)
+{
+    TimingStatsState *state = (TimingStatsState *)SDL_GetTLS(&timingStatsTLS);
+    if (state == NULL) {
+        state = (TimingStatsState *)SDL_calloc(1, sizeof(TimingStatsState));
+        if (state == NULL) {
+            return false;
+        }
+        if (!SDL_SetTLS(&timingStatsTLS, state, SDL_free)) {
+            SDL_free(state);
+            return false;
+        }
+    }
+
+    SDL_zerop(state);
+    state->stage = SDL_SHADERCROSS_TIMINGSTAGE_NONE;
+    return true;
+}
+
+bool SDL_ShaderCross_GetTimingStats(SDL_ShaderCross_TimingStats *stats)
+{
+    if (stats == NULL) {
+        return SDL_InvalidParamError("stats");
+    }
+
+    TimingStatsState *state = (TimingStatsState *)SDL_GetTLS(&timingStatsTLS);
+    if (state == NULL) {
+        return SDL_SetError("%s", "Timing statistics are not enabled on this thread, call SDL_ShaderCross_ResetTimingStats() first");
+    }
+
+    SDL_copyp(stats, &state->stats);
+    return true;
+}
+
 /* Win32 Type Definitions */
 
 typedef int HRESULT;
@@ -50,7 +408,6 @@ typedef void *REFCLSID;
 typedef wchar_t *LPCWSTR;
 typedef void IDxcBlobEncoding;   /* hack, unused */
 typedef void IDxcBlobWide;       /* hack, unused */
-typedef void IDxcIncludeHandler; /* hack, unused */
 
 /* Unlike vkd3d-utils, libdxcompiler.so does not use msabi */
 #if !defined(_WIN32)
@@ -122,6 +479,33 @@ struct IDxcBlob
     IDxcBlobVtbl *lpVtbl;
 };
 
+static Uint8 IID_IDxcIncludeHandler[] = {
+    0x7D, 0xFC, 0x61, 0x7F,
+    0x0D, 0x95,
+    0x7F, 0x46,
+    0xB3,
+    0xE3,
+    0x3C,
+    0x02,
+    0xFB,
+    0x49,
+    0x18,
+    0x7C
+};
+typedef struct IDxcIncludeHandler IDxcIncludeHandler;
+typedef struct IDxcIncludeHandlerVtbl
+{
+    HRESULT(__stdcall *QueryInterface)(IDxcIncludeHandler *This, REFIID riid, void **ppvObject);
+    ULONG(__stdcall *AddRef)(IDxcIncludeHandler *This);
+    ULONG(__stdcall *Release)(IDxcIncludeHandler *This);
+
+    HRESULT(__stdcall *LoadSource)(IDxcIncludeHandler *This, LPCWSTR pFilename, IDxcBlob **ppIncludeSource);
+} IDxcIncludeHandlerVtbl;
+struct IDxcIncludeHandler
+{
+    const IDxcIncludeHandlerVtbl *lpVtbl;
+};
+
 static Uint8 IID_IDxcBlobUtf8[] = {
     0xC9, 0x36, 0xA6, 0x3D,
     0x71, 0xBA,
@@ -307,27 +691,260 @@ struct IDxcUtils
     const IDxcUtilsVtbl *lpVtbl;
 };
 
+typedef struct IMallocVtbl
+{
+    HRESULT (__stdcall *QueryInterface)(IMalloc *This, REFIID riid, void **ppvObject);
+    ULONG (__stdcall *AddRef)(IMalloc *This);
+    ULONG (__stdcall *Release)(IMalloc *This);
+
+    void *(__stdcall *Alloc)(IMalloc *This, SIZE_T cb);
+    void *(__stdcall *Realloc)(IMalloc *This, void *pv, SIZE_T cb);
+    void (__stdcall *Free)(IMalloc *This, void *pv);
+    SIZE_T (__stdcall *GetSize)(IMalloc *This, void *pv);
+    int (__stdcall *DidAlloc)(IMalloc *This, void *pv);
+    void (__stdcall *HeapMinimize)(IMalloc *This);
+} IMallocVtbl;
+struct IMalloc
+{
+    const IMallocVtbl *lpVtbl;
+};
+
 /* *INDENT-ON* */ // clang-format on
 
 /* DXCompiler */
 #if defined(SDL_PLATFORM_XBOXONE) || defined(SDL_PLATFORM_XBOXSERIES) || defined(SDL_PLATFORM_WINDOWS)
 extern HRESULT __stdcall DxcCreateInstance(REFCLSID rclsid, REFIID riid, LPVOID* ppv);
+extern HRESULT __stdcall DxcCreateInstance2(IMalloc *pMalloc, REFCLSID rclsid, REFIID riid, LPVOID *ppv);
 #else
 extern HRESULT DxcCreateInstance(REFCLSID rclsid, REFIID riid, LPVOID *ppv);
+extern HRESULT DxcCreateInstance2(IMalloc *pMalloc, REFCLSID rclsid, REFIID riid, LPVOID *ppv);
 #endif
 
+/* IMalloc handed to DXC when memory statistics are enabled, so its allocations are attributed to the DXC stage */
+static HRESULT __stdcall SDL_ShaderCross_INTERNAL_DXCMalloc_QueryInterface(IMalloc *This, REFIID riid, void **ppvObject)
+{
+    (void)This;
+    (void)riid;
+    *ppvObject = NULL;
+    return (HRESULT)0x80004002; // E_NOINTERFACE
+}
+
+static ULONG __stdcall SDL_ShaderCross_INTERNAL_DXCMalloc_AddRef(IMalloc *This)
+{
+    (void)This;
+    return 1; // statically allocated
+}
+
+static ULONG __stdcall SDL_ShaderCross_INTERNAL_DXCMalloc_Release(IMalloc *This)
+{
+    (void)This;
+    return 1;
+}
+
+static void *__stdcall SDL_ShaderCross_INTERNAL_DXCMalloc_Alloc(IMalloc *This, SIZE_T cb)
+{
+    (void)This;
+    return SDL_ShaderCross_INTERNAL_TrackedAlloc(SDL_SHADERCROSS_MEMORYSTAGE_DXC, cb, false);
+}
+
+static void *__stdcall SDL_ShaderCross_INTERNAL_DXCMalloc_Realloc(IMalloc *This, void *pv, SIZE_T cb)
+{
+    (void)This;
+    return SDL_ShaderCross_INTERNAL_TrackedRealloc(SDL_SHADERCROSS_MEMORYSTAGE_DXC, pv, cb);
+}
+
+static void __stdcall SDL_ShaderCross_INTERNAL_DXCMalloc_Free(IMalloc *This, void *pv)
+{
+    (void)This;
+    SDL_ShaderCross_INTERNAL_TrackedFree(pv);
+}
+
+static SIZE_T __stdcall SDL_ShaderCross_INTERNAL_DXCMalloc_GetSize(IMalloc *This, void *pv)
+{
+    (void)This;
+    return pv != NULL ? ((MemoryStatsHeader *)pv - 1)->info.size : (SIZE_T)-1;
+}
+
+static int __stdcall SDL_ShaderCross_INTERNAL_DXCMalloc_DidAlloc(IMalloc *This, void *pv)
+{
+    (void)This;
+    return pv != NULL ? -1 : 0; // -1 means "don't know"
+}
+
+static void __stdcall SDL_ShaderCross_INTERNAL_DXCMalloc_HeapMinimize(IMalloc *This)
+{
+    (void)This;
+}
+
+static const IMallocVtbl dxcMemoryStatsMallocVtbl = {
+    SDL_ShaderCross_INTERNAL_DXCMalloc_QueryInterface,
+    SDL_ShaderCross_INTERNAL_DXCMalloc_AddRef,
+    SDL_ShaderCross_INTERNAL_DXCMalloc_Release,
+    SDL_ShaderCross_INTERNAL_DXCMalloc_Alloc,
+    SDL_ShaderCross_INTERNAL_DXCMalloc_Realloc,
+    SDL_ShaderCross_INTERNAL_DXCMalloc_Free,
+    SDL_ShaderCross_INTERNAL_DXCMalloc_GetSize,
+    SDL_ShaderCross_INTERNAL_DXCMalloc_DidAlloc,
+    SDL_ShaderCross_INTERNAL_DXCMalloc_HeapMinimize
+};
+static IMalloc dxcMemoryStatsMalloc = { &dxcMemoryStatsMallocVtbl };
+
+static HRESULT SDL_ShaderCross_INTERNAL_CreateDXCInstance(REFCLSID rclsid, REFIID riid, LPVOID *ppv)
+{
+    HRESULT ret;
+    SDL_ShaderCross_INTERNAL_TraceSpan("DxcCreateInstance", true);
+    if (memoryStatsEnabled) {
+        ret = DxcCreateInstance2(&dxcMemoryStatsMalloc, rclsid, riid, ppv);
+    } else {
+        ret = DxcCreateInstance(rclsid, riid, ppv);
+    }
+    SDL_ShaderCross_INTERNAL_TraceSpan("DxcCreateInstance", false);
+    return ret;
+}
+
+/* Include handler that forwards to DXC's default one, resolving relative paths
+ * against a base directory rather than the working directory, and reports every
+ * file it opened by the path DXC asked for.
+ */
+typedef struct DXCTrackingIncludeHandler
+{
+    IDxcIncludeHandler base; // must be first
+    IDxcIncludeHandler *inner;
+    const char *baseDirectory; // may be NULL
+    SDL_ShaderCross_IncludeCallback callback; // may be NULL
+    void *userdata;
+} DXCTrackingIncludeHandler;
+
+static HRESULT __stdcall SDL_ShaderCross_INTERNAL_DXCInclude_QueryInterface(IDxcIncludeHandler *This, REFIID riid, void **ppvObject)
+{
+    if (SDL_memcmp(riid, IID_IDxcIncludeHandler, sizeof(IID_IDxcIncludeHandler)) == 0) {
+        *ppvObject = This;
+        return 0;
+    }
+    *ppvObject = NULL;
+    return (HRESULT)0x80004002; // E_NOINTERFACE
+}
+
+static ULONG __stdcall SDL_ShaderCross_INTERNAL_DXCInclude_AddRef(IDxcIncludeHandler *This)
+{
+    (void)This;
+    return 1; // lives on the stack of the compile
+}
+
+static ULONG __stdcall SDL_ShaderCross_INTERNAL_DXCInclude_Release(IDxcIncludeHandler *This)
+{
+    (void)This;
+    return 1;
+}
+
+static bool SDL_ShaderCross_INTERNAL_IsAbsolutePath(const char *path)
+{
+    return path[0] == '/' || path[0] == '\\' || (path[0] != '\0' && path[1] == ':');
+}
+
+static HRESULT __stdcall SDL_ShaderCross_INTERNAL_DXCInclude_LoadSource(IDxcIncludeHandler *This, LPCWSTR pFilename, IDxcBlob **ppIncludeSource)
+{
+    DXCTrackingIncludeHandler *handler = (DXCTrackingIncludeHandler *)This;
+    char *path = SDL_iconv_string("UTF-8", "WCHAR_T", (const char *)pFilename, (SDL_wcslen(pFilename) + 1) * sizeof(wchar_t));
+    HRESULT ret;
+
+    if (handler->baseDirectory != NULL && path != NULL && !SDL_ShaderCross_INTERNAL_IsAbsolutePath(path)) {
+        char *fullPath = NULL;
+        wchar_t *fullPathUtf16 = NULL;
+        if (SDL_asprintf(&fullPath, "%s/%s", handler->baseDirectory, path) >= 0) {
+            fullPathUtf16 = (wchar_t *)SDL_iconv_string("WCHAR_T", "UTF-8", fullPath, SDL_strlen(fullPath) + 1);
+        }
+        if (fullPathUtf16 != NULL) {
+            ret = handler->inner->lpVtbl->LoadSource(handler->inner, fullPathUtf16, ppIncludeSource);
+        } else {
+            *ppIncludeSource = NULL;
+            ret = (HRESULT)0x8007000E; // E_OUTOFMEMORY
+        }
+        SDL_free(fullPathUtf16);
+        SDL_free(fullPath);
+    } else {
+        ret = handler->inner->lpVtbl->LoadSource(handler->inner, pFilename, ppIncludeSource);
+    }
+
+    // DXC probes every include directory in turn, only the files that were found matter
+    if (ret >= 0 && *ppIncludeSource != NULL && path != NULL && handler->callback != NULL) {
+        handler->callback(handler->userdata, path);
+    }
+    SDL_free(path);
+    return ret;
+}
+
+static const IDxcIncludeHandlerVtbl dxcTrackingIncludeHandlerVtbl = {
+    SDL_ShaderCross_INTERNAL_DXCInclude_QueryInterface,
+    SDL_ShaderCross_INTERNAL_DXCInclude_AddRef,
+    SDL_ShaderCross_INTERNAL_DXCInclude_Release,
+    SDL_ShaderCross_INTERNAL_DXCInclude_LoadSource
+};
+
 #endif /* SDL_SHADERCROSS_DXC */
 
-static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
+// Fills in -1 when the compiler should use its own default
+static bool SDL_ShaderCross_INTERNAL_GetOptimizationLevel(SDL_PropertiesID props, int *level)
+{
+    Sint64 value = SDL_GetNumberProperty(props, SDL_SHADERCROSS_PROP_SHADER_OPTIMIZATION_LEVEL_NUMBER, -1);
+    if (value < -1 || value > 3) {
+        SDL_SetError("Invalid optimization level %" SDL_PRIs64 ", must be between 0 and 3", value);
+        return false;
+    }
+    *level = (int)value;
+    return true;
+}
+
+#define SHADER_PROFILE_LENGTH 8
+
+// Shader models are encoded as in SPIRV-Cross, major * 10 + minor
+static bool SDL_ShaderCross_INTERNAL_GetDXILShaderModel(SDL_PropertiesID props, unsigned *shaderModel)
+{
+    // Native 16-bit types were introduced in SM 6.2
+    bool enable16BitTypes = SDL_GetBooleanProperty(props, SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN, false);
+    Sint64 value = SDL_GetNumberProperty(props, SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER, enable16BitTypes ? 62 : 60);
+    if (value < 60 || value > 69) {
+        SDL_SetError("Invalid DXIL shader model %" SDL_PRIs64 ", must be between 60 and 69", value);
+        return false;
+    }
+    if (enable16BitTypes && value < 62) {
+        SDL_SetError("16-bit types require shader model 62 or later, %" SDL_PRIs64 " was requested", value);
+        return false;
+    }
+    *shaderModel = (unsigned)value;
+    return true;
+}
+
+// Fills in a profile such as "ps_6_5" into a buffer of SHADER_PROFILE_LENGTH characters
+static bool SDL_ShaderCross_INTERNAL_GetShaderProfile(SDL_ShaderCross_ShaderStage shaderStage, unsigned shaderModel, char *profile)
+{
+    const char *prefix;
+    if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_VERTEX) {
+        prefix = "vs";
+    } else if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT) {
+        prefix = "ps";
+    } else if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+        prefix = "cs";
+    } else {
+        SDL_SetError("Invalid shader stage %d", (int)shaderStage);
+        return false;
+    }
+
+    SDL_snprintf(profile, SHADER_PROFILE_LENGTH, "%s_%u_%u", prefix, shaderModel / 10, shaderModel % 10);
+    return true;
+}
+
+static void *SDL_ShaderCross_INTERNAL_DoCompileUsingDXC(
     const SDL_ShaderCross_HLSL_Info *info,
     bool spirv,
     size_t *size) // filled in with number of bytes of returned buffer
 {
 #ifdef SDL_SHADERCROSS_DXC
+    static const wchar_t *optimizationArgs[] = { L"-Od", L"-O1", L"-O2", L"-O3" };
     DxcBuffer source;
-    IDxcResult *dxcResult;
-    IDxcBlob *blob;
-    IDxcBlobUtf8 *errors;
+    IDxcResult *dxcResult = NULL;
+    IDxcBlob *blob = NULL;
+    IDxcBlobUtf8 *errors = NULL;
     size_t entryPointLength = SDL_utf8strlen(info->entrypoint) + 1;
     wchar_t *entryPointUtf16 = NULL;
     size_t includeDirLength = 0;
@@ -335,48 +952,71 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
     wchar_t *nameUtf16 = NULL;
     wchar_t **defineStringsUtf16 = NULL;
     size_t numDefineStrings = 0;
+    char defineString[MAX_DEFINE_STRING_LENGTH];
+    LPCWSTR *args = NULL;
+    Uint32 argCount = 0;
     HRESULT ret;
+    HRESULT retStatus;
+    void *buffer = NULL;
 
     /* Non-static DxcInstance, since the functions we call on it are not thread-safe */
     IDxcCompiler3 *dxcInstance = NULL;
     IDxcUtils *utils = NULL;
     IDxcIncludeHandler *includeHandler = NULL;
+    DXCTrackingIncludeHandler trackingIncludeHandler;
+    const SDL_ShaderCross_IncludeCallbackInfo *includeCallback;
+    const char *includeBaseDirectory;
+    int optimizationLevel;
 
-    DxcCreateInstance(
-        &CLSID_DxcCompiler,
-        IID_IDxcCompiler3,
+    SDL_zero(trackingIncludeHandler);
+
+    unsigned shaderModel;
+    char profile[SHADER_PROFILE_LENGTH];
+    wchar_t profileUtf16[SHADER_PROFILE_LENGTH];
+
+    if (!SDL_ShaderCross_INTERNAL_GetOptimizationLevel(info->props, &optimizationLevel)) {
+        return NULL;
+    }
+
+    // The SPIR-V path uses the same profile, so that source relying on newer intrinsics still compiles
+    if (!SDL_ShaderCross_INTERNAL_GetDXILShaderModel(info->props, &shaderModel) ||
+        !SDL_ShaderCross_INTERNAL_GetShaderProfile(info->shader_stage, shaderModel, profile)) {
+        return NULL;
+    }
+    for (int i = 0; i < SHADER_PROFILE_LENGTH; i += 1) {
+        profileUtf16[i] = (wchar_t)profile[i];
+    }
+
+    SDL_ShaderCross_INTERNAL_CreateDXCInstance(
+        &CLSID_DxcCompiler,
+        IID_IDxcCompiler3,
         (void **)&dxcInstance);
 
-    DxcCreateInstance(
+    SDL_ShaderCross_INTERNAL_CreateDXCInstance(
         &CLSID_DxcUtils,
         &IID_IDxcUtils,
         (void **)(&utils));
 
     if (dxcInstance == NULL) {
         SDL_SetError("%s", "Could not create DXC instance!");
-        return NULL;
+        goto done;
     }
 
     if (utils == NULL) {
         SDL_SetError("%s", "Could not create DXC utils instance!");
-        dxcInstance->lpVtbl->Release(dxcInstance);
-        return NULL;
+        goto done;
     }
 
     utils->lpVtbl->CreateDefaultIncludeHandler(utils, &includeHandler);
     if (includeHandler == NULL) {
         SDL_SetError("%s", "Failed to create a default include handler!");
-        dxcInstance->lpVtbl->Release(dxcInstance);
-        utils->lpVtbl->Release(utils);
-        return NULL;
+        goto done;
     }
 
     entryPointUtf16 = (wchar_t *)SDL_iconv_string("WCHAR_T", "UTF-8", info->entrypoint, entryPointLength);
     if (entryPointUtf16 == NULL) {
         SDL_SetError("%s", "Failed to convert entrypoint to WCHAR_T!");
-        dxcInstance->lpVtbl->Release(dxcInstance);
-        utils->lpVtbl->Release(utils);
-        return NULL;
+        goto done;
     }
 
     if (info->defines != NULL) {
@@ -388,8 +1028,12 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
         }
     }
 
-    char defineString[MAX_DEFINE_STRING_LENGTH];
-    defineStringsUtf16 = SDL_malloc(sizeof(LPCWSTR) * numDefineStrings);
+    defineStringsUtf16 = SDL_calloc(SDL_max(numDefineStrings, 1), sizeof(wchar_t *));
+    args = SDL_malloc(sizeof(LPCWSTR) * (numDefineStrings + 15));
+    if (defineStringsUtf16 == NULL || args == NULL) {
+        goto done;
+    }
+
     for (Uint32 i = 0; i < numDefineStrings; i += 1) {
         if (info->defines[i].value == NULL) {
             SDL_snprintf(defineString, MAX_DEFINE_STRING_LENGTH, "-D%s=%s", info->defines[i].name, "1");
@@ -398,12 +1042,10 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
         }
 
         defineStringsUtf16[i] = (wchar_t *)SDL_iconv_string("WCHAR_T", "UTF-8", defineString, MAX_DEFINE_STRING_LENGTH);
-    }
-
-    LPCWSTR *args = SDL_malloc(sizeof(LPCWSTR) * (numDefineStrings + 13));
-    Uint32 argCount = 0;
-
-    for (Uint32 i = 0; i < numDefineStrings; i += 1) {
+        if (defineStringsUtf16[i] == NULL) {
+            SDL_SetError("%s", "Failed to convert define to WCHAR_T!");
+            goto done;
+        }
         args[argCount++] = defineStringsUtf16[i];
     }
 
@@ -416,13 +1058,7 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
 
         if (includeDirUtf16 == NULL) {
             SDL_SetError("%s", "Failed to convert include dir to WCHAR_T!");
-            dxcInstance->lpVtbl->Release(dxcInstance);
-            utils->lpVtbl->Release(utils);
-            SDL_free(entryPointUtf16);
-            for (Uint32 i = 0; i < numDefineStrings; i += 1) {
-                SDL_free(defineStringsUtf16[i]);
-            }
-            return NULL;
+            goto done;
         }
         args[argCount++] = (LPCWSTR)L"-I";
         args[argCount++] = includeDirUtf16;
@@ -432,16 +1068,8 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
     source.Size = SDL_strlen(info->source) + 1;
     source.Encoding = DXC_CP_ACP;
 
-    if (info->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_VERTEX) {
-        args[argCount++] = (LPCWSTR)L"-T";
-        args[argCount++] = (LPCWSTR)L"vs_6_0";
-    } else if (info->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT) {
-        args[argCount++] = (LPCWSTR)L"-T";
-        args[argCount++] = (LPCWSTR)L"ps_6_0";
-    } else { // compute
-        args[argCount++] = (LPCWSTR)L"-T";
-        args[argCount++] = (LPCWSTR)L"cs_6_0";
-    }
+    args[argCount++] = (LPCWSTR)L"-T";
+    args[argCount++] = (LPCWSTR)profileUtf16;
 
     if (spirv) {
         args[argCount++] = (LPCWSTR)L"-spirv";
@@ -455,6 +1083,15 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
         args[argCount++] = (LPCWSTR)L"-fspv-preserve-interface";
     }
 
+    if (optimizationLevel >= 0) {
+        args[argCount++] = (LPCWSTR)optimizationArgs[optimizationLevel];
+    }
+
+    if (SDL_GetBooleanProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN, false)) {
+        // Also makes min16float and friends native 16-bit types
+        args[argCount++] = (LPCWSTR)L"-enable-16bit-types";
+    }
+
     if (SDL_GetBooleanProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, false)) {
         if (spirv) {
             // https://github.com/microsoft/DirectXShaderCompiler/blob/main/docs/SPIR-V.rst#debugging
@@ -477,38 +1114,35 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
     args[argCount++] = L"-D__XBOX_DISABLE_PRECOMPILE=1";
 #endif
 
+    includeCallback = (const SDL_ShaderCross_IncludeCallbackInfo *)SDL_GetPointerProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_INCLUDE_CALLBACK_POINTER, NULL);
+    includeBaseDirectory = SDL_GetStringProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_INCLUDE_BASE_DIRECTORY_STRING, NULL);
+    if ((includeCallback != NULL && includeCallback->callback != NULL) || includeBaseDirectory != NULL) {
+        trackingIncludeHandler.base.lpVtbl = &dxcTrackingIncludeHandlerVtbl;
+        trackingIncludeHandler.inner = includeHandler;
+        trackingIncludeHandler.baseDirectory = includeBaseDirectory;
+        if (includeCallback != NULL) {
+            trackingIncludeHandler.callback = includeCallback->callback;
+            trackingIncludeHandler.userdata = includeCallback->userdata;
+        }
+    }
+
+    SDL_ShaderCross_INTERNAL_TraceSpan("IDxcCompiler3::Compile", true);
     ret = dxcInstance->lpVtbl->Compile(
         dxcInstance,
         &source,
         args,
         argCount,
-        includeHandler,
+        trackingIncludeHandler.base.lpVtbl != NULL ? &trackingIncludeHandler.base : includeHandler,
         IID_IDxcResult,
         (void **)&dxcResult);
-
-    SDL_free(args);
-    SDL_free(entryPointUtf16);
-    for (Uint32 i = 0; i < numDefineStrings; i += 1) {
-        SDL_free(defineStringsUtf16[i]);
-    }
-    SDL_free(defineStringsUtf16);
-    if (includeDirUtf16 != NULL) {
-        SDL_free(includeDirUtf16);
-    }
-    if (nameUtf16 != NULL) {
-        SDL_free(nameUtf16);
-    }
+    SDL_ShaderCross_INTERNAL_TraceSpan("IDxcCompiler3::Compile", false);
 
     if (ret < 0) {
         SDL_SetError("IDxcShaderCompiler3::Compile failed: %X", ret);
-        dxcInstance->lpVtbl->Release(dxcInstance);
-        utils->lpVtbl->Release(utils);
-        return NULL;
+        goto done;
     } else if (dxcResult == NULL) {
         SDL_SetError("%s", "HLSL compilation failed with no IDxcResult");
-        dxcInstance->lpVtbl->Release(dxcInstance);
-        utils->lpVtbl->Release(utils);
-        return NULL;
+        goto done;
     }
 
     ret = dxcResult->lpVtbl->GetOutput(dxcResult,
@@ -517,16 +1151,15 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
                                        (void **)&blob,
                                        NULL);
 
-    HRESULT retStatus;
-    if (ret < 0 || dxcResult->lpVtbl->GetStatus(dxcResult, &retStatus) < 0 || retStatus < 0 ) {
-        // Compilation failed, display errors
-        dxcResult->lpVtbl->GetOutput(
-            dxcResult,
-            DXC_OUT_ERRORS,
-            IID_IDxcBlobUtf8,
-            (void **)&errors,
-            NULL);
+    dxcResult->lpVtbl->GetOutput(
+        dxcResult,
+        DXC_OUT_ERRORS,
+        IID_IDxcBlobUtf8,
+        (void **)&errors,
+        NULL);
 
+    if (ret < 0 || blob == NULL || dxcResult->lpVtbl->GetStatus(dxcResult, &retStatus) < 0 || retStatus < 0 ) {
+        // Compilation failed, display errors
         if (errors != NULL && errors->lpVtbl->GetBufferSize(errors) != 0) {
             SDL_SetError(
             "HLSL compilation failed: %s",
@@ -534,36 +1167,51 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
         } else {
             SDL_SetError("%s", "Compilation failed with unknown error");
         }
-
-        // teardown
-        dxcResult->lpVtbl->Release(dxcResult);
-        dxcInstance->lpVtbl->Release(dxcInstance);
-        utils->lpVtbl->Release(utils);
-        return NULL;
+        goto done;
     }
 
     // If compilation succeeded, but there are errors, those are warnings
-    dxcResult->lpVtbl->GetOutput(
-        dxcResult,
-        DXC_OUT_ERRORS,
-        IID_IDxcBlobUtf8,
-        (void **)&errors,
-        NULL);
-
     if (errors != NULL && errors->lpVtbl->GetBufferSize(errors) != 0) {
         SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "HLSL compiled with warnings: %s",
             (char *)errors->lpVtbl->GetBufferPointer(errors));
     }
 
     *size = blob->lpVtbl->GetBufferSize(blob);
-    void *buffer = SDL_malloc(*size);
-    SDL_memcpy(buffer, blob->lpVtbl->GetBufferPointer(blob), *size);
-
-    blob->lpVtbl->Release(blob);
-    dxcResult->lpVtbl->Release(dxcResult);
-    dxcInstance->lpVtbl->Release(dxcInstance);
-    utils->lpVtbl->Release(utils);
+    buffer = SDL_malloc(*size);
+    if (buffer != NULL) {
+        SDL_memcpy(buffer, blob->lpVtbl->GetBufferPointer(blob), *size);
+    }
 
+done:
+    // Every exit after the instances are created comes through here, so nothing leaks on errors
+    if (errors != NULL) {
+        errors->lpVtbl->Release(errors);
+    }
+    if (blob != NULL) {
+        blob->lpVtbl->Release(blob);
+    }
+    if (dxcResult != NULL) {
+        dxcResult->lpVtbl->Release(dxcResult);
+    }
+    if (includeHandler != NULL) {
+        includeHandler->lpVtbl->Release(includeHandler);
+    }
+    if (utils != NULL) {
+        utils->lpVtbl->Release(utils);
+    }
+    if (dxcInstance != NULL) {
+        dxcInstance->lpVtbl->Release(dxcInstance);
+    }
+    SDL_free(args);
+    SDL_free(entryPointUtf16);
+    if (defineStringsUtf16 != NULL) {
+        for (Uint32 i = 0; i < numDefineStrings; i += 1) {
+            SDL_free(defineStringsUtf16[i]);
+        }
+        SDL_free(defineStringsUtf16);
+    }
+    SDL_free(includeDirUtf16);
+    SDL_free(nameUtf16);
     return buffer;
 #else
     SDL_SetError("%s", "Shadercross was not built with DXC support, cannot compile using DXC!");
@@ -571,6 +1219,326 @@ static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
 #endif /* SDL_SHADERCROSS_DXC */
 }
 
+static void *SDL_ShaderCross_INTERNAL_CompileUsingDXC(
+    const SDL_ShaderCross_HLSL_Info *info,
+    bool spirv,
+    size_t *size) // filled in with number of bytes of returned buffer
+{
+    SDL_ShaderCross_TimingStage stage = spirv ? SDL_SHADERCROSS_TIMINGSTAGE_HLSL_TO_SPIRV : SDL_SHADERCROSS_TIMINGSTAGE_BACKEND;
+    SDL_ShaderCross_TimingStage previousStage = SDL_ShaderCross_INTERNAL_BeginTimingStage(stage);
+    void *result = SDL_ShaderCross_INTERNAL_DoCompileUsingDXC(info, spirv, size);
+    SDL_ShaderCross_INTERNAL_EndTimingStage(stage, previousStage);
+    return result;
+}
+
+/* HLSL Roundtrip Detection */
+
+static bool SDL_ShaderCross_INTERNAL_IsIdentifierChar(char c)
+{
+    return SDL_isalnum((unsigned char)c) || c == '_';
+}
+
+/* Returns a copy of source with comments and string and character literals
+ * blanked out, so that text in them can't be mistaken for code. Newlines are
+ * kept so that the layout of the source doesn't change. */
+static char *SDL_ShaderCross_INTERNAL_StripHLSLCommentsAndLiterals(const char *source)
+{
+    char *stripped = SDL_strdup(source);
+    char *p = stripped;
+
+    if (stripped == NULL) {
+        return NULL;
+    }
+
+    while (*p != '\0') {
+        if (p[0] == '/' && p[1] == '/') {
+            while (*p != '\0' && *p != '\n') {
+                *p = ' ';
+                p += 1;
+            }
+        } else if (p[0] == '/' && p[1] == '*') {
+            p[0] = ' ';
+            p[1] = ' ';
+            p += 2;
+            while (*p != '\0' && !(p[0] == '*' && p[1] == '/')) {
+                if (*p != '\n') {
+                    *p = ' ';
+                }
+                p += 1;
+            }
+            if (*p != '\0') {
+                p[0] = ' ';
+                p[1] = ' ';
+                p += 2;
+            }
+        } else if (*p == '"' || *p == '\'') {
+            char quote = *p;
+            *p = ' ';
+            p += 1;
+            while (*p != '\0' && *p != quote && *p != '\n') {
+                if (*p == '\\' && p[1] != '\0') {
+                    *p = ' ';
+                    p += 1;
+                }
+                if (*p != '\n') {
+                    *p = ' ';
+                }
+                p += 1;
+            }
+            if (*p == quote) {
+                *p = ' ';
+                p += 1;
+            }
+        } else {
+            p += 1;
+        }
+    }
+
+    return stripped;
+}
+
+/* Finds the next identifier in [*cursor, end) and advances the cursor past it.
+ * Numeric literals are skipped, so "1space1" never yields "space1". */
+static bool SDL_ShaderCross_INTERNAL_NextIdentifier(
+    const char **cursor,
+    const char *end,
+    const char **identifier,
+    size_t *length)
+{
+    const char *p = *cursor;
+
+    while (p < end) {
+        if (!SDL_ShaderCross_INTERNAL_IsIdentifierChar(*p)) {
+            p += 1;
+            continue;
+        }
+        const char *start = p;
+        while (p < end && SDL_ShaderCross_INTERNAL_IsIdentifierChar(*p)) {
+            p += 1;
+        }
+        if (SDL_isdigit((unsigned char)*start)) {
+            continue;
+        }
+        *cursor = p;
+        *identifier = start;
+        *length = (size_t)(p - start);
+        return true;
+    }
+
+    *cursor = p;
+    return false;
+}
+
+static bool SDL_ShaderCross_INTERNAL_IdentifierIs(
+    const char *identifier,
+    size_t length,
+    const char *word)
+{
+    return SDL_strlen(word) == length && SDL_strncmp(identifier, word, length) == 0;
+}
+
+static bool SDL_ShaderCross_INTERNAL_IdentifierStartsWith(
+    const char *identifier,
+    size_t length,
+    const char *prefix)
+{
+    size_t prefixLength = SDL_strlen(prefix);
+    return prefixLength <= length && SDL_strncmp(identifier, prefix, prefixLength) == 0;
+}
+
+static bool SDL_ShaderCross_INTERNAL_IdentifierEndsWith(
+    const char *identifier,
+    size_t length,
+    const char *suffix)
+{
+    size_t suffixLength = SDL_strlen(suffix);
+    return suffixLength <= length && SDL_strncmp(identifier + length - suffixLength, suffix, suffixLength) == 0;
+}
+
+// Checks whether the identifier word appears in [start, end).
+static bool SDL_ShaderCross_INTERNAL_RangeHasIdentifier(
+    const char *start,
+    const char *end,
+    const char *word)
+{
+    const char *identifier;
+    size_t length;
+    while (SDL_ShaderCross_INTERNAL_NextIdentifier(&start, end, &identifier, &length)) {
+        if (SDL_ShaderCross_INTERNAL_IdentifierIs(identifier, length, word)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Identifiers that FXC's SM 5.1 front end cannot parse.
+static bool SDL_ShaderCross_INTERNAL_IsDXCOnlyIdentifier(
+    const char *identifier,
+    size_t length,
+    const char *next,
+    const char *end)
+{
+    static const char *keywords[] = {
+        "template",
+        "namespace",
+        "ResourceDescriptorHeap",
+        "SamplerDescriptorHeap"
+    };
+    // Wave intrinsics and quad reads.
+    static const char *prefixes[] = {
+        "Wave",
+        "QuadRead"
+    };
+    // Explicitly sized types such as uint16_t and float64_t.
+    static const char *suffixes[] = {
+        "16_t",
+        "64_t"
+    };
+
+    for (size_t i = 0; i < SDL_arraysize(keywords); i += 1) {
+        if (SDL_ShaderCross_INTERNAL_IdentifierIs(identifier, length, keywords[i])) {
+            return true;
+        }
+    }
+    for (size_t i = 0; i < SDL_arraysize(prefixes); i += 1) {
+        if (SDL_ShaderCross_INTERNAL_IdentifierStartsWith(identifier, length, prefixes[i])) {
+            return true;
+        }
+    }
+    for (size_t i = 0; i < SDL_arraysize(suffixes); i += 1) {
+        if (SDL_ShaderCross_INTERNAL_IdentifierEndsWith(identifier, length, suffixes[i])) {
+            return true;
+        }
+    }
+
+    // "enum class"
+    if (SDL_ShaderCross_INTERNAL_IdentifierIs(identifier, length, "enum")) {
+        const char *nextIdentifier;
+        size_t nextLength;
+        if (SDL_ShaderCross_INTERNAL_NextIdentifier(&next, end, &nextIdentifier, &nextLength) &&
+            SDL_ShaderCross_INTERNAL_IdentifierIs(nextIdentifier, nextLength, "class")) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* The roundtrip rewrites stage inputs and outputs to TEXCOORD<location>,
+ * turns never-written UAVs into SRVs and resolves Vulkan binding attributes,
+ * so the original source can only be compiled directly when none of that
+ * would change what SDL_GPU binds. This is deliberately conservative: only
+ * compute shaders are considered, since their interface is just resources.
+ * The source is matched by identifier with comments and literals removed.
+ */
+static bool SDL_ShaderCross_INTERNAL_HLSLNeedsRoundtrip(
+    const SDL_ShaderCross_HLSL_Info *info,
+    bool dxbc)
+{
+    static const char *uavTypes[] = {
+        "RWTexture",
+        "RWBuffer",
+        "RWStructuredBuffer",
+        "RWByteAddressBuffer",
+        "RasterizerOrdered",
+        "AppendStructuredBuffer",
+        "ConsumeStructuredBuffer"
+    };
+    const char *identifier;
+    size_t length;
+    bool needsRoundtrip = false;
+
+    if (info->shader_stage != SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+        return true;
+    }
+
+    // Included files can't be inspected from here.
+    if (info->include_dir != NULL) {
+        return true;
+    }
+
+    // FXC is called without defines.
+    if (dxbc && info->defines != NULL && info->defines->name != NULL) {
+        return true;
+    }
+
+    char *source = SDL_ShaderCross_INTERNAL_StripHLSLCommentsAndLiterals(info->source);
+    if (source == NULL) {
+        return true;
+    }
+    const char *end = source + SDL_strlen(source);
+    const char *cursor = source;
+
+    if (SDL_strstr(source, "[[vk::") != NULL) {
+        needsRoundtrip = true;
+    }
+
+    while (!needsRoundtrip && SDL_ShaderCross_INTERNAL_NextIdentifier(&cursor, end, &identifier, &length)) {
+        if (SDL_ShaderCross_INTERNAL_IdentifierIs(identifier, length, "include")) {
+            const char *p = identifier;
+            while (p > source && (p[-1] == ' ' || p[-1] == '\t')) {
+                p -= 1;
+            }
+            if (p > source && p[-1] == '#') {
+                needsRoundtrip = true;
+                break;
+            }
+        }
+
+        if (dxbc && SDL_ShaderCross_INTERNAL_IsDXCOnlyIdentifier(identifier, length, cursor, end)) {
+            needsRoundtrip = true;
+            break;
+        }
+
+        /* Read-write resources must be declared in the compute read-write space,
+         * otherwise the roundtrip may demote them to SRVs. */
+        for (size_t i = 0; i < SDL_arraysize(uavTypes); i += 1) {
+            if (SDL_ShaderCross_INTERNAL_IdentifierStartsWith(identifier, length, uavTypes[i])) {
+                const char *declarationEnd = SDL_strchr(cursor, ';');
+                if (declarationEnd == NULL) {
+                    declarationEnd = end;
+                }
+                if (!SDL_ShaderCross_INTERNAL_RangeHasIdentifier(cursor, declarationEnd, "space1")) {
+                    needsRoundtrip = true;
+                }
+                break;
+            }
+        }
+    }
+
+    SDL_free(source);
+    return needsRoundtrip;
+}
+
+/* Decides whether the source is compiled through SPIR-V. Returns false and
+ * sets an error if the roundtrip property holds an unknown mode. */
+static bool SDL_ShaderCross_INTERNAL_ShouldRoundtripHLSL(
+    const SDL_ShaderCross_HLSL_Info *info,
+    bool dxbc,
+    bool *roundtrip)
+{
+    const char *defaultMode = "always";
+#if SDL_PLATFORM_GDK
+    // GDK sources are expected to be written against the D3D12 register layout already.
+    if (!dxbc) {
+        defaultMode = "never";
+    }
+#endif
+    const char *mode = SDL_GetStringProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_HLSL_ROUNDTRIP_STRING, defaultMode);
+
+    if (SDL_strcasecmp(mode, "never") == 0) {
+        *roundtrip = false;
+    } else if (SDL_strcasecmp(mode, "auto") == 0) {
+        *roundtrip = SDL_ShaderCross_INTERNAL_HLSLNeedsRoundtrip(info, dxbc);
+    } else if (SDL_strcasecmp(mode, "always") == 0) {
+        *roundtrip = true;
+    } else {
+        SDL_SetError("Unknown HLSL roundtrip mode \"%s\", expected \"always\", \"auto\" or \"never\"", mode);
+        return false;
+    }
+    return true;
+}
+
 void *SDL_ShaderCross_CompileDXILFromHLSL(
     const SDL_ShaderCross_HLSL_Info *info,
     size_t *size)
@@ -580,13 +1548,19 @@ void *SDL_ShaderCross_CompileDXILFromHLSL(
         return NULL;
     }
 
-#if SDL_PLATFORM_GDK
-    return SDL_ShaderCross_INTERNAL_CompileUsingDXC(info, false, size);
-#else
+    bool roundtrip;
+    if (!SDL_ShaderCross_INTERNAL_ShouldRoundtripHLSL(info, false, &roundtrip)) {
+        return NULL;
+    }
+    if (!roundtrip) {
+        return SDL_ShaderCross_INTERNAL_CompileUsingDXC(info, false, size);
+    }
+
     // Roundtrip to SPIR-V to support things like Structured Buffers.
     size_t spirvSize;
-    void *spirv = SDL_ShaderCross_CompileSPIRVFromHLSL(
+    void *spirv = SDL_ShaderCross_INTERNAL_CompileUsingDXC(
         info,
+        true,
         &spirvSize);
 
     if (spirv == NULL) {
@@ -618,9 +1592,11 @@ void *SDL_ShaderCross_CompileDXILFromHLSL(
         size);
     SDL_free(translatedSource);
     return result;
-#endif
 }
 
+static bool SDL_ShaderCross_INTERNAL_StripSPIRV(Uint32 *words, size_t *wordCount);
+static bool SDL_ShaderCross_INTERNAL_OptimizeSPIRV(const Uint32 *words, size_t wordCount, SDL_PropertiesID props, Uint32 **optimized, size_t *optimizedWordCount);
+
 void *SDL_ShaderCross_CompileSPIRVFromHLSL(
     const SDL_ShaderCross_HLSL_Info *info,
     size_t *size)
@@ -630,14 +1606,44 @@ void *SDL_ShaderCross_CompileSPIRVFromHLSL(
         return NULL;
     }
 
-    return SDL_ShaderCross_INTERNAL_CompileUsingDXC(
+    // Optimizing and stripping count towards the HLSL to SPIRV stage
+    // The stage is begun here rather than by SDL_ShaderCross_INTERNAL_CompileUsingDXC, so that it is counted once
+    SDL_ShaderCross_TimingStage previousStage = SDL_ShaderCross_INTERNAL_BeginTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_HLSL_TO_SPIRV);
+    void *spirv = SDL_ShaderCross_INTERNAL_DoCompileUsingDXC(
         info,
         true,
         size);
+
+    Uint32 *optimized = NULL;
+    size_t optimizedWordCount;
+    if (spirv != NULL && !SDL_ShaderCross_INTERNAL_OptimizeSPIRV((const Uint32 *)spirv, *size / sizeof(Uint32), info->props, &optimized, &optimizedWordCount)) {
+        SDL_free(spirv);
+        spirv = NULL;
+    }
+    if (optimized != NULL) {
+        SDL_free(spirv);
+        spirv = optimized;
+        *size = optimizedWordCount * sizeof(Uint32);
+    }
+
+    if (spirv != NULL && SDL_GetBooleanProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_STRIP_DEBUG_INFO_BOOLEAN, false)) {
+        size_t wordCount = *size / sizeof(Uint32);
+        if (!SDL_ShaderCross_INTERNAL_StripSPIRV((Uint32 *)spirv, &wordCount)) {
+            SDL_free(spirv);
+            spirv = NULL;
+        } else {
+            *size = wordCount * sizeof(Uint32);
+        }
+    }
+
+    SDL_ShaderCross_INTERNAL_EndTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_HLSL_TO_SPIRV, previousStage);
+    return spirv;
 }
 
 /* DXBC via FXC */
 
+static char *SDL_ShaderCross_INTERNAL_TranspileHLSLFromSPIRV(const SDL_ShaderCross_SPIRV_Info *info, unsigned shadermodel);
+
 /* d3dcompiler Type Definitions */
 typedef void D3D_SHADER_MACRO; /* hack, unused */
 typedef void ID3DInclude;      /* hack, unused */
@@ -723,17 +1729,32 @@ static ID3DBlob *SDL_ShaderCross_INTERNAL_CompileDXBC(
     const char *hlslSource,
     const char *entrypoint,
     const char *shaderProfile,
-    bool enableDebug)
+    bool enableDebug,
+    int optimizationLevel) // -1 for the compiler default
 {
+    static const UINT optimizationFlags[] = {
+        1 << 2,                // D3DCOMPILE_SKIP_OPTIMIZATION
+        0,                     // D3DCOMPILE_OPTIMIZATION_LEVEL1
+        (1 << 14) | (1 << 15), // D3DCOMPILE_OPTIMIZATION_LEVEL2
+        1 << 15                // D3DCOMPILE_OPTIMIZATION_LEVEL3
+    };
     ID3DBlob *blob;
     ID3DBlob *errorBlob;
     HRESULT ret;
+    UINT flags = enableDebug ? 1 : 0; // D3DCOMPILE_DEBUG = 1
+
+    if (optimizationLevel >= 0) {
+        flags |= optimizationFlags[optimizationLevel];
+    }
 
     if (SDL_D3DCompile == NULL) {
         SDL_SetError("%s", "Could not load D3DCompile!");
         return NULL;
     }
 
+    SDL_ShaderCross_TimingStage previousTimingStage = SDL_ShaderCross_INTERNAL_BeginTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_BACKEND);
+    SDL_ShaderCross_MemoryStage previousStage = SDL_ShaderCross_INTERNAL_SetMemoryStage(SDL_SHADERCROSS_MEMORYSTAGE_FXC);
+    SDL_ShaderCross_INTERNAL_TraceSpan("D3DCompile", true);
     ret = SDL_D3DCompile(
         hlslSource,
         SDL_strlen(hlslSource),
@@ -742,10 +1763,13 @@ static ID3DBlob *SDL_ShaderCross_INTERNAL_CompileDXBC(
         NULL,
         entrypoint,
         shaderProfile,
-        enableDebug ? 1 : 0, // D3DCOMPILE_DEBUG = 1
+        flags,
         0,
         &blob,
         &errorBlob);
+    SDL_ShaderCross_INTERNAL_TraceSpan("D3DCompile", false);
+    SDL_ShaderCross_INTERNAL_SetMemoryStage(previousStage);
+    SDL_ShaderCross_INTERNAL_EndTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_BACKEND, previousTimingStage);
 
     if (ret < 0) {
         if (errorBlob != NULL) {
@@ -767,12 +1791,18 @@ void *SDL_ShaderCross_INTERNAL_CompileDXBCFromHLSL(
     size_t *size) // filled in with number of bytes of returned buffer
 {
     char *transpiledSource = NULL;
+    int optimizationLevel;
+
+    if (!SDL_ShaderCross_INTERNAL_GetOptimizationLevel(info->props, &optimizationLevel)) {
+        return NULL;
+    }
 
     if (enableRoundtrip) {
         // Need to roundtrip to SM 5.1
         size_t spirv_size;
-        void *spirv = SDL_ShaderCross_CompileSPIRVFromHLSL(
+        void *spirv = SDL_ShaderCross_INTERNAL_CompileUsingDXC(
             info,
+            true,
             &spirv_size);
 
         if (spirv == NULL) {
@@ -786,8 +1816,10 @@ void *SDL_ShaderCross_INTERNAL_CompileDXBCFromHLSL(
         spirvInfo.shader_stage = info->shader_stage;
         spirvInfo.props = info->props;
 
-        transpiledSource = SDL_ShaderCross_TranspileHLSLFromSPIRV(
-            &spirvInfo);
+        // Transpile for FXC's shader model, so e.g. native 16-bit types become min precision ones
+        transpiledSource = SDL_ShaderCross_INTERNAL_TranspileHLSLFromSPIRV(
+            &spirvInfo,
+            51);
         SDL_free(spirv);
 
         if (transpiledSource == NULL) {
@@ -795,20 +1827,20 @@ void *SDL_ShaderCross_INTERNAL_CompileDXBCFromHLSL(
         }
     }
 
-    const char *shaderProfile;
-    if (info->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_VERTEX) {
-        shaderProfile = "vs_5_1";
-    } else if (info->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT) {
-        shaderProfile = "ps_5_1";
-    } else { // compute
-        shaderProfile = "cs_5_1";
+    // FXC stops at SM 5.1, which is also the first to support the register spaces SDL_GPU binds with
+    char shaderProfile[SHADER_PROFILE_LENGTH];
+    if (!SDL_ShaderCross_INTERNAL_GetShaderProfile(info->shader_stage, 51, shaderProfile)) {
+        SDL_free(transpiledSource);
+        *size = 0;
+        return NULL;
     }
 
     ID3DBlob *blob = SDL_ShaderCross_INTERNAL_CompileDXBC(
         transpiledSource != NULL ? transpiledSource : info->source,
         info->entrypoint,
         shaderProfile,
-        SDL_GetBooleanProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, false));
+        SDL_GetBooleanProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, false),
+        optimizationLevel);
 
     if (blob == NULL) {
         SDL_free(transpiledSource);
@@ -838,9 +1870,14 @@ void *SDL_ShaderCross_CompileDXBCFromHLSL(
         return NULL;
     }
 
+    bool roundtrip;
+    if (!SDL_ShaderCross_INTERNAL_ShouldRoundtripHLSL(info, true, &roundtrip)) {
+        return NULL;
+    }
+
     return SDL_ShaderCross_INTERNAL_CompileDXBCFromHLSL(
         info,
-        true,
+        roundtrip,
         size);
 }
 
@@ -858,764 +1895,1161 @@ static int parse_version_number(const char* str)
     return -1;
 }
 
-typedef struct SPIRVTranspileContext {
-    spvc_context context;
-    const char *translated_source;
-    const char *cleansed_entrypoint;
-} SPIRVTranspileContext;
+/* SPIR-V Stripping */
 
-static void SDL_ShaderCross_INTERNAL_DestroyTranspileContext(
-    SPIRVTranspileContext *context)
+#define SPIRV_HEADER_WORDS 5
+
+static bool SDL_ShaderCross_INTERNAL_SPIRVLiteralEquals(const Uint32 *literal, Uint32 literalWords, const char *str, bool prefix)
 {
-    spvc_context_destroy(context->context);
-    SDL_free(context);
+    size_t maxLength = (size_t)literalWords * sizeof(Uint32);
+    size_t length = SDL_strlen(str);
+    if (length > maxLength || (!prefix && length == maxLength)) {
+        return false; // too short to hold str, or str and its terminator
+    }
+    return SDL_strncmp((const char *)literal, str, prefix ? length : length + 1) == 0;
 }
 
-static SPIRVTranspileContext *SDL_ShaderCross_INTERNAL_TranspileFromSPIRV(
-    spvc_backend backend,
-    unsigned shadermodel, // only used for HLSL
-    SDL_ShaderCross_ShaderStage shaderStage, // only used for MSL
-    const Uint8 *code,
-    size_t codeSize,
-    const char *entrypoint,
-    SDL_PropertiesID props
-) {
-    spvc_result result;
-    spvc_context context = NULL;
-    spvc_parsed_ir ir = NULL;
-    spvc_compiler compiler = NULL;
-    spvc_compiler_options options = NULL;
-    SPIRVTranspileContext *transpileContext = NULL;
-    const char *translated_source;
-    const char *cleansed_entrypoint;
+// Removes debug instructions (names, source and line info) and non-semantic extended instructions from a
+// SPIR-V module in place, shrinking wordCount accordingly. The remaining instructions are left untouched.
+static bool SDL_ShaderCross_INTERNAL_StripSPIRV(Uint32 *words, size_t *wordCount)
+{
+    size_t count = *wordCount;
+    Uint32 bound;
+    Uint8 *nonSemanticSets;
+    size_t out = SPIRV_HEADER_WORDS;
 
-    /* Create the SPIRV-Cross context */
-    result = spvc_context_create(&context);
-    if (result < 0) {
-        SDL_SetError("spvc_context_create failed: %X", result);
-        return NULL;
-    }
-
-    /* Parse the SPIR-V into IR */
-    result = spvc_context_parse_spirv(context, (const SpvId *)code, codeSize / sizeof(SpvId), &ir);
-    if (result < 0) {
-        SPVC_ERROR(spvc_context_parse_spirv);
-        spvc_context_destroy(context);
-        return NULL;
-    }
-
-    /* Create the cross-compiler */
-    result = spvc_context_create_compiler(context, backend, ir, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler);
-    if (result < 0) {
-        SPVC_ERROR(spvc_context_create_compiler);
-        spvc_context_destroy(context);
-        return NULL;
+    if (count < SPIRV_HEADER_WORDS || words[0] != SpvMagicNumber) {
+        return SDL_SetError("%s", "Not a valid SPIR-V module");
     }
 
-    /* Set up the cross-compiler options */
-    result = spvc_compiler_create_compiler_options(compiler, &options);
-    if (result < 0) {
-        SPVC_ERROR(spvc_compiler_create_compiler_options);
-        spvc_context_destroy(context);
-        return NULL;
+    bound = words[3];
+    nonSemanticSets = (Uint8 *)SDL_calloc(bound > 0 ? bound : 1, sizeof(Uint8));
+    if (nonSemanticSets == NULL) {
+        return false;
     }
 
-    if (backend == SPVC_BACKEND_HLSL) {
-        spvc_compiler_options_set_uint(options, SPVC_COMPILER_OPTION_HLSL_SHADER_MODEL, shadermodel);
-        spvc_compiler_options_set_uint(options, SPVC_COMPILER_OPTION_HLSL_NONWRITABLE_UAV_TEXTURE_AS_SRV, 1);
-        spvc_compiler_options_set_uint(options, SPVC_COMPILER_OPTION_HLSL_FLATTEN_MATRIX_VERTEX_INPUT_SEMANTICS, 1);
-        spvc_compiler_options_set_bool(options, SPVC_COMPILER_OPTION_HLSL_USE_ENTRY_POINT_NAME, !SDL_GetBooleanProperty(props, SDL_SHADERCROSS_PROP_SPIRV_PSSL_COMPATIBILITY_BOOLEAN, false));
-        spvc_compiler_options_set_bool(options, SPVC_COMPILER_OPTION_HLSL_POINT_SIZE_COMPAT, true);
-    }
+    // First pass: validate instruction lengths and find the NonSemantic.* extended instruction sets
+    for (size_t i = SPIRV_HEADER_WORDS; i < count;) {
+        Uint32 instructionWords = words[i] >> 16;
+        Uint32 opcode = words[i] & 0xFFFF;
 
-    SpvExecutionModel executionModel;
-    if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_VERTEX) {
-        executionModel = SpvExecutionModelVertex;
-    } else if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT) {
-        executionModel = SpvExecutionModelFragment;
-    } else { // compute
-        if (backend == SPVC_BACKEND_HLSL) {
-            executionModel = SpvExecutionModelKernel;
-        } else {
-            executionModel = SpvExecutionModelGLCompute;
+        if (instructionWords == 0 || instructionWords > count - i) {
+            SDL_free(nonSemanticSets);
+            return SDL_SetError("Malformed SPIR-V instruction at word %u", (unsigned int)i);
         }
-    }
 
-    if (backend == SPVC_BACKEND_MSL) {
-        const char *_mslVersion = SDL_GetStringProperty(props, SDL_SHADERCROSS_PROP_SPIRV_MSL_VERSION_STRING, "1.2.0");
-        int mslVersion = parse_version_number(_mslVersion);
-        if (mslVersion == - 1) {
-            SDL_SetError("failed to parse MSL version string \"%s\"", _mslVersion);
-            spvc_context_destroy(context);
-            return NULL;
+        if (opcode == SpvOpExtInstImport && instructionWords > 2 && words[i + 1] < bound) {
+            if (SDL_ShaderCross_INTERNAL_SPIRVLiteralEquals(&words[i + 2], instructionWords - 2, "NonSemantic.", true)) {
+                nonSemanticSets[words[i + 1]] = 1;
+            }
         }
-        spvc_compiler_options_set_uint(options, SPVC_COMPILER_OPTION_MSL_VERSION, mslVersion);
-    }
-
-    // MSL doesn't have descriptor sets, so we have to set up index remapping
-    if (backend == SPVC_BACKEND_MSL && shaderStage != SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
-        spvc_resources resources;
-        spvc_reflected_resource *reflected_resources;
-        size_t num_texture_samplers;
-        size_t num_storage_textures;
-        size_t num_storage_buffers;
-        size_t num_uniform_buffers;
-        size_t num_separate_samplers = 0;
-        size_t num_separate_images = 0;
 
-        spvc_msl_resource_binding_2 bufferBindings[32];
-        SDL_zeroa(bufferBindings);
-        Uint32 numBufferBindings = 0;
-
-        spvc_msl_resource_binding_2 textureBindings[32];
-        SDL_zeroa(textureBindings);
-        Uint32 numTextureBindings = 0;
-
-        result = spvc_compiler_create_shader_resources(compiler, &resources);
-        if (result < 0) {
-            SPVC_ERROR(spvc_compiler_create_shader_resources);
-            spvc_context_destroy(context);
-            return NULL;
-        }
+        i += instructionWords;
+    }
 
-        // Combined texture-samplers
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_SAMPLED_IMAGE,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_texture_samplers);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
+    // Second pass: compact the instructions we keep
+    for (size_t i = SPIRV_HEADER_WORDS; i < count;) {
+        Uint32 instructionWords = words[i] >> 16;
+        bool strip;
+
+        switch (words[i] & 0xFFFF) {
+        case SpvOpSourceContinued:
+        case SpvOpSource:
+        case SpvOpSourceExtension:
+        case SpvOpName:
+        case SpvOpMemberName:
+        case SpvOpString:
+        case SpvOpLine:
+        case SpvOpNoLine:
+        case SpvOpModuleProcessed:
+            strip = true;
+            break;
+        case SpvOpExtInstImport:
+            strip = instructionWords > 1 && words[i + 1] < bound && nonSemanticSets[words[i + 1]];
+            break;
+        case SpvOpExtInst:
+            strip = instructionWords > 3 && words[i + 3] < bound && nonSemanticSets[words[i + 3]];
+            break;
+        case SpvOpExtension:
+            strip = SDL_ShaderCross_INTERNAL_SPIRVLiteralEquals(&words[i + 1], instructionWords - 1, "SPV_KHR_non_semantic_info", false);
+            break;
+        default:
+            strip = false;
+            break;
         }
 
-        // If source is HLSL, we might have separate images and samplers
-        if (num_texture_samplers == 0) {
-            result = spvc_resources_get_resource_list_for_type(
-                resources,
-                SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS,
-                (const spvc_reflected_resource **)&reflected_resources,
-                &num_separate_samplers);
-            if (result < 0) {
-                SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-                spvc_context_destroy(context);
-                return NULL;
+        if (!strip) {
+            if (out != i) {
+                SDL_memmove(&words[out], &words[i], instructionWords * sizeof(Uint32));
             }
-            num_texture_samplers = num_separate_samplers;
+            out += instructionWords;
         }
 
-        for (size_t i = 0; i < num_texture_samplers; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
-                SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
-
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (!(descriptor_set_index == 0 || descriptor_set_index == 2)) {
-                SDL_SetError("%s", "Descriptor set index for graphics texture-sampler must be 0 or 2!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
-
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+        i += instructionWords;
+    }
 
-            textureBindings[numTextureBindings].stage = executionModel;
-            textureBindings[numTextureBindings].desc_set = descriptor_set_index;
-            textureBindings[numTextureBindings].binding = binding_index;
-            textureBindings[numTextureBindings].count = 1;
-            // assign binding index after we have collected all resources
+    SDL_free(nonSemanticSets);
+    *wordCount = out;
+    return true;
+}
 
-            numTextureBindings += 1;
-        }
+void *SDL_ShaderCross_StripSPIRV(
+    const Uint8 *bytecode,
+    size_t bytecodeSize,
+    size_t *size)
+{
+    if (bytecode == NULL) {
+        SDL_InvalidParamError("bytecode");
+        return NULL;
+    }
+    if (size == NULL) {
+        SDL_InvalidParamError("size");
+        return NULL;
+    }
+    if (bytecodeSize % sizeof(Uint32) != 0) {
+        SDL_SetError("%s", "SPIR-V bytecode size must be a multiple of 4");
+        return NULL;
+    }
 
-        // Storage textures
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_STORAGE_IMAGE,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_storage_textures);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
-        }
+    Uint32 *words = (Uint32 *)SDL_malloc(bytecodeSize > 0 ? bytecodeSize : 1);
+    if (words == NULL) {
+        return NULL;
+    }
+    SDL_memcpy(words, bytecode, bytecodeSize);
 
-        for (size_t i = 0; i < num_storage_textures; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
-                SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+    size_t wordCount = bytecodeSize / sizeof(Uint32);
+    if (!SDL_ShaderCross_INTERNAL_StripSPIRV(words, &wordCount)) {
+        SDL_free(words);
+        return NULL;
+    }
 
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (!(descriptor_set_index == 0 || descriptor_set_index == 2)) {
-                SDL_SetError("%s", "Descriptor set index for graphics storage texture must be 0 or 2!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+    *size = wordCount * sizeof(Uint32);
+    return words;
+}
 
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+/* SPIR-V Optimization */
 
-            textureBindings[numTextureBindings].stage = executionModel;
-            textureBindings[numTextureBindings].desc_set = descriptor_set_index;
-            textureBindings[numTextureBindings].binding = binding_index;
-            textureBindings[numTextureBindings].count = 1;
-            // assign binding index after we have collected all resources
+#ifdef SDL_SHADERCROSS_SPIRVTOOLS
+#include <spirv-tools/libspirv.h>
 
-            numTextureBindings += 1;
-        }
+static void SDL_ShaderCross_INTERNAL_SPIRVToolsMessage(
+    spv_message_level_t level,
+    const char *source,
+    const spv_position_t *position,
+    const char *message)
+{
+    (void) source;
+    (void) position;
 
-        // If source is HLSL, storage images might be marked as separate images
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_SEPARATE_IMAGE,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_separate_images);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
-        }
+    if (level == SPV_MSG_FATAL || level == SPV_MSG_INTERNAL_ERROR || level == SPV_MSG_ERROR) {
+        SDL_SetError("SPIR-V optimization failed: %s", message);
+    } else if (level == SPV_MSG_WARNING) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "SPIR-V optimized with warnings: %s", message);
+    }
+}
 
-        // We only want to iterate the images that don't have an associated sampler
-        for (size_t i = num_separate_samplers; i < num_separate_images; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
-                SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+static spv_target_env SDL_ShaderCross_INTERNAL_GetSPIRVTargetEnv(Uint32 version)
+{
+    switch (version) {
+    case 0x00010000: return SPV_ENV_UNIVERSAL_1_0;
+    case 0x00010100: return SPV_ENV_UNIVERSAL_1_1;
+    case 0x00010200: return SPV_ENV_UNIVERSAL_1_2;
+    case 0x00010300: return SPV_ENV_UNIVERSAL_1_3;
+    case 0x00010400: return SPV_ENV_UNIVERSAL_1_4;
+    case 0x00010500: return SPV_ENV_UNIVERSAL_1_5;
+    default: return SPV_ENV_UNIVERSAL_1_6;
+    }
+}
+#endif /* SDL_SHADERCROSS_SPIRVTOOLS */
+
+/* Runs the SPIRV-Tools recipe selected by SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER.
+ * Returns true with *optimized set to NULL when no optimization was requested.
+ */
+static bool SDL_ShaderCross_INTERNAL_OptimizeSPIRV(
+    const Uint32 *words,
+    size_t wordCount,
+    SDL_PropertiesID props,
+    Uint32 **optimized,
+    size_t *optimizedWordCount)
+{
+    SDL_ShaderCross_SPIRVOptimization optimization = (SDL_ShaderCross_SPIRVOptimization)SDL_GetNumberProperty(
+        props,
+        SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER,
+        SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE);
 
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (!(descriptor_set_index == 0 || descriptor_set_index == 2)) {
-                SDL_SetError("%s", "Descriptor set index for graphics storage texture must be 0 or 2!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+    *optimized = NULL;
+    *optimizedWordCount = 0;
 
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+    if (optimization == SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE) {
+        return true;
+    }
+    if (optimization != SDL_SHADERCROSS_SPIRVOPTIMIZATION_PERFORMANCE &&
+        optimization != SDL_SHADERCROSS_SPIRVOPTIMIZATION_SIZE) {
+        SDL_SetError("Unknown SPIR-V optimization %d", (int)optimization);
+        return false;
+    }
+    if (wordCount < SPIRV_HEADER_WORDS || words[0] != SpvMagicNumber) {
+        SDL_SetError("%s", "Invalid SPIR-V header");
+        return false;
+    }
 
-            textureBindings[numTextureBindings].stage = executionModel;
-            textureBindings[numTextureBindings].desc_set = descriptor_set_index;
-            textureBindings[numTextureBindings].binding = binding_index;
-            textureBindings[numTextureBindings].count = 1;
-            // assign binding index after we have collected all resources
+#ifdef SDL_SHADERCROSS_SPIRVTOOLS
+    spv_optimizer_t *optimizer = spvOptimizerCreate(SDL_ShaderCross_INTERNAL_GetSPIRVTargetEnv(words[1]));
+    if (optimizer == NULL) {
+        SDL_SetError("%s", "spvOptimizerCreate failed");
+        return false;
+    }
+    spvOptimizerSetMessageConsumer(optimizer, SDL_ShaderCross_INTERNAL_SPIRVToolsMessage);
 
-            numTextureBindings += 1;
-        }
+    if (optimization == SDL_SHADERCROSS_SPIRVOPTIMIZATION_SIZE) {
+        spvOptimizerRegisterSizePasses(optimizer);
+    } else {
+        spvOptimizerRegisterPerformancePasses(optimizer);
+    }
 
-        // Uniform buffers
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_UNIFORM_BUFFER,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_uniform_buffers);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
+    spv_optimizer_options options = spvOptimizerOptionsCreate();
+    // The input was already validated by whoever produced it
+    spvOptimizerOptionsSetRunValidator(options, false);
+    // Resource counts and slots are reflected from the module, so they must survive dead code elimination
+    spvOptimizerOptionsSetPreserveBindings(options, !SDL_GetBooleanProperty(props, SDL_SHADERCROSS_PROP_SHADER_CULL_UNUSED_BINDINGS_BOOLEAN, false));
+    spvOptimizerOptionsSetPreserveSpecConstants(options, true);
+
+    spv_binary binary = NULL;
+    SDL_ClearError();
+    spv_result_t result = spvOptimizerRun(optimizer, words, wordCount, &binary, options);
+    spvOptimizerOptionsDestroy(options);
+    spvOptimizerDestroy(optimizer);
+
+    if (result != SPV_SUCCESS || binary == NULL) {
+        if (*SDL_GetError() == '\0') {
+            SDL_SetError("spvOptimizerRun failed: %d", (int)result);
         }
+        spvBinaryDestroy(binary);
+        return false;
+    }
 
-        for (size_t i = 0; i < num_uniform_buffers; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
-                SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
-
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (!(descriptor_set_index == 1 || descriptor_set_index == 3)) {
-                SDL_SetError("%s", "Descriptor set index for graphics uniform buffer must be 1 or 3!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
-
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+    *optimized = (Uint32 *)SDL_malloc(binary->wordCount * sizeof(Uint32));
+    if (*optimized == NULL) {
+        spvBinaryDestroy(binary);
+        return false;
+    }
+    SDL_memcpy(*optimized, binary->code, binary->wordCount * sizeof(Uint32));
+    *optimizedWordCount = binary->wordCount;
+    spvBinaryDestroy(binary);
+    return true;
+#else
+    SDL_SetError("%s", "Shadercross was not built with SPIRV-Tools support, cannot optimize SPIR-V!");
+    return false;
+#endif /* SDL_SHADERCROSS_SPIRVTOOLS */
+}
 
-            bufferBindings[numBufferBindings].stage = executionModel;
-            bufferBindings[numBufferBindings].desc_set = descriptor_set_index;
-            bufferBindings[numBufferBindings].binding = binding_index;
-            bufferBindings[numBufferBindings].count = 1;
-            // assign binding index after we have collected all resources
+/* SPIR-V Specialization */
 
-            numBufferBindings += 1;
+// Returns the index of the override for result id, or -1
+static int SDL_ShaderCross_INTERNAL_FindSpecializationOverride(const Uint32 *targetIds, size_t numConstants, Uint32 id)
+{
+    for (size_t i = 0; i < numConstants; i += 1) {
+        if (targetIds[i] == id) {
+            return (int)i;
         }
+    }
+    return -1;
+}
 
-        // Storage buffers
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_STORAGE_BUFFER,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_storage_buffers);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
+// Returns true when an OpName in [SPIRV_HEADER_WORDS, end) gives id the name, the instructions must be validated already
+static bool SDL_ShaderCross_INTERNAL_SPIRVHasName(const Uint32 *words, size_t end, Uint32 id, const char *name)
+{
+    for (size_t i = SPIRV_HEADER_WORDS; i < end;) {
+        Uint32 instructionWords = words[i] >> 16;
+        if ((words[i] & 0xFFFF) == SpvOpName && instructionWords > 2 && words[i + 1] == id &&
+            SDL_ShaderCross_INTERNAL_SPIRVLiteralEquals(&words[i + 2], instructionWords - 2, name, false)) {
+            return true;
         }
+        i += instructionWords;
+    }
+    return false;
+}
 
-        for (size_t i = 0; i < num_storage_buffers; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
-                SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+/* Freezes the specialization constants named in SDL_SHADERCROSS_PROP_SPIRV_SPECIALIZATION_CONSTANTS_POINTER
+ * into regular constants, so that backends see literal values they can fold. Fails when an override
+ * doesn't match any constant. Returns true with *specialized set to NULL when nothing was requested.
+ */
+static bool SDL_ShaderCross_INTERNAL_SpecializeSPIRV(
+    const Uint32 *words,
+    size_t wordCount,
+    SDL_PropertiesID props,
+    Uint32 **specialized,
+    size_t *specializedWordCount)
+{
+    const SDL_ShaderCross_SpecializationConstant *constants = (const SDL_ShaderCross_SpecializationConstant *)SDL_GetPointerProperty(
+        props,
+        SDL_SHADERCROSS_PROP_SPIRV_SPECIALIZATION_CONSTANTS_POINTER,
+        NULL);
+    Sint64 numConstants = SDL_GetNumberProperty(props, SDL_SHADERCROSS_PROP_SPIRV_NUM_SPECIALIZATION_CONSTANTS_NUMBER, 0);
+    size_t out = SPIRV_HEADER_WORDS;
 
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (!(descriptor_set_index == 0 || descriptor_set_index == 2)) {
-                SDL_SetError("%s", "Descriptor set index for graphics storage buffer must be 0 or 2!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+    *specialized = NULL;
+    *specializedWordCount = 0;
 
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+    if (constants == NULL || numConstants <= 0) {
+        return true;
+    }
+    if (wordCount < SPIRV_HEADER_WORDS || words[0] != SpvMagicNumber) {
+        return SDL_SetError("%s", "Not a valid SPIR-V module");
+    }
 
-            bufferBindings[numBufferBindings].stage = executionModel;
-            bufferBindings[numBufferBindings].desc_set = descriptor_set_index;
-            bufferBindings[numBufferBindings].binding = binding_index;
-            bufferBindings[numBufferBindings].count = 1;
-            // assign binding index after we have collected all resources
+    // The result id each override applies to, 0 (never a valid id) when unmatched
+    Uint32 *targetIds = (Uint32 *)SDL_calloc((size_t)numConstants, sizeof(Uint32));
+    if (targetIds == NULL) {
+        return false;
+    }
 
-            numBufferBindings += 1;
-        }
+    // First pass: validate instruction lengths and resolve names and SpecIds to result ids
+    for (size_t i = SPIRV_HEADER_WORDS; i < wordCount;) {
+        Uint32 instructionWords = words[i] >> 16;
+        Uint32 opcode = words[i] & 0xFFFF;
 
-        // Textures come first so we can just use the binding slot
-        for (Uint32 i = 0; i < numTextureBindings; i += 1) {
-            textureBindings[i].msl_texture = textureBindings[i].binding;
-            textureBindings[i].msl_sampler = textureBindings[i].binding;
-            result = spvc_compiler_msl_add_resource_binding_2(compiler, &textureBindings[i]);
+        if (instructionWords == 0 || instructionWords > wordCount - i) {
+            SDL_free(targetIds);
+            return SDL_SetError("Malformed SPIR-V instruction at word %u", (unsigned int)i);
         }
 
-        if (result < 0) {
-            SPVC_ERROR(spvc_compiler_msl_add_resource_binding_2);
-            spvc_context_destroy(context);
-            return NULL;
+        // Other ids may share the name, so names are only matched on spec constants. Names precede them in a module.
+        bool specConstant = (opcode == SpvOpSpecConstantTrue || opcode == SpvOpSpecConstantFalse || opcode == SpvOpSpecConstant) && instructionWords > 2;
+        for (Sint64 c = 0; c < numConstants; c += 1) {
+            if (targetIds[c] != 0) {
+                continue;
+            }
+            if (constants[c].name != NULL) {
+                if (specConstant && SDL_ShaderCross_INTERNAL_SPIRVHasName(words, i, words[i + 2], constants[c].name)) {
+                    targetIds[c] = words[i + 2];
+                }
+            } else if (opcode == SpvOpDecorate && instructionWords > 3 && words[i + 2] == SpvDecorationSpecId && words[i + 3] == constants[c].constant_id) {
+                targetIds[c] = words[i + 1];
+            }
         }
 
-        // Calculate number of uniform buffers
-        Uint32 uniformBufferCount = 0;
+        i += instructionWords;
+    }
 
-        for (Uint32 i = 0; i < numBufferBindings; i += 1) {
-            if (bufferBindings[i].desc_set == 1 || bufferBindings[i].desc_set == 3) {
-                uniformBufferCount += 1;
+    for (Sint64 c = 0; c < numConstants; c += 1) {
+        if (targetIds[c] == 0) {
+            if (constants[c].name != NULL) {
+                SDL_SetError("No specialization constant named \"%s\"", constants[c].name);
+            } else {
+                SDL_SetError("No specialization constant with constant_id %u", (unsigned int)constants[c].constant_id);
             }
+            SDL_free(targetIds);
+            return false;
         }
+    }
 
-        // Calculate resource indices
-        for (Uint32 i = 0; i < numBufferBindings; i += 1) {
-            if (bufferBindings[i].desc_set == 1 || bufferBindings[i].desc_set == 3) {
-                // Uniform buffers are alone in the descriptor set
-                bufferBindings[i].msl_buffer = bufferBindings[i].binding;
-            } else {
-                // Subtract by the texture count because the textures precede the storage buffers in the descriptor set
-                bufferBindings[i].msl_buffer = uniformBufferCount + (bufferBindings[i].binding - numTextureBindings);
+    *specialized = (Uint32 *)SDL_malloc(wordCount * sizeof(Uint32));
+    if (*specialized == NULL) {
+        SDL_free(targetIds);
+        return false;
+    }
+    SDL_memcpy(*specialized, words, SPIRV_HEADER_WORDS * sizeof(Uint32));
+
+    // Second pass: turn the matched spec constants into constants and drop their SpecId decorations
+    for (size_t i = SPIRV_HEADER_WORDS; i < wordCount;) {
+        Uint32 instructionWords = words[i] >> 16;
+        Uint32 opcode = words[i] & 0xFFFF;
+        int override = -1;
+
+        if (opcode == SpvOpDecorate && instructionWords > 2 && words[i + 2] == SpvDecorationSpecId) {
+            if (SDL_ShaderCross_INTERNAL_FindSpecializationOverride(targetIds, (size_t)numConstants, words[i + 1]) >= 0) {
+                i += instructionWords;
+                continue;
             }
+        } else if ((opcode == SpvOpSpecConstantTrue || opcode == SpvOpSpecConstantFalse || opcode == SpvOpSpecConstant) && instructionWords > 2) {
+            override = SDL_ShaderCross_INTERNAL_FindSpecializationOverride(targetIds, (size_t)numConstants, words[i + 2]);
+        }
 
-            result = spvc_compiler_msl_add_resource_binding_2(compiler, &bufferBindings[i]);
-
-            if (result < 0) {
-                SPVC_ERROR(spvc_compiler_msl_add_resource_binding_2);
-                spvc_context_destroy(context);
-                return NULL;
+        SDL_memcpy(&(*specialized)[out], &words[i], instructionWords * sizeof(Uint32));
+        if (override >= 0) {
+            Uint64 value = constants[override].value;
+            if (opcode == SpvOpSpecConstant) {
+                // One literal word for types up to 32 bits, two for 64-bit types
+                (*specialized)[out] = (instructionWords << 16) | SpvOpConstant;
+                if (instructionWords > 3) {
+                    (*specialized)[out + 3] = (Uint32)value;
+                }
+                if (instructionWords > 4) {
+                    (*specialized)[out + 4] = (Uint32)(value >> 32);
+                }
+            } else {
+                (*specialized)[out] = (instructionWords << 16) | (value != 0 ? SpvOpConstantTrue : SpvOpConstantFalse);
             }
         }
+        out += instructionWords;
+
+        i += instructionWords;
     }
 
-    if (backend == SPVC_BACKEND_MSL && shaderStage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
-        spvc_resources resources;
-        spvc_reflected_resource *reflected_resources;
-        size_t num_texture_samplers;
-        size_t num_storage_textures; // total storage textures
-        size_t num_storage_buffers; // total storage buffers
-        size_t num_uniform_buffers;
-        size_t num_separate_samplers = 0;
-        size_t num_separate_images = 0;
+    SDL_free(targetIds);
+    *specializedWordCount = out;
+    return true;
+}
 
-        spvc_msl_resource_binding_2 bufferBindings[32];
-        Uint32 numBufferBindings = 0;
+// Applies specialization constant overrides and then the optimizer, as requested by props.
+// Returns true with *processed set to NULL when the module is to be used as is.
+static bool SDL_ShaderCross_INTERNAL_PreprocessSPIRV(
+    const Uint8 *code,
+    size_t codeSize,
+    SDL_PropertiesID props,
+    Uint32 **processed,
+    size_t *processedSize)
+{
+    *processed = NULL;
+    *processedSize = 0;
 
-        spvc_msl_resource_binding_2 textureBindings[32];
-        Uint32 numTextureBindings = 0;
+    // Specialize first, so the optimizer can fold the new constants too
+    Uint32 *specialized;
+    size_t specializedWordCount;
+    if (!SDL_ShaderCross_INTERNAL_SpecializeSPIRV((const Uint32 *)code, codeSize / sizeof(Uint32), props, &specialized, &specializedWordCount)) {
+        return false;
+    }
+    if (specialized != NULL) {
+        code = (const Uint8 *)specialized;
+        codeSize = specializedWordCount * sizeof(Uint32);
+    }
 
-        result = spvc_compiler_create_shader_resources(compiler, &resources);
-        if (result < 0) {
-            SPVC_ERROR(spvc_compiler_create_shader_resources);
-            spvc_context_destroy(context);
-            return NULL;
-        }
+    Uint32 *optimized;
+    size_t optimizedWordCount;
+    if (!SDL_ShaderCross_INTERNAL_OptimizeSPIRV((const Uint32 *)code, codeSize / sizeof(Uint32), props, &optimized, &optimizedWordCount)) {
+        SDL_free(specialized);
+        return false;
+    }
 
-        // Combined texture-samplers
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_SAMPLED_IMAGE,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_texture_samplers);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
-        }
+    if (optimized != NULL) {
+        SDL_free(specialized);
+        *processed = optimized;
+        *processedSize = optimizedWordCount * sizeof(Uint32);
+    } else if (specialized != NULL) {
+        *processed = specialized;
+        *processedSize = specializedWordCount * sizeof(Uint32);
+    }
+    return true;
+}
 
-        // If source is HLSL, we might have separate images and samplers
-        if (num_texture_samplers == 0) {
-            result = spvc_resources_get_resource_list_for_type(
-                resources,
-                SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS,
-                (const spvc_reflected_resource **)&reflected_resources,
-                &num_separate_samplers);
-            if (result < 0) {
-                SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-                spvc_context_destroy(context);
-                return NULL;
-            }
-            num_texture_samplers = num_separate_samplers;
-        }
+typedef struct SPIRVTranspileContext {
+    spvc_context context;
+    const char *translated_source;
+    const char *cleansed_entrypoint;
+} SPIRVTranspileContext;
 
-        for (size_t i = 0; i < num_texture_samplers; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
-                SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+static void SDL_ShaderCross_INTERNAL_DestroyTranspileContext(
+    SPIRVTranspileContext *context)
+{
+    spvc_context_destroy(context->context);
+    SDL_free(context);
+}
 
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (descriptor_set_index != 0) {
-                SDL_SetError("%s", "Descriptor set index for compute texture-sampler must be 0!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+typedef enum MSLResourceKind {
+    MSL_RESOURCE_KIND_SAMPLER,
+    MSL_RESOURCE_KIND_STORAGE_TEXTURE,
+    MSL_RESOURCE_KIND_UNIFORM_BUFFER,
+    MSL_RESOURCE_KIND_STORAGE_BUFFER
+} MSLResourceKind;
+
+typedef struct MSLResourceList {
+    const spvc_reflected_resource *resources;
+    size_t first;
+    size_t count;
+    MSLResourceKind kind;
+} MSLResourceList;
+
+// Valid descriptor sets per resource kind, as a bitmask, for graphics and compute shaders
+static const struct {
+    Uint32 graphicsSets;
+    Uint32 computeSets;
+    const char *graphicsError;
+    const char *computeError;
+} mslResourceKindInfo[] = {
+    { (1 << 0) | (1 << 2), (1 << 0),
+      "Descriptor set index for graphics texture-sampler must be 0 or 2!",
+      "Descriptor set index for compute texture-sampler must be 0!" },
+    { (1 << 0) | (1 << 2), (1 << 0) | (1 << 1),
+      "Descriptor set index for graphics storage texture must be 0 or 2!",
+      "Descriptor set index for compute storage texture must be 0 or 1!" },
+    { (1 << 1) | (1 << 3), (1 << 2),
+      "Descriptor set index for graphics uniform buffer must be 1 or 3!",
+      "Descriptor set index for compute uniform buffer must be 2!" },
+    { (1 << 0) | (1 << 2), (1 << 0) | (1 << 1),
+      "Descriptor set index for graphics storage buffer must be 0 or 2!",
+      "Descriptor set index for compute storage buffer must be 0 or 1!" },
+};
 
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+static bool SDL_ShaderCross_INTERNAL_GetMSLResourceList(
+    spvc_context context,
+    spvc_resources resources,
+    spvc_resource_type type,
+    MSLResourceKind kind,
+    MSLResourceList *list)
+{
+    spvc_result result = spvc_resources_get_resource_list_for_type(
+        resources,
+        type,
+        &list->resources,
+        &list->count);
+    if (result < 0) {
+        SPVC_ERROR(spvc_resources_get_resource_list_for_type);
+        return false;
+    }
+    list->first = 0;
+    list->kind = kind;
+    return true;
+}
 
-            textureBindings[numTextureBindings].stage = executionModel;
-            textureBindings[numTextureBindings].desc_set = descriptor_set_index;
-            textureBindings[numTextureBindings].binding = binding_index;
-            textureBindings[numTextureBindings].count = 1;
-            // assign binding index after we have collected all resources
+// Every binding of a shader, classified by kind. The buffer bindings share the texture bindings' allocation.
+typedef struct MSLResourceBindings
+{
+    spvc_msl_resource_binding_2 *textureBindings;
+    spvc_msl_resource_binding_2 *bufferBindings;
+    MSLResourceKind *textureKinds;
+    Uint32 numTextureBindings;
+    Uint32 numBufferBindings;
+    Uint32 textureCountPerSet[4];
+    Uint32 bufferCountPerSet[4];
+} MSLResourceBindings;
+
+// Every resource list is fetched once, and the binding tables are sized from it.
+static bool SDL_ShaderCross_INTERNAL_CollectMSLResourceBindings(
+    spvc_context context,
+    spvc_compiler compiler,
+    spvc_resources resources,
+    SpvExecutionModel executionModel,
+    bool compute,
+    MSLResourceBindings *bindings)
+{
+    MSLResourceList lists[5];
+    size_t numLists = 0;
+    size_t maxTextureBindings = 0;
+    size_t maxBufferBindings = 0;
 
-            numTextureBindings += 1;
-        }
+    SDL_zerop(bindings);
 
-        // Readonly storage textures
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_STORAGE_IMAGE,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_storage_textures);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
+    // Combined texture-samplers
+    if (!SDL_ShaderCross_INTERNAL_GetMSLResourceList(context, resources, SPVC_RESOURCE_TYPE_SAMPLED_IMAGE, MSL_RESOURCE_KIND_SAMPLER, &lists[numLists])) {
+        return false;
+    }
+    size_t numSeparateSamplers = 0;
+    if (lists[numLists].count == 0) {
+        // If source is HLSL, we might have separate images and samplers
+        if (!SDL_ShaderCross_INTERNAL_GetMSLResourceList(context, resources, SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS, MSL_RESOURCE_KIND_SAMPLER, &lists[numLists])) {
+            return false;
         }
+        numSeparateSamplers = lists[numLists].count;
+    }
+    maxTextureBindings += lists[numLists++].count;
 
-        for (size_t i = 0; i < num_storage_textures; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
-                SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+    // Storage textures
+    if (!SDL_ShaderCross_INTERNAL_GetMSLResourceList(context, resources, SPVC_RESOURCE_TYPE_STORAGE_IMAGE, MSL_RESOURCE_KIND_STORAGE_TEXTURE, &lists[numLists])) {
+        return false;
+    }
+    maxTextureBindings += lists[numLists++].count;
 
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (!(descriptor_set_index == 0 || descriptor_set_index == 1)) {
-                SDL_SetError("%s", "Descriptor set index for compute storage texture must be 0 or 1!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+    // If source is HLSL, storage images might be marked as separate images.
+    // We only want the images that don't have an associated sampler.
+    if (!SDL_ShaderCross_INTERNAL_GetMSLResourceList(context, resources, SPVC_RESOURCE_TYPE_SEPARATE_IMAGE, MSL_RESOURCE_KIND_STORAGE_TEXTURE, &lists[numLists])) {
+        return false;
+    }
+    lists[numLists].first = SDL_min(numSeparateSamplers, lists[numLists].count);
+    maxTextureBindings += lists[numLists].count - lists[numLists].first;
+    numLists += 1;
 
-            // Skip readwrite textures
-            if (descriptor_set_index != 0) { continue; }
+    // Uniform buffers
+    if (!SDL_ShaderCross_INTERNAL_GetMSLResourceList(context, resources, SPVC_RESOURCE_TYPE_UNIFORM_BUFFER, MSL_RESOURCE_KIND_UNIFORM_BUFFER, &lists[numLists])) {
+        return false;
+    }
+    maxBufferBindings += lists[numLists++].count;
 
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+    // Storage buffers
+    if (!SDL_ShaderCross_INTERNAL_GetMSLResourceList(context, resources, SPVC_RESOURCE_TYPE_STORAGE_BUFFER, MSL_RESOURCE_KIND_STORAGE_BUFFER, &lists[numLists])) {
+        return false;
+    }
+    maxBufferBindings += lists[numLists++].count;
 
-            textureBindings[numTextureBindings].stage = executionModel;
-            textureBindings[numTextureBindings].desc_set = descriptor_set_index;
-            textureBindings[numTextureBindings].binding = binding_index;
-            textureBindings[numTextureBindings].count = 1;
-            // assign binding index after we have collected all resources
+    if (maxTextureBindings + maxBufferBindings == 0) {
+        return true;
+    }
 
-            numTextureBindings += 1;
-        }
+    bindings->textureBindings = SDL_calloc(
+        maxTextureBindings + maxBufferBindings,
+        sizeof(spvc_msl_resource_binding_2) + sizeof(MSLResourceKind));
+    if (bindings->textureBindings == NULL) {
+        return false;
+    }
+    bindings->bufferBindings = bindings->textureBindings + maxTextureBindings;
+    bindings->textureKinds = (MSLResourceKind *)(bindings->bufferBindings + maxBufferBindings);
 
-        // If source is HLSL, storage images might be marked as separate images
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_SEPARATE_IMAGE,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_separate_images);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
-        }
+    // Classify every resource in a single pass
+    for (size_t l = 0; l < numLists; l += 1) {
+        const MSLResourceList *list = &lists[l];
+        Uint32 validSets = compute ? mslResourceKindInfo[list->kind].computeSets : mslResourceKindInfo[list->kind].graphicsSets;
 
-        // We only want to iterate the images that don't have an associated sampler
-        for (size_t i = num_separate_samplers; i < num_separate_images; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
+        for (size_t i = list->first; i < list->count; i += 1) {
+            spvc_variable_id id = list->resources[i].id;
+
+            if (!spvc_compiler_has_decoration(compiler, id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, id, SpvDecorationBinding)) {
                 SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
+                SDL_free(bindings->textureBindings);
+                bindings->textureBindings = NULL;
+                return false;
             }
 
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (!(descriptor_set_index == 0 || descriptor_set_index == 1)) {
-                SDL_SetError("%s", "Descriptor set index for compute storage texture must be 0 or 1!");
-                spvc_context_destroy(context);
-                return NULL;
+            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, id, SpvDecorationDescriptorSet);
+            if (descriptor_set_index >= 32 || !(validSets & (1u << descriptor_set_index))) {
+                SDL_SetError("%s", compute ? mslResourceKindInfo[list->kind].computeError : mslResourceKindInfo[list->kind].graphicsError);
+                SDL_free(bindings->textureBindings);
+                bindings->textureBindings = NULL;
+                return false;
             }
 
-            // Skip readwrite textures
-            if (descriptor_set_index != 0) { continue; }
-
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+            spvc_msl_resource_binding_2 *binding;
+            if (list->kind == MSL_RESOURCE_KIND_SAMPLER || list->kind == MSL_RESOURCE_KIND_STORAGE_TEXTURE) {
+                bindings->textureKinds[bindings->numTextureBindings] = list->kind;
+                binding = &bindings->textureBindings[bindings->numTextureBindings++];
+                bindings->textureCountPerSet[descriptor_set_index] += 1;
+            } else {
+                binding = &bindings->bufferBindings[bindings->numBufferBindings++];
+                bindings->bufferCountPerSet[descriptor_set_index] += 1;
+            }
 
-            textureBindings[numTextureBindings].stage = executionModel;
-            textureBindings[numTextureBindings].desc_set = descriptor_set_index;
-            textureBindings[numTextureBindings].binding = binding_index;
-            textureBindings[numTextureBindings].count = 1;
+            binding->stage = executionModel;
+            binding->desc_set = descriptor_set_index;
+            binding->binding = spvc_compiler_get_decoration(compiler, id, SpvDecorationBinding);
+            binding->count = 1;
             // assign binding index after we have collected all resources
-
-            numTextureBindings += 1;
-        }
-
-        // Readwrite storage textures
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_STORAGE_IMAGE,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_storage_textures);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
         }
+    }
 
-        for (size_t i = 0; i < num_storage_textures; i += 1) {
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-
-            // Skip readonly textures
-            if (descriptor_set_index != 1) { continue; }
+    return true;
+}
 
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+// Uniform buffers are pushed per draw, so their descriptor sets never go in an argument buffer
+static bool SDL_ShaderCross_INTERNAL_IsMSLUniformBufferSet(Uint32 set, bool compute)
+{
+    return compute ? (set == 2) : (set == 1 || set == 3);
+}
 
-            textureBindings[numTextureBindings].stage = executionModel;
-            textureBindings[numTextureBindings].desc_set = descriptor_set_index;
-            textureBindings[numTextureBindings].binding = binding_index;
-            textureBindings[numTextureBindings].count = 1;
-            // assign binding index after we have collected all resources
+static Uint32 SDL_ShaderCross_INTERNAL_GetMSLUniformBufferCount(const MSLResourceBindings *bindings, bool compute)
+{
+    return compute ? bindings->bufferCountPerSet[2] : (bindings->bufferCountPerSet[1] + bindings->bufferCountPerSet[3]);
+}
 
-            numTextureBindings += 1;
+// Lays out one argument buffer per descriptor set that isn't a uniform buffer set, bound after the uniform buffers.
+// Arguments are ordered by binding, and sampled textures take two ids: the texture's, then its sampler's.
+// Returns a single SDL_malloc'd allocation, with the arguments stored after the argument buffers.
+static SDL_ShaderCross_MSLArgumentBuffer *SDL_ShaderCross_INTERNAL_LayoutMSLArgumentBuffers(
+    const MSLResourceBindings *bindings,
+    bool compute,
+    int *count)
+{
+    Uint32 numArgumentBuffers = 0;
+    Uint32 numArguments = 0;
+    for (Uint32 set = 0; set < 4; set += 1) {
+        if (SDL_ShaderCross_INTERNAL_IsMSLUniformBufferSet(set, compute)) {
+            continue;
         }
-
-        // If source is HLSL, storage images might be marked as separate images
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_SEPARATE_IMAGE,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_separate_images);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
+        Uint32 setArguments = bindings->textureCountPerSet[set] + bindings->bufferCountPerSet[set];
+        if (setArguments > 0) {
+            numArgumentBuffers += 1;
+            numArguments += setArguments;
         }
+    }
 
-        // We only want to iterate the images that don't have an associated sampler
-        for (size_t i = num_separate_samplers; i < num_separate_images; i += 1) {
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-
-            // Skip readonly textures
-            if (descriptor_set_index != 1) { continue; }
-
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
-
-            textureBindings[numTextureBindings].stage = executionModel;
-            textureBindings[numTextureBindings].desc_set = descriptor_set_index;
-            textureBindings[numTextureBindings].binding = binding_index;
-            textureBindings[numTextureBindings].count = 1;
-            // assign binding index after we have collected all resources
+    SDL_ShaderCross_MSLArgumentBuffer *argumentBuffers = (SDL_ShaderCross_MSLArgumentBuffer *)SDL_malloc(
+        SDL_max(numArgumentBuffers, 1) * sizeof(SDL_ShaderCross_MSLArgumentBuffer) +
+        numArguments * sizeof(SDL_ShaderCross_MSLArgument));
+    if (argumentBuffers == NULL) {
+        return NULL;
+    }
 
-            numTextureBindings += 1;
-        }
+    SDL_ShaderCross_MSLArgument *arguments = (SDL_ShaderCross_MSLArgument *)(argumentBuffers + numArgumentBuffers);
+    Uint32 bufferIndex = SDL_ShaderCross_INTERNAL_GetMSLUniformBufferCount(bindings, compute);
+    SDL_ShaderCross_MSLArgumentBuffer *argumentBuffer = argumentBuffers;
 
-        // Uniform buffers
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_UNIFORM_BUFFER,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_uniform_buffers);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
+    for (Uint32 set = 0; set < 4; set += 1) {
+        if (SDL_ShaderCross_INTERNAL_IsMSLUniformBufferSet(set, compute) || bindings->textureCountPerSet[set] + bindings->bufferCountPerSet[set] == 0) {
+            continue;
         }
 
-        for (size_t i = 0; i < num_uniform_buffers; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
-                SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
-            }
+        argumentBuffer->descriptor_set = set;
+        argumentBuffer->buffer_index = bufferIndex++;
+        argumentBuffer->num_arguments = 0;
+        argumentBuffer->arguments = arguments;
 
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (descriptor_set_index != 2) {
-                SDL_SetError("%s", "Descriptor set index for compute uniform buffer must be 2!");
-                spvc_context_destroy(context);
-                return NULL;
+        for (Uint32 i = 0; i < bindings->numTextureBindings; i += 1) {
+            if (bindings->textureBindings[i].desc_set == set) {
+                SDL_ShaderCross_MSLArgument *argument = &arguments[argumentBuffer->num_arguments++];
+                argument->binding = bindings->textureBindings[i].binding;
+                argument->type = bindings->textureKinds[i] == MSL_RESOURCE_KIND_SAMPLER ? SDL_SHADERCROSS_MSLARGUMENTTYPE_SAMPLED_TEXTURE : SDL_SHADERCROSS_MSLARGUMENTTYPE_STORAGE_TEXTURE;
             }
-
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
-
-            bufferBindings[numBufferBindings].stage = executionModel;
-            bufferBindings[numBufferBindings].desc_set = descriptor_set_index;
-            bufferBindings[numBufferBindings].binding = binding_index;
-            bufferBindings[numBufferBindings].count = 1;
-            // assign binding index after we have collected all resources
-
-            numBufferBindings += 1;
         }
-
-        // Storage buffers
-        result = spvc_resources_get_resource_list_for_type(
-            resources,
-            SPVC_RESOURCE_TYPE_STORAGE_BUFFER,
-            (const spvc_reflected_resource **)&reflected_resources,
-            &num_storage_buffers);
-        if (result < 0) {
-            SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
+        for (Uint32 i = 0; i < bindings->numBufferBindings; i += 1) {
+            if (bindings->bufferBindings[i].desc_set == set) {
+                SDL_ShaderCross_MSLArgument *argument = &arguments[argumentBuffer->num_arguments++];
+                argument->binding = bindings->bufferBindings[i].binding;
+                argument->type = SDL_SHADERCROSS_MSLARGUMENTTYPE_STORAGE_BUFFER;
+            }
         }
 
-        // Readonly storage buffers
-        for (size_t i = 0; i < num_storage_buffers; i += 1) {
-            if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
-                SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-                spvc_context_destroy(context);
-                return NULL;
+        // Sort by binding, the sets hold a handful of resources at most
+        for (Uint32 i = 1; i < argumentBuffer->num_arguments; i += 1) {
+            SDL_ShaderCross_MSLArgument argument = arguments[i];
+            Uint32 j = i;
+            while (j > 0 && arguments[j - 1].binding > argument.binding) {
+                arguments[j] = arguments[j - 1];
+                j -= 1;
             }
+            arguments[j] = argument;
+        }
 
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-            if (!(descriptor_set_index == 0|| descriptor_set_index == 1)) {
-                SDL_SetError("%s", "Descriptor set index for compute storage buffer must be 0 or 1!");
-                spvc_context_destroy(context);
-                return NULL;
+        Uint32 id = 0;
+        for (Uint32 i = 0; i < argumentBuffer->num_arguments; i += 1) {
+            arguments[i].id = id++;
+            if (arguments[i].type == SDL_SHADERCROSS_MSLARGUMENTTYPE_SAMPLED_TEXTURE) {
+                arguments[i].sampler_id = id++;
+            } else {
+                arguments[i].sampler_id = 0;
             }
-
-            // Skip readwrite buffers
-            if (descriptor_set_index != 0) { continue; }
-
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
-
-            bufferBindings[numBufferBindings].stage = executionModel;
-            bufferBindings[numBufferBindings].desc_set = descriptor_set_index;
-            bufferBindings[numBufferBindings].binding = binding_index;
-            bufferBindings[numBufferBindings].count = 1;
-            // assign binding index after we have collected all resources
-
-            numBufferBindings += 1;
         }
 
-        // Readwrite storage buffers
-        for (size_t i = 0; i < num_storage_buffers; i += 1) {
-            unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
-
-            // Skip readonly buffers
-            if (descriptor_set_index != 1) { continue; }
-
-            unsigned int binding_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding);
+        arguments += argumentBuffer->num_arguments;
+        argumentBuffer += 1;
+    }
 
-            bufferBindings[numBufferBindings].stage = executionModel;
-            bufferBindings[numBufferBindings].desc_set = descriptor_set_index;
-            bufferBindings[numBufferBindings].binding = binding_index;
-            bufferBindings[numBufferBindings].count = 1;
-            // assign binding index after we have collected all resources
+    *count = (int)numArgumentBuffers;
+    return argumentBuffers;
+}
 
-            numBufferBindings += 1;
+static const SDL_ShaderCross_MSLArgument *SDL_ShaderCross_INTERNAL_FindMSLArgument(
+    const SDL_ShaderCross_MSLArgumentBuffer *argumentBuffers,
+    int numArgumentBuffers,
+    Uint32 set,
+    Uint32 binding)
+{
+    for (int i = 0; i < numArgumentBuffers; i += 1) {
+        if (argumentBuffers[i].descriptor_set != set) {
+            continue;
+        }
+        for (Uint32 j = 0; j < argumentBuffers[i].num_arguments; j += 1) {
+            if (argumentBuffers[i].arguments[j].binding == binding) {
+                return &argumentBuffers[i].arguments[j];
+            }
         }
+    }
+    return NULL;
+}
 
-        // Calculate binding offsets
+// Assigns the [[id(n)]] of every resource in the argument buffers, and the [[buffer(n)]] of the argument buffers themselves
+static bool SDL_ShaderCross_INTERNAL_AssignMSLArgumentBufferIndices(
+    spvc_context context,
+    spvc_compiler compiler,
+    MSLResourceBindings *bindings,
+    SpvExecutionModel executionModel,
+    bool compute)
+{
+    spvc_result result;
+    int numArgumentBuffers;
+    SDL_ShaderCross_MSLArgumentBuffer *argumentBuffers = SDL_ShaderCross_INTERNAL_LayoutMSLArgumentBuffers(bindings, compute, &numArgumentBuffers);
+    if (argumentBuffers == NULL) {
+        return false;
+    }
 
-        Uint32 readonlyTextureCount = 0;
-        Uint32 readwriteTextureCount = 0;
+    for (Uint32 i = 0; i < bindings->numTextureBindings; i += 1) {
+        const SDL_ShaderCross_MSLArgument *argument = SDL_ShaderCross_INTERNAL_FindMSLArgument(
+            argumentBuffers,
+            numArgumentBuffers,
+            bindings->textureBindings[i].desc_set,
+            bindings->textureBindings[i].binding);
+        bindings->textureBindings[i].msl_texture = argument->id;
+        bindings->textureBindings[i].msl_sampler = argument->type == SDL_SHADERCROSS_MSLARGUMENTTYPE_SAMPLED_TEXTURE ? argument->sampler_id : argument->id;
+    }
 
-        for (Uint32 i = 0; i < numTextureBindings; i += 1) {
-            if (textureBindings[i].desc_set == 0) {
-                readonlyTextureCount += 1;
-            } else if (textureBindings[i].desc_set == 1) {
-                readwriteTextureCount += 1;
-            }
+    for (Uint32 i = 0; i < bindings->numBufferBindings; i += 1) {
+        if (SDL_ShaderCross_INTERNAL_IsMSLUniformBufferSet(bindings->bufferBindings[i].desc_set, compute)) {
+            // Uniform buffers are alone in the descriptor set
+            bindings->bufferBindings[i].msl_buffer = bindings->bufferBindings[i].binding;
+        } else {
+            const SDL_ShaderCross_MSLArgument *argument = SDL_ShaderCross_INTERNAL_FindMSLArgument(
+                argumentBuffers,
+                numArgumentBuffers,
+                bindings->bufferBindings[i].desc_set,
+                bindings->bufferBindings[i].binding);
+            bindings->bufferBindings[i].msl_buffer = argument->id;
         }
+    }
 
-        Uint32 uniformBufferCount = 0;
-        Uint32 readonlyBufferCount = 0;
+    for (int i = 0; i < numArgumentBuffers; i += 1) {
+        spvc_msl_resource_binding_2 binding;
+        SDL_zero(binding);
+        binding.stage = executionModel;
+        binding.desc_set = argumentBuffers[i].descriptor_set;
+        binding.binding = SPVC_MSL_ARGUMENT_BUFFER_BINDING;
+        binding.msl_buffer = argumentBuffers[i].buffer_index;
+        result = spvc_compiler_msl_add_resource_binding_2(compiler, &binding);
+        if (result < 0) {
+            SPVC_ERROR(spvc_compiler_msl_add_resource_binding_2);
+            SDL_free(argumentBuffers);
+            return false;
+        }
+    }
 
-        for (Uint32 i = 0; i < numBufferBindings; i += 1) {
-            if (bufferBindings[i].desc_set == 0) {
-                readonlyBufferCount += 1;
-            } else if (bufferBindings[i].desc_set == 2) {
-                uniformBufferCount += 1;
+    for (Uint32 set = 0; set < 4; set += 1) {
+        if (SDL_ShaderCross_INTERNAL_IsMSLUniformBufferSet(set, compute)) {
+            result = spvc_compiler_msl_add_discrete_descriptor_set(compiler, set);
+            if (result < 0) {
+                SPVC_ERROR(spvc_compiler_msl_add_discrete_descriptor_set);
+                SDL_free(argumentBuffers);
+                return false;
             }
         }
+    }
 
-        // Calculate resource indices
+    SDL_free(argumentBuffers);
+    return true;
+}
 
-        for (Uint32 i = 0; i < numTextureBindings; i += 1) {
-            if (textureBindings[i].desc_set == 0) {
-                // readonly textures
-                textureBindings[i].msl_texture = textureBindings[i].binding;
-                textureBindings[i].msl_sampler = textureBindings[i].binding;
-            } else {
-                // readwrite textures
-                textureBindings[i].msl_texture = readonlyTextureCount + textureBindings[i].binding;
-                textureBindings[i].msl_sampler = readonlyTextureCount + textureBindings[i].binding;
-            }
-            result = spvc_compiler_msl_add_resource_binding_2(compiler, &textureBindings[i]);
-            if (result < 0) {
-                SPVC_ERROR(spvc_compiler_msl_add_resource_binding_2);
-                spvc_context_destroy(context);
-                return NULL;
-            }
+// Assigns discrete [[texture(n)]], [[sampler(n)]] and [[buffer(n)]] indices following the SDL_GPU binding model
+static void SDL_ShaderCross_INTERNAL_AssignMSLDiscreteIndices(
+    MSLResourceBindings *bindings,
+    bool compute)
+{
+    spvc_msl_resource_binding_2 *textureBindings = bindings->textureBindings;
+    spvc_msl_resource_binding_2 *bufferBindings = bindings->bufferBindings;
+    const Uint32 *textureCountPerSet = bindings->textureCountPerSet;
+    const Uint32 *bufferCountPerSet = bindings->bufferCountPerSet;
+
+    for (Uint32 i = 0; i < bindings->numTextureBindings; i += 1) {
+        if (compute && textureBindings[i].desc_set == 1) {
+            // readwrite textures come after the readonly textures
+            textureBindings[i].msl_texture = textureCountPerSet[0] + textureBindings[i].binding;
+            textureBindings[i].msl_sampler = textureCountPerSet[0] + textureBindings[i].binding;
+        } else {
+            // Textures come first so we can just use the binding slot
+            textureBindings[i].msl_texture = textureBindings[i].binding;
+            textureBindings[i].msl_sampler = textureBindings[i].binding;
         }
+    }
 
-        for (Uint32 i = 0; i < numBufferBindings; i += 1) {
+    for (Uint32 i = 0; i < bindings->numBufferBindings; i += 1) {
+        Uint32 uniformBufferCount = SDL_ShaderCross_INTERNAL_GetMSLUniformBufferCount(bindings, compute);
+        if (compute) {
             if (bufferBindings[i].desc_set == 0) {
                 // Subtract by the readonly texture count because they precede readonly buffers in the descriptor set
-                bufferBindings[i].msl_buffer = uniformBufferCount + (bufferBindings[i].binding - readonlyTextureCount);
+                bufferBindings[i].msl_buffer = uniformBufferCount + (bufferBindings[i].binding - textureCountPerSet[0]);
             } else if (bufferBindings[i].desc_set == 1) {
                 // Subtract by the readwrite texture count because they precede readwrite buffers in the descriptor set
-                bufferBindings[i].msl_buffer = uniformBufferCount + readonlyBufferCount + (bufferBindings[i].binding - readwriteTextureCount);
+                bufferBindings[i].msl_buffer = uniformBufferCount + bufferCountPerSet[0] + (bufferBindings[i].binding - textureCountPerSet[1]);
             } else {
                 // Uniform buffers are alone in the descriptor set
                 bufferBindings[i].msl_buffer = bufferBindings[i].binding;
             }
-            result = spvc_compiler_msl_add_resource_binding_2(compiler, &bufferBindings[i]);
-
-            if (result < 0) {
-                SPVC_ERROR(spvc_compiler_msl_add_resource_binding_2);
-                spvc_context_destroy(context);
-                return NULL;
+        } else {
+            if (bufferBindings[i].desc_set == 1 || bufferBindings[i].desc_set == 3) {
+                // Uniform buffers are alone in the descriptor set
+                bufferBindings[i].msl_buffer = bufferBindings[i].binding;
+            } else {
+                // Subtract by the texture count because the textures precede the storage buffers in the descriptor set
+                bufferBindings[i].msl_buffer = uniformBufferCount + (bufferBindings[i].binding - bindings->numTextureBindings);
             }
         }
     }
+}
 
-    result = spvc_compiler_install_compiler_options(compiler, options);
-    if (result < 0) {
-        SPVC_ERROR(spvc_compiler_install_compiler_options);
-        spvc_context_destroy(context);
-        return NULL;
+// MSL doesn't have descriptor sets, so we have to set up index remapping.
+static bool SDL_ShaderCross_INTERNAL_AddMSLResourceBindings(
+    spvc_context context,
+    spvc_compiler compiler,
+    spvc_resources resources,
+    SpvExecutionModel executionModel,
+    bool compute,
+    bool argumentBuffers)
+{
+    spvc_result result;
+    MSLResourceBindings bindings;
+
+    if (!SDL_ShaderCross_INTERNAL_CollectMSLResourceBindings(context, compiler, resources, executionModel, compute, &bindings)) {
+        return false;
+    }
+    if (bindings.numTextureBindings + bindings.numBufferBindings == 0) {
+        return true;
     }
 
-    /* Compile to the target shader language */
-    result = spvc_compiler_compile(compiler, &translated_source);
-    if (result < 0) {
-        SPVC_ERROR(spvc_compiler_compile);
-        spvc_context_destroy(context);
-        return NULL;
+    if (argumentBuffers) {
+        if (!SDL_ShaderCross_INTERNAL_AssignMSLArgumentBufferIndices(context, compiler, &bindings, executionModel, compute)) {
+            SDL_free(bindings.textureBindings);
+            return false;
+        }
+    } else {
+        SDL_ShaderCross_INTERNAL_AssignMSLDiscreteIndices(&bindings, compute);
     }
 
-    if (backend == SPVC_BACKEND_MSL) {
-        // Metal doesn't allow a "main" entrypoint, so determine the "cleansed" entrypoint name (e.g. main -> main0 on MSL)
-        cleansed_entrypoint = spvc_compiler_get_cleansed_entry_point_name(
-            compiler,
+    for (Uint32 i = 0; i < bindings.numTextureBindings; i += 1) {
+        result = spvc_compiler_msl_add_resource_binding_2(compiler, &bindings.textureBindings[i]);
+        if (result < 0) {
+            SPVC_ERROR(spvc_compiler_msl_add_resource_binding_2);
+            SDL_free(bindings.textureBindings);
+            return false;
+        }
+    }
+
+    for (Uint32 i = 0; i < bindings.numBufferBindings; i += 1) {
+        result = spvc_compiler_msl_add_resource_binding_2(compiler, &bindings.bufferBindings[i]);
+        if (result < 0) {
+            SPVC_ERROR(spvc_compiler_msl_add_resource_binding_2);
+            SDL_free(bindings.textureBindings);
+            return false;
+        }
+    }
+
+    SDL_free(bindings.textureBindings);
+    return true;
+}
+
+// Selects the requested entry point of a module with several of them, and fills activeVariables with the
+// resources it uses. Single entry modules keep every resource and leave activeVariables NULL.
+static bool SDL_ShaderCross_INTERNAL_SelectEntryPoint(
+    spvc_context context,
+    spvc_compiler compiler,
+    const char *entrypoint,
+    SDL_ShaderCross_ShaderStage shaderStage,
+    spvc_set *activeVariables)
+{
+    spvc_result result;
+    const spvc_entry_point *entryPoints;
+    size_t numEntryPoints;
+
+    *activeVariables = NULL;
+
+    result = spvc_compiler_get_entry_points(compiler, &entryPoints, &numEntryPoints);
+    if (result < 0) {
+        SPVC_ERROR(spvc_compiler_get_entry_points);
+        return false;
+    }
+    if (numEntryPoints <= 1) {
+        return true;
+    }
+
+    SpvExecutionModel entryPointModel;
+    if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_VERTEX) {
+        entryPointModel = SpvExecutionModelVertex;
+    } else if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT) {
+        entryPointModel = SpvExecutionModelFragment;
+    } else {
+        entryPointModel = SpvExecutionModelGLCompute;
+    }
+    result = spvc_compiler_set_entry_point(compiler, entrypoint, entryPointModel);
+    if (result < 0) {
+        SPVC_ERROR(spvc_compiler_set_entry_point);
+        return false;
+    }
+
+    result = spvc_compiler_get_active_interface_variables(compiler, activeVariables);
+    if (result < 0) {
+        SPVC_ERROR(spvc_compiler_get_active_interface_variables);
+        return false;
+    }
+    return true;
+}
+
+static bool SDL_ShaderCross_INTERNAL_ReflectGraphicsResources(
+    spvc_context context,
+    spvc_compiler compiler,
+    spvc_resources resources,
+    void *buffer,
+    size_t *bufferSize,
+    void **allocated);
+
+static bool SDL_ShaderCross_INTERNAL_ReflectComputeResources(
+    spvc_context context,
+    spvc_compiler compiler,
+    spvc_resources resources,
+    SDL_ShaderCross_ComputePipelineMetadata *metadata);
+
+static SPIRVTranspileContext *SDL_ShaderCross_INTERNAL_DoTranspileFromSPIRV(
+    spvc_backend backend,
+    unsigned shadermodel, // only used for HLSL
+    SDL_ShaderCross_ShaderStage shaderStage, // used for MSL and multi-entry modules
+    const Uint8 *code,
+    size_t codeSize,
+    const char *entrypoint,
+    SDL_PropertiesID props,
+    void **metadata // optional, filled in with SDL_malloc'd graphics or compute metadata
+) {
+    spvc_result result;
+    spvc_context context = NULL;
+    spvc_parsed_ir ir = NULL;
+    spvc_compiler compiler = NULL;
+    spvc_compiler_options options = NULL;
+    spvc_resources resources = NULL;
+    SPIRVTranspileContext *transpileContext = NULL;
+    const char *translated_source;
+    const char *cleansed_entrypoint;
+
+    /* Create the SPIRV-Cross context */
+    result = spvc_context_create(&context);
+    if (result < 0) {
+        SDL_SetError("spvc_context_create failed: %X", result);
+        return NULL;
+    }
+
+    /* Parse the SPIR-V into IR */
+    SDL_ShaderCross_INTERNAL_TraceSpan("spvc_context_parse_spirv", true);
+    result = spvc_context_parse_spirv(context, (const SpvId *)code, codeSize / sizeof(SpvId), &ir);
+    SDL_ShaderCross_INTERNAL_TraceSpan("spvc_context_parse_spirv", false);
+    if (result < 0) {
+        SPVC_ERROR(spvc_context_parse_spirv);
+        spvc_context_destroy(context);
+        return NULL;
+    }
+
+    /* Create the cross-compiler */
+    result = spvc_context_create_compiler(context, backend, ir, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler);
+    if (result < 0) {
+        SPVC_ERROR(spvc_context_create_compiler);
+        spvc_context_destroy(context);
+        return NULL;
+    }
+
+    /* Modules with several entry points compile whichever one was asked for */
+    spvc_set activeVariables;
+    if (!SDL_ShaderCross_INTERNAL_SelectEntryPoint(context, compiler, entrypoint, shaderStage, &activeVariables)) {
+        spvc_context_destroy(context);
+        return NULL;
+    }
+
+    /* Set up the cross-compiler options */
+    result = spvc_compiler_create_compiler_options(compiler, &options);
+    if (result < 0) {
+        SPVC_ERROR(spvc_compiler_create_compiler_options);
+        spvc_context_destroy(context);
+        return NULL;
+    }
+
+    if (backend == SPVC_BACKEND_HLSL) {
+        spvc_compiler_options_set_uint(options, SPVC_COMPILER_OPTION_HLSL_SHADER_MODEL, shadermodel);
+        spvc_compiler_options_set_uint(options, SPVC_COMPILER_OPTION_HLSL_NONWRITABLE_UAV_TEXTURE_AS_SRV, 1);
+        spvc_compiler_options_set_uint(options, SPVC_COMPILER_OPTION_HLSL_FLATTEN_MATRIX_VERTEX_INPUT_SEMANTICS, 1);
+        spvc_compiler_options_set_bool(options, SPVC_COMPILER_OPTION_HLSL_USE_ENTRY_POINT_NAME, !SDL_GetBooleanProperty(props, SDL_SHADERCROSS_PROP_SPIRV_PSSL_COMPATIBILITY_BOOLEAN, false));
+        spvc_compiler_options_set_bool(options, SPVC_COMPILER_OPTION_HLSL_POINT_SIZE_COMPAT, true);
+        // Below SM 6.2 SPIRV-Cross falls back to min16 types, which is what DXBC and PSSL get
+        if (shadermodel >= 62 && SDL_GetBooleanProperty(props, SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN, false)) {
+            spvc_compiler_options_set_bool(options, SPVC_COMPILER_OPTION_HLSL_ENABLE_16BIT_TYPES, true);
+        }
+    }
+
+    SpvExecutionModel executionModel;
+    if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_VERTEX) {
+        executionModel = SpvExecutionModelVertex;
+    } else if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT) {
+        executionModel = SpvExecutionModelFragment;
+    } else { // compute
+        if (backend == SPVC_BACKEND_HLSL) {
+            executionModel = SpvExecutionModelKernel;
+        } else {
+            executionModel = SpvExecutionModelGLCompute;
+        }
+    }
+
+    bool argumentBuffers = false;
+    if (backend == SPVC_BACKEND_MSL) {
+        // Argument buffers need MSL 2.0
+        argumentBuffers = SDL_GetBooleanProperty(props, SDL_SHADERCROSS_PROP_SPIRV_MSL_ARGUMENT_BUFFERS_BOOLEAN, false);
+        const char *_mslVersion = SDL_GetStringProperty(props, SDL_SHADERCROSS_PROP_SPIRV_MSL_VERSION_STRING, argumentBuffers ? "2.0.0" : "1.2.0");
+        int mslVersion = parse_version_number(_mslVersion);
+        if (mslVersion == - 1) {
+            SDL_SetError("failed to parse MSL version string \"%s\"", _mslVersion);
+            spvc_context_destroy(context);
+            return NULL;
+        }
+        if (argumentBuffers && mslVersion < 20000) {
+            SDL_SetError("MSL argument buffers require MSL 2.0 or later, got \"%s\"", _mslVersion);
+            spvc_context_destroy(context);
+            return NULL;
+        }
+        spvc_compiler_options_set_uint(options, SPVC_COMPILER_OPTION_MSL_VERSION, mslVersion);
+        spvc_compiler_options_set_bool(options, SPVC_COMPILER_OPTION_MSL_ARGUMENT_BUFFERS, argumentBuffers);
+    }
+
+    // Enumerate resources once, for both the MSL bindings and reflection
+    if (activeVariables != NULL) {
+        // Only the resources the selected entry point touches get emitted and reflected
+        result = spvc_compiler_set_enabled_interface_variables(compiler, activeVariables);
+        if (result < 0) {
+            SPVC_ERROR(spvc_compiler_set_enabled_interface_variables);
+            spvc_context_destroy(context);
+            return NULL;
+        }
+        if (backend == SPVC_BACKEND_MSL || metadata != NULL) {
+            result = spvc_compiler_create_shader_resources_for_active_variables(compiler, &resources, activeVariables);
+            if (result < 0) {
+                SPVC_ERROR(spvc_compiler_create_shader_resources_for_active_variables);
+                spvc_context_destroy(context);
+                return NULL;
+            }
+        }
+    } else if (backend == SPVC_BACKEND_MSL || metadata != NULL) {
+        result = spvc_compiler_create_shader_resources(compiler, &resources);
+        if (result < 0) {
+            SPVC_ERROR(spvc_compiler_create_shader_resources);
+            spvc_context_destroy(context);
+            return NULL;
+        }
+    }
+
+    // Reflect before compiling, so the metadata describes the module as given
+    if (metadata != NULL) {
+        bool reflected;
+        if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+            *metadata = SDL_malloc(sizeof(SDL_ShaderCross_ComputePipelineMetadata));
+            reflected = *metadata != NULL && SDL_ShaderCross_INTERNAL_ReflectComputeResources(context, compiler, resources, (SDL_ShaderCross_ComputePipelineMetadata *)*metadata);
+        } else {
+            reflected = SDL_ShaderCross_INTERNAL_ReflectGraphicsResources(context, compiler, resources, NULL, NULL, metadata);
+        }
+        if (!reflected) {
+            spvc_context_destroy(context);
+            return NULL;
+        }
+    }
+
+    if (backend == SPVC_BACKEND_MSL) {
+        if (!SDL_ShaderCross_INTERNAL_AddMSLResourceBindings(
+                context,
+                compiler,
+                resources,
+                executionModel,
+                shaderStage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE,
+                argumentBuffers)) {
+            spvc_context_destroy(context);
+            return NULL;
+        }
+    }
+
+    result = spvc_compiler_install_compiler_options(compiler, options);
+    if (result < 0) {
+        SPVC_ERROR(spvc_compiler_install_compiler_options);
+        spvc_context_destroy(context);
+        return NULL;
+    }
+
+    /* Compile to the target shader language */
+    SDL_ShaderCross_INTERNAL_TraceSpan("spvc_compiler_compile", true);
+    result = spvc_compiler_compile(compiler, &translated_source);
+    SDL_ShaderCross_INTERNAL_TraceSpan("spvc_compiler_compile", false);
+    if (result < 0) {
+        SPVC_ERROR(spvc_compiler_compile);
+        spvc_context_destroy(context);
+        return NULL;
+    }
+
+    if (backend == SPVC_BACKEND_MSL) {
+        // Metal doesn't allow a "main" entrypoint, so determine the "cleansed" entrypoint name (e.g. main -> main0 on MSL)
+        cleansed_entrypoint = spvc_compiler_get_cleansed_entry_point_name(
+            compiler,
             entrypoint,
             spvc_compiler_get_execution_model(compiler));
     } else {
@@ -1629,6 +3063,54 @@ static SPIRVTranspileContext *SDL_ShaderCross_INTERNAL_TranspileFromSPIRV(
     return transpileContext;
 }
 
+static SPIRVTranspileContext *SDL_ShaderCross_INTERNAL_TranspileFromSPIRV(
+    spvc_backend backend,
+    unsigned shadermodel, // only used for HLSL
+    SDL_ShaderCross_ShaderStage shaderStage, // only used for MSL
+    const Uint8 *code,
+    size_t codeSize,
+    const char *entrypoint,
+    SDL_PropertiesID props,
+    void **metadata // optional, filled in with SDL_malloc'd graphics or compute metadata
+) {
+    if (metadata != NULL) {
+        *metadata = NULL;
+    }
+
+    // Preprocessing counts towards the transpile stage
+    SDL_ShaderCross_TimingStage previousTimingStage = SDL_ShaderCross_INTERNAL_BeginTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_TRANSPILE);
+    Uint32 *processed;
+    size_t processedSize;
+    if (!SDL_ShaderCross_INTERNAL_PreprocessSPIRV(code, codeSize, props, &processed, &processedSize)) {
+        SDL_ShaderCross_INTERNAL_EndTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_TRANSPILE, previousTimingStage);
+        return NULL;
+    }
+    if (processed != NULL) {
+        code = (const Uint8 *)processed;
+        codeSize = processedSize;
+    }
+
+    SDL_ShaderCross_MemoryStage previousStage = SDL_ShaderCross_INTERNAL_SetMemoryStage(SDL_SHADERCROSS_MEMORYSTAGE_SPIRVCROSS);
+    SPIRVTranspileContext *transpileContext = SDL_ShaderCross_INTERNAL_DoTranspileFromSPIRV(
+        backend,
+        shadermodel,
+        shaderStage,
+        code,
+        codeSize,
+        entrypoint,
+        props,
+        metadata);
+    SDL_ShaderCross_INTERNAL_SetMemoryStage(previousStage);
+    SDL_ShaderCross_INTERNAL_EndTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_TRANSPILE, previousTimingStage);
+    SDL_free(processed);
+
+    if (transpileContext == NULL && metadata != NULL) {
+        SDL_free(*metadata);
+        *metadata = NULL;
+    }
+    return transpileContext;
+}
+
 size_t SDL_ShaderCross_INTERNAL_GetIOVarsStringLength(
     spvc_reflected_resource* reflected_resources,
     size_t num_vars)
@@ -1704,17 +3186,19 @@ void SDL_ShaderCross_INTERNAL_GetIOVars(
     }
 }
 
-// Acquire metadata from SPIRV bytecode.
+// Acquire graphics metadata from an already parsed module and its shader resources.
+// If allocated is non-NULL the metadata is SDL_malloc'd into it, otherwise it is written into buffer.
+// A NULL buffer only fills in bufferSize with the number of bytes required.
 // TODO: validate descriptor sets
-SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
-    const Uint8 *code,
-    size_t codeSize,
-    SDL_PropertiesID metadataProps
+static bool SDL_ShaderCross_INTERNAL_ReflectGraphicsResources(
+    spvc_context context,
+    spvc_compiler compiler,
+    spvc_resources resources,
+    void *buffer,
+    size_t *bufferSize,
+    void **allocated
 ) {
     spvc_result result;
-    spvc_context context = NULL;
-    spvc_parsed_ir ir = NULL;
-    spvc_compiler compiler = NULL;
     size_t num_texture_samplers = 0;
     size_t num_storage_textures = 0;
     size_t num_storage_buffers = 0;
@@ -1725,46 +3209,9 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
     size_t num_outputs = 0;
     size_t num_separate_samplers = 0; // HLSL edge case
     size_t num_separate_images = 0; // HLSL edge case
-    (void) metadataProps;
-
-    if (code == NULL) {
-        SDL_InvalidParamError("code");
-        return NULL;
-    }
-
-    /* Create the SPIRV-Cross context */
-    result = spvc_context_create(&context);
-    if (result < 0) {
-        SDL_SetError("spvc_context_create failed: %X", result);
-        return NULL;
-    }
-
-    /* Parse the SPIR-V into IR */
-    result = spvc_context_parse_spirv(context, (const SpvId *)code, codeSize / sizeof(SpvId), &ir);
-    if (result < 0) {
-        SPVC_ERROR(spvc_context_parse_spirv);
-        spvc_context_destroy(context);
-        return NULL;
-    }
-
-    /* Create a reflection-only compiler */
-    result = spvc_context_create_compiler(context, SPVC_BACKEND_NONE, ir, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler);
-    if (result < 0) {
-        SPVC_ERROR(spvc_context_create_compiler);
-        spvc_context_destroy(context);
-        return NULL;
-    }
 
-    spvc_resources resources;
     spvc_reflected_resource *reflected_resources;
 
-    result = spvc_compiler_create_shader_resources(compiler, &resources);
-    if (result < 0) {
-        SPVC_ERROR(spvc_compiler_create_shader_resources);
-        spvc_context_destroy(context);
-        return NULL;
-    }
-
     // Combined texture-samplers
     result = spvc_resources_get_resource_list_for_type(
         resources,
@@ -1773,8 +3220,7 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
         &num_texture_samplers);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
-        return NULL;
+        return false;
     }
 
     // If source is HLSL, we might have separate images and samplers
@@ -1786,8 +3232,7 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
             &num_separate_samplers);
         if (result < 0) {
             SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
-            return NULL;
+            return false;
         }
         num_texture_samplers = num_separate_samplers;
     }
@@ -1800,8 +3245,7 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
         &num_storage_textures);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
-        return NULL;
+        return false;
     }
 
     // If source is HLSL, storage images might be marked as separate images
@@ -1812,8 +3256,7 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
         &num_separate_images);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
-        return NULL;
+        return false;
     }
     // The number of storage textures is the number of separate images minus the number of samplers.
     num_storage_textures += (num_separate_images - num_separate_samplers);
@@ -1826,8 +3269,7 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
         &num_storage_buffers);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
-        return NULL;
+        return false;
     }
 
     // Uniform buffers
@@ -1838,8 +3280,7 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
         &num_uniform_buffers);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
-        return NULL;
+        return false;
     }
 
     // Inputs (stage 1: count number of inputs, and name lengths)
@@ -1850,8 +3291,7 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
         &num_inputs);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
-        return NULL;
+        return false;
     }
     string_length_input = SDL_ShaderCross_INTERNAL_GetIOVarsStringLength(reflected_resources, num_inputs);
 
@@ -1863,8 +3303,7 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
         &num_outputs);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
-        return NULL;
+        return false;
     }
     string_length_output = SDL_ShaderCross_INTERNAL_GetIOVarsStringLength(reflected_resources, num_outputs);
 
@@ -1872,11 +3311,22 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
     size_t offset_outputs = offset_inputs + num_inputs * sizeof(SDL_ShaderCross_IOVarMetadata);
     size_t offset_inputnames = offset_outputs + num_outputs * sizeof(SDL_ShaderCross_IOVarMetadata);
     size_t offset_outputnames = offset_inputnames + string_length_input;
+    size_t requiredSize = offset_outputnames + string_length_output;
 
-    char *allocMemory = SDL_malloc(offset_outputnames + string_length_output);
-    if (!allocMemory) {
-        spvc_context_destroy(context);
-        return NULL;
+    char *allocMemory;
+    if (allocated != NULL) {
+        allocMemory = SDL_malloc(requiredSize);
+        if (!allocMemory) {
+            return false;
+        }
+    } else if (buffer == NULL) {
+        *bufferSize = requiredSize;
+        return true;
+    } else if (*bufferSize < requiredSize) {
+        *bufferSize = requiredSize;
+        return SDL_SetError("Reflection buffer is too small, %u bytes are required", (unsigned int)requiredSize);
+    } else {
+        allocMemory = (char *)buffer;
     }
 
     SDL_ShaderCross_GraphicsShaderMetadata *allocMetadata = (SDL_ShaderCross_GraphicsShaderMetadata *)allocMemory;
@@ -1892,8 +3342,9 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
             &num_inputs_run2);
     if (result < 0 || num_inputs != num_inputs_run2) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
-        SDL_free(allocMemory);
+        if (allocated != NULL) {
+            SDL_free(allocMemory);
+        }
         return false;
     }
     SDL_ShaderCross_INTERNAL_GetIOVars(compiler, reflected_resources, num_inputs, allocMetadata->inputs, allocMemory + offset_inputnames);
@@ -1907,12 +3358,12 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
             &num_outputs_run2);
     if (result < 0 || num_outputs != num_outputs_run2) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
-        SDL_free(allocMemory);
+        if (allocated != NULL) {
+            SDL_free(allocMemory);
+        }
         return false;
     }
     SDL_ShaderCross_INTERNAL_GetIOVars(compiler, reflected_resources, num_outputs, allocMetadata->outputs, allocMemory + offset_outputnames);
-    spvc_context_destroy(context);
 
     allocMetadata->resource_info.num_samplers = num_texture_samplers;
     allocMetadata->resource_info.num_storage_textures = num_storage_textures;
@@ -1921,36 +3372,24 @@ SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
     allocMetadata->num_inputs = num_inputs;
     allocMetadata->num_outputs = num_outputs;
 
-    return allocMetadata;
+    if (allocated != NULL) {
+        *allocated = allocMetadata;
+    } else {
+        *bufferSize = requiredSize;
+    }
+    return true;
 }
 
-SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
-    const Uint8 *bytecode,
-    size_t bytecodeSize,
-    SDL_PropertiesID metadataProps
+static bool SDL_ShaderCross_INTERNAL_CreateReflectionCompiler(
+    const Uint8 *code,
+    size_t codeSize,
+    spvc_context *contextOut,
+    spvc_compiler *compilerOut,
+    spvc_resources *resourcesOut
 ) {
     spvc_result result;
     spvc_context context = NULL;
     spvc_parsed_ir ir = NULL;
-    spvc_compiler compiler = NULL;
-    size_t num_texture_samplers = 0;
-    size_t num_readonly_storage_textures = 0;
-    size_t num_readonly_storage_buffers = 0;
-    size_t num_readwrite_storage_textures = 0;
-    size_t num_readwrite_storage_buffers = 0;
-    size_t num_uniform_buffers = 0;
-
-    size_t num_storage_textures = 0;
-    size_t num_storage_buffers = 0;
-    size_t num_separate_samplers = 0; // HLSL edge case
-    size_t num_separate_images = 0; // HLSL edge case
-
-    (void) metadataProps;
-
-    if (bytecode == NULL) {
-        SDL_InvalidParamError("bytecode");
-        return NULL;
-    }
 
     /* Create the SPIRV-Cross context */
     result = spvc_context_create(&context);
@@ -1960,7 +3399,9 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
     }
 
     /* Parse the SPIR-V into IR */
-    result = spvc_context_parse_spirv(context, (const SpvId *)bytecode, bytecodeSize / sizeof(SpvId), &ir);
+    SDL_ShaderCross_INTERNAL_TraceSpan("spvc_context_parse_spirv", true);
+    result = spvc_context_parse_spirv(context, (const SpvId *)code, codeSize / sizeof(SpvId), &ir);
+    SDL_ShaderCross_INTERNAL_TraceSpan("spvc_context_parse_spirv", false);
     if (result < 0) {
         SPVC_ERROR(spvc_context_parse_spirv);
         spvc_context_destroy(context);
@@ -1968,23 +3409,106 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
     }
 
     /* Create a reflection-only compiler */
-    result = spvc_context_create_compiler(context, SPVC_BACKEND_NONE, ir, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler);
+    result = spvc_context_create_compiler(context, SPVC_BACKEND_NONE, ir, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, compilerOut);
     if (result < 0) {
         SPVC_ERROR(spvc_context_create_compiler);
         spvc_context_destroy(context);
         return false;
     }
 
-    spvc_resources resources;
-    spvc_reflected_resource *reflected_resources;
-
-    result = spvc_compiler_create_shader_resources(compiler, &resources);
+    result = spvc_compiler_create_shader_resources(*compilerOut, resourcesOut);
     if (result < 0) {
         SPVC_ERROR(spvc_compiler_create_shader_resources);
         spvc_context_destroy(context);
         return false;
     }
 
+    *contextOut = context;
+    return true;
+}
+
+static bool SDL_ShaderCross_INTERNAL_ReflectGraphicsSPIRV(
+    const Uint8 *code,
+    size_t codeSize,
+    void *buffer,
+    size_t *bufferSize,
+    void **allocated
+) {
+    spvc_context context;
+    spvc_compiler compiler;
+    spvc_resources resources;
+
+    SDL_ShaderCross_TimingStage previousStage = SDL_ShaderCross_INTERNAL_BeginTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_REFLECTION);
+    bool result = SDL_ShaderCross_INTERNAL_CreateReflectionCompiler(code, codeSize, &context, &compiler, &resources);
+    if (result) {
+        result = SDL_ShaderCross_INTERNAL_ReflectGraphicsResources(context, compiler, resources, buffer, bufferSize, allocated);
+        spvc_context_destroy(context);
+    }
+    SDL_ShaderCross_INTERNAL_EndTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_REFLECTION, previousStage);
+    return result;
+}
+
+SDL_ShaderCross_GraphicsShaderMetadata * SDL_ShaderCross_ReflectGraphicsSPIRV(
+    const Uint8 *code,
+    size_t codeSize,
+    SDL_PropertiesID metadataProps
+) {
+    void *metadata = NULL;
+    (void) metadataProps;
+
+    if (code == NULL) {
+        SDL_InvalidParamError("code");
+        return NULL;
+    }
+
+    if (!SDL_ShaderCross_INTERNAL_ReflectGraphicsSPIRV(code, codeSize, NULL, NULL, &metadata)) {
+        return NULL;
+    }
+    return (SDL_ShaderCross_GraphicsShaderMetadata *)metadata;
+}
+
+bool SDL_ShaderCross_ReflectGraphicsSPIRVInto(
+    const Uint8 *code,
+    size_t codeSize,
+    SDL_PropertiesID metadataProps,
+    void *buffer,
+    size_t *bufferSize
+) {
+    (void) metadataProps;
+
+    if (code == NULL) {
+        return SDL_InvalidParamError("code");
+    }
+    if (bufferSize == NULL) {
+        return SDL_InvalidParamError("bufferSize");
+    }
+
+    return SDL_ShaderCross_INTERNAL_ReflectGraphicsSPIRV(code, codeSize, buffer, bufferSize, NULL);
+}
+
+
+// Acquire compute metadata from an already parsed module and its shader resources, into metadata.
+static bool SDL_ShaderCross_INTERNAL_ReflectComputeResources(
+    spvc_context context,
+    spvc_compiler compiler,
+    spvc_resources resources,
+    SDL_ShaderCross_ComputePipelineMetadata *metadata
+) {
+    spvc_result result;
+    size_t num_texture_samplers = 0;
+    size_t num_readonly_storage_textures = 0;
+    size_t num_readonly_storage_buffers = 0;
+    size_t num_readwrite_storage_textures = 0;
+    size_t num_readwrite_storage_buffers = 0;
+    size_t num_uniform_buffers = 0;
+
+    size_t num_storage_textures = 0;
+    size_t num_storage_buffers = 0;
+    size_t num_separate_samplers = 0; // HLSL edge case
+    size_t num_separate_images = 0; // HLSL edge case
+
+    spvc_reflected_resource *reflected_resources;
+
     // Combined texture-samplers
     result = spvc_resources_get_resource_list_for_type(
         resources,
@@ -1993,7 +3517,6 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
         &num_texture_samplers);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
         return false;
     }
 
@@ -2006,7 +3529,6 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
             &num_separate_samplers);
         if (result < 0) {
             SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-            spvc_context_destroy(context);
             return false;
         }
         num_texture_samplers = num_separate_samplers;
@@ -2020,14 +3542,12 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
         &num_storage_textures);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
         return false;
     }
 
     for (size_t i = 0; i < num_storage_textures; i += 1) {
         if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
             SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-            spvc_context_destroy(context);
             return false;
         }
 
@@ -2039,7 +3559,6 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
             num_readwrite_storage_textures += 1;
         } else {
             SDL_SetError("%s", "Descriptor set index for compute storage texture must be 0 or 1!");
-            spvc_context_destroy(context);
             return false;
         }
     }
@@ -2052,7 +3571,6 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
         &num_separate_images);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
         return false;
     }
 
@@ -2062,7 +3580,6 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
     for (size_t i = num_separate_samplers; i < num_separate_images; i += 1) {
         if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
             SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-            spvc_context_destroy(context);
             return false;
         }
 
@@ -2074,7 +3591,6 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
             num_readwrite_storage_textures += 1;
         } else {
             SDL_SetError("%s", "Descriptor set index for compute storage texture must be 0 or 1!");
-            spvc_context_destroy(context);
             return false;
         }
     }
@@ -2087,7 +3603,6 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
         &num_storage_buffers);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
         return false;
     }
 
@@ -2095,14 +3610,12 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
     for (size_t i = 0; i < num_storage_buffers; i += 1) {
         if (!spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet) || !spvc_compiler_has_decoration(compiler, reflected_resources[i].id, SpvDecorationBinding)) {
             SDL_SetError("%s", "Shader resources must have descriptor set and binding index!");
-            spvc_context_destroy(context);
             return false;
         }
 
         unsigned int descriptor_set_index = spvc_compiler_get_decoration(compiler, reflected_resources[i].id, SpvDecorationDescriptorSet);
         if (!(descriptor_set_index == 0 || descriptor_set_index == 1)) {
             SDL_SetError("%s", "Descriptor set index for compute storage buffer must be 0 or 1!");
-            spvc_context_destroy(context);
             return false;
         }
 
@@ -2112,7 +3625,6 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
             num_readwrite_storage_buffers += 1;
         } else {
             SDL_SetError("%s", "Descriptor set index for compute storage buffer must be 0 or 1!");
-            spvc_context_destroy(context);
             return false;
         }
     }
@@ -2125,35 +3637,167 @@ SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
         &num_uniform_buffers);
     if (result < 0) {
         SPVC_ERROR(spvc_resources_get_resource_list_for_type);
-        spvc_context_destroy(context);
         return false;
     }
 
     // Threadcount
-    SDL_ShaderCross_ComputePipelineMetadata *metadata = SDL_malloc(sizeof(SDL_ShaderCross_ComputePipelineMetadata));
-    if (!metadata) {
-        return NULL;
-    }
     metadata->threadcount_x = spvc_compiler_get_execution_mode_argument_by_index(compiler, SpvExecutionModeLocalSize, 0);
     metadata->threadcount_y = spvc_compiler_get_execution_mode_argument_by_index(compiler, SpvExecutionModeLocalSize, 1);
     metadata->threadcount_z = spvc_compiler_get_execution_mode_argument_by_index(compiler, SpvExecutionModeLocalSize, 2);
 
-    spvc_context_destroy(context);
-
     metadata->num_samplers = num_texture_samplers;
     metadata->num_readonly_storage_textures = num_readonly_storage_textures;
     metadata->num_readonly_storage_buffers = num_readonly_storage_buffers;
     metadata->num_readwrite_storage_textures = num_readwrite_storage_textures;
     metadata->num_readwrite_storage_buffers = num_readwrite_storage_buffers;
     metadata->num_uniform_buffers = num_uniform_buffers;
+    return true;
+}
+
+static bool SDL_ShaderCross_INTERNAL_ReflectComputeSPIRV(
+    const Uint8 *bytecode,
+    size_t bytecodeSize,
+    SDL_ShaderCross_ComputePipelineMetadata *metadata
+) {
+    spvc_context context;
+    spvc_compiler compiler;
+    spvc_resources resources;
+
+    SDL_ShaderCross_TimingStage previousStage = SDL_ShaderCross_INTERNAL_BeginTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_REFLECTION);
+    bool result = SDL_ShaderCross_INTERNAL_CreateReflectionCompiler(bytecode, bytecodeSize, &context, &compiler, &resources);
+    if (result) {
+        result = SDL_ShaderCross_INTERNAL_ReflectComputeResources(context, compiler, resources, metadata);
+        spvc_context_destroy(context);
+    }
+    SDL_ShaderCross_INTERNAL_EndTimingStage(SDL_SHADERCROSS_TIMINGSTAGE_REFLECTION, previousStage);
+    return result;
+}
+
+SDL_ShaderCross_ComputePipelineMetadata * SDL_ShaderCross_ReflectComputeSPIRV(
+    const Uint8 *bytecode,
+    size_t bytecodeSize,
+    SDL_PropertiesID metadataProps
+) {
+    (void) metadataProps;
+
+    if (bytecode == NULL) {
+        SDL_InvalidParamError("bytecode");
+        return NULL;
+    }
+
+    SDL_ShaderCross_ComputePipelineMetadata *metadata = SDL_malloc(sizeof(SDL_ShaderCross_ComputePipelineMetadata));
+    if (!metadata) {
+        return NULL;
+    }
+
+    if (!SDL_ShaderCross_INTERNAL_ReflectComputeSPIRV(bytecode, bytecodeSize, metadata)) {
+        SDL_free(metadata);
+        return NULL;
+    }
     return metadata;
 }
 
-static void *SDL_ShaderCross_INTERNAL_CompileFromSPIRV(
-    SDL_GPUDevice *device,
+bool SDL_ShaderCross_ReflectComputeSPIRVInto(
+    const Uint8 *bytecode,
+    size_t bytecodeSize,
+    SDL_PropertiesID metadataProps,
+    void *buffer,
+    size_t *bufferSize
+) {
+    (void) metadataProps;
+
+    if (bytecode == NULL) {
+        return SDL_InvalidParamError("bytecode");
+    }
+    if (bufferSize == NULL) {
+        return SDL_InvalidParamError("bufferSize");
+    }
+
+    // The compute metadata has a fixed size, so there is no need to parse anything to answer a size query
+    if (buffer == NULL) {
+        *bufferSize = sizeof(SDL_ShaderCross_ComputePipelineMetadata);
+        return true;
+    } else if (*bufferSize < sizeof(SDL_ShaderCross_ComputePipelineMetadata)) {
+        *bufferSize = sizeof(SDL_ShaderCross_ComputePipelineMetadata);
+        return SDL_SetError("Reflection buffer is too small, %u bytes are required", (unsigned int)sizeof(SDL_ShaderCross_ComputePipelineMetadata));
+    }
+
+    *bufferSize = sizeof(SDL_ShaderCross_ComputePipelineMetadata);
+    return SDL_ShaderCross_INTERNAL_ReflectComputeSPIRV(bytecode, bytecodeSize, (SDL_ShaderCross_ComputePipelineMetadata *)buffer);
+}
+
+SDL_ShaderCross_MSLArgumentBuffer *SDL_ShaderCross_ReflectMSLArgumentBuffers(
+    const SDL_ShaderCross_SPIRV_Info *info,
+    int *count)
+{
+    if (info == NULL) {
+        SDL_InvalidParamError("info");
+        return NULL;
+    }
+    if (count == NULL) {
+        SDL_InvalidParamError("count");
+        return NULL;
+    }
+    *count = 0;
+
+    // Reflect the same module the transpiler sees
+    const Uint8 *code = info->bytecode;
+    size_t codeSize = info->bytecode_size;
+    Uint32 *processed;
+    size_t processedSize;
+    if (!SDL_ShaderCross_INTERNAL_PreprocessSPIRV(code, codeSize, info->props, &processed, &processedSize)) {
+        return NULL;
+    }
+    if (processed != NULL) {
+        code = (const Uint8 *)processed;
+        codeSize = processedSize;
+    }
+
+    spvc_context context;
+    spvc_compiler compiler;
+    spvc_resources resources;
+    spvc_set activeVariables;
+    if (!SDL_ShaderCross_INTERNAL_CreateReflectionCompiler(code, codeSize, &context, &compiler, &resources)) {
+        SDL_free(processed);
+        return NULL;
+    }
+    if (!SDL_ShaderCross_INTERNAL_SelectEntryPoint(context, compiler, info->entrypoint, info->shader_stage, &activeVariables)) {
+        spvc_context_destroy(context);
+        SDL_free(processed);
+        return NULL;
+    }
+    if (activeVariables != NULL) {
+        spvc_result result = spvc_compiler_create_shader_resources_for_active_variables(compiler, &resources, activeVariables);
+        if (result < 0) {
+            SPVC_ERROR(spvc_compiler_create_shader_resources_for_active_variables);
+            spvc_context_destroy(context);
+            SDL_free(processed);
+            return NULL;
+        }
+    }
+
+    bool compute = info->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
+    MSLResourceBindings bindings;
+    SDL_ShaderCross_MSLArgumentBuffer *argumentBuffers = NULL;
+    // The execution model only matters to the compiler, which isn't involved here
+    if (SDL_ShaderCross_INTERNAL_CollectMSLResourceBindings(context, compiler, resources, SpvExecutionModelVertex, compute, &bindings)) {
+        argumentBuffers = SDL_ShaderCross_INTERNAL_LayoutMSLArgumentBuffers(&bindings, compute, count);
+        SDL_free(bindings.textureBindings);
+    }
+
+    spvc_context_destroy(context);
+    SDL_free(processed);
+    return argumentBuffers;
+}
+
+// Transpiles to the target format and, for DXBC and DXIL, compiles the result into an SDL_malloc'd buffer.
+// The returned context owns the cleansed entrypoint name and must be destroyed by the caller.
+static SPIRVTranspileContext *SDL_ShaderCross_INTERNAL_CompileSPIRVToFormat(
     const SDL_ShaderCross_SPIRV_Info *info,
     SDL_GPUShaderFormat targetFormat,
-    SDL_PropertiesID metadataProps
+    void **code,
+    size_t *size,
+    void **metadata // optional, filled in with SDL_malloc'd graphics or compute metadata
 ) {
     spvc_backend backend;
     unsigned shadermodel = 0;
@@ -2163,145 +3807,523 @@ static void *SDL_ShaderCross_INTERNAL_CompileFromSPIRV(
         shadermodel = 51;
     } else if (targetFormat == SDL_GPU_SHADERFORMAT_DXIL) {
         backend = SPVC_BACKEND_HLSL;
-        shadermodel = 60;
+        if (!SDL_ShaderCross_INTERNAL_GetDXILShaderModel(info->props, &shadermodel)) {
+            return NULL;
+        }
     } else if (targetFormat == SDL_GPU_SHADERFORMAT_MSL) {
         backend = SPVC_BACKEND_MSL;
     } else {
-        SDL_SetError("SDL_ShaderCross_INTERNAL_CompileFromSPIRV: Unexpected SDL_GPUBackend");
+        SDL_SetError("%s", "Unsupported shader format, expected DXBC, DXIL or MSL");
+        return NULL;
+    }
+
+    SPIRVTranspileContext *transpileContext = SDL_ShaderCross_INTERNAL_TranspileFromSPIRV(
+        backend,
+        shadermodel,
+        info->shader_stage,
+        info->bytecode,
+        info->bytecode_size,
+        info->entrypoint,
+        info->props,
+        metadata);
+
+    if (transpileContext == NULL) {
+        return NULL;
+    }
+
+    SDL_ShaderCross_HLSL_Info hlslInfo;
+    hlslInfo.source = transpileContext->translated_source;
+    hlslInfo.entrypoint = transpileContext->cleansed_entrypoint;
+    hlslInfo.include_dir = NULL;
+    hlslInfo.defines = NULL;
+    hlslInfo.shader_stage = info->shader_stage;
+    hlslInfo.props = info->props;
+
+    if (targetFormat == SDL_GPU_SHADERFORMAT_DXBC) {
+        *code = SDL_ShaderCross_INTERNAL_CompileDXBCFromHLSL(
+            &hlslInfo,
+            false,
+            size);
+    } else if (targetFormat == SDL_GPU_SHADERFORMAT_DXIL) {
+        // The translated HLSL already follows the SDL_GPU binding model, no need for another roundtrip
+        *code = SDL_ShaderCross_INTERNAL_CompileUsingDXC(
+            &hlslInfo,
+            false,
+            size);
+    } else { // MSL
+        *size = SDL_strlen(transpileContext->translated_source) + 1;
+        *code = SDL_malloc(*size);
+        if (*code != NULL) {
+            SDL_memcpy(*code, transpileContext->translated_source, *size);
+        }
+    }
+
+    if (*code == NULL) {
+        if (metadata != NULL) {
+            SDL_free(*metadata);
+            *metadata = NULL;
+        }
+        SDL_ShaderCross_INTERNAL_DestroyTranspileContext(transpileContext);
+        return NULL;
+    }
+
+    return transpileContext;
+}
+
+static void *SDL_ShaderCross_INTERNAL_CompileFromSPIRV(
+    SDL_GPUDevice *device,
+    const SDL_ShaderCross_SPIRV_Info *info,
+    SDL_GPUShaderFormat targetFormat,
+    const void *metadata
+) {
+    void *code;
+    size_t codeSize;
+
+    // The caller already reflected the shader, so only transpile here
+    SPIRVTranspileContext *transpileContext = SDL_ShaderCross_INTERNAL_CompileSPIRVToFormat(
+        info,
+        targetFormat,
+        &code,
+        &codeSize,
+        NULL);
+
+    if (transpileContext == NULL) {
+        return NULL;
+    }
+
+    void *shaderObject = NULL;
+
+    if (info->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+        const SDL_ShaderCross_ComputePipelineMetadata *pipelineInfo = (const SDL_ShaderCross_ComputePipelineMetadata *)metadata;
+        SDL_GPUComputePipelineCreateInfo createInfo;
+
+        createInfo.code = (const Uint8 *)code;
+        createInfo.code_size = codeSize;
+        createInfo.entrypoint = transpileContext->cleansed_entrypoint;
+        createInfo.format = targetFormat;
+        createInfo.num_samplers = pipelineInfo->num_samplers;
+        createInfo.num_readonly_storage_textures = pipelineInfo->num_readonly_storage_textures;
+        createInfo.num_readonly_storage_buffers = pipelineInfo->num_readonly_storage_buffers;
+        createInfo.num_readwrite_storage_textures = pipelineInfo->num_readwrite_storage_textures;
+        createInfo.num_readwrite_storage_buffers = pipelineInfo->num_readwrite_storage_buffers;
+        createInfo.num_uniform_buffers = pipelineInfo->num_uniform_buffers;
+        createInfo.threadcount_x = pipelineInfo->threadcount_x;
+        createInfo.threadcount_y = pipelineInfo->threadcount_y;
+        createInfo.threadcount_z = pipelineInfo->threadcount_z;
+
+        createInfo.props = 0;
+
+        const char *debugName = SDL_GetStringProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, NULL);
+        if (debugName) {
+            createInfo.props = SDL_CreateProperties();
+            SDL_SetStringProperty(createInfo.props, SDL_PROP_GPU_COMPUTEPIPELINE_CREATE_NAME_STRING, debugName);
+        }
+
+        shaderObject = SDL_CreateGPUComputePipeline(device, &createInfo);
+
+        if (createInfo.props != 0) {
+            SDL_DestroyProperties(createInfo.props);
+        }
+    } else {
+        const SDL_ShaderCross_GraphicsShaderResourceInfo *resourceInfo = (const SDL_ShaderCross_GraphicsShaderResourceInfo *)metadata;
+        SDL_GPUShaderCreateInfo createInfo;
+
+        createInfo.code = (const Uint8 *)code;
+        createInfo.code_size = codeSize;
+        createInfo.entrypoint = transpileContext->cleansed_entrypoint;
+        createInfo.format = targetFormat;
+        createInfo.stage = (SDL_GPUShaderStage)info->shader_stage;
+        createInfo.num_samplers = resourceInfo->num_samplers;
+        createInfo.num_storage_textures = resourceInfo->num_storage_textures;
+        createInfo.num_storage_buffers = resourceInfo->num_storage_buffers;
+        createInfo.num_uniform_buffers = resourceInfo->num_uniform_buffers;
+
+        createInfo.props = 0;
+
+        const char *debugName = SDL_GetStringProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, NULL);
+        if (debugName) {
+            createInfo.props = SDL_CreateProperties();
+            SDL_SetStringProperty(createInfo.props, SDL_PROP_GPU_SHADER_CREATE_NAME_STRING, debugName);
+        }
+
+        shaderObject = SDL_CreateGPUShader(device, &createInfo);
+
+        if (createInfo.props != 0) {
+            SDL_DestroyProperties(createInfo.props);
+        }
+    }
+
+    SDL_free(code);
+    SDL_ShaderCross_INTERNAL_DestroyTranspileContext(transpileContext);
+    return shaderObject;
+}
+
+void *SDL_ShaderCross_CompileAndReflectGraphicsSPIRV(
+    const SDL_ShaderCross_SPIRV_Info *info,
+    SDL_GPUShaderFormat format,
+    size_t *size,
+    SDL_ShaderCross_GraphicsShaderMetadata **metadata)
+{
+    void *code;
+
+    if (info == NULL) {
+        SDL_InvalidParamError("info");
+        return NULL;
+    }
+    if (size == NULL) {
+        SDL_InvalidParamError("size");
+        return NULL;
+    }
+    if (metadata == NULL) {
+        SDL_InvalidParamError("metadata");
+        return NULL;
+    }
+    if (info->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+        SDL_SetError("%s", "Use SDL_ShaderCross_CompileAndReflectComputeSPIRV for compute shaders");
+        return NULL;
+    }
+
+    SPIRVTranspileContext *transpileContext = SDL_ShaderCross_INTERNAL_CompileSPIRVToFormat(
+        info,
+        format,
+        &code,
+        size,
+        (void **)metadata);
+
+    if (transpileContext == NULL) {
+        return NULL;
+    }
+
+    SDL_ShaderCross_INTERNAL_DestroyTranspileContext(transpileContext);
+    return code;
+}
+
+void *SDL_ShaderCross_CompileAndReflectComputeSPIRV(
+    const SDL_ShaderCross_SPIRV_Info *info,
+    SDL_GPUShaderFormat format,
+    size_t *size,
+    SDL_ShaderCross_ComputePipelineMetadata **metadata)
+{
+    void *code;
+
+    if (info == NULL) {
+        SDL_InvalidParamError("info");
+        return NULL;
+    }
+    if (size == NULL) {
+        SDL_InvalidParamError("size");
+        return NULL;
+    }
+    if (metadata == NULL) {
+        SDL_InvalidParamError("metadata");
+        return NULL;
+    }
+    if (info->shader_stage != SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+        SDL_SetError("%s", "Use SDL_ShaderCross_CompileAndReflectGraphicsSPIRV for graphics shaders");
+        return NULL;
+    }
+
+    SPIRVTranspileContext *transpileContext = SDL_ShaderCross_INTERNAL_CompileSPIRVToFormat(
+        info,
+        format,
+        &code,
+        size,
+        (void **)metadata);
+
+    if (transpileContext == NULL) {
+        return NULL;
+    }
+
+    SDL_ShaderCross_INTERNAL_DestroyTranspileContext(transpileContext);
+    return code;
+}
+
+SDL_ShaderCross_SPIRVEntryPointOutput *SDL_ShaderCross_CompileSPIRVEntryPoint(
+    const SDL_ShaderCross_SPIRV_Info *info,
+    SDL_GPUShaderFormat format)
+{
+    void *code;
+    size_t codeSize;
+    void *metadata = NULL;
+
+    if (info == NULL) {
+        SDL_InvalidParamError("info");
+        return NULL;
+    }
+    if (info->entrypoint == NULL) {
+        SDL_InvalidParamError("info->entrypoint");
+        return NULL;
+    }
+
+    SPIRVTranspileContext *transpileContext = SDL_ShaderCross_INTERNAL_CompileSPIRVToFormat(
+        info,
+        format,
+        &code,
+        &codeSize,
+        &metadata);
+
+    if (transpileContext == NULL) {
+        return NULL;
+    }
+
+    // The entry point names are stored after the output, like SDL_ShaderCross_CompileAllSPIRVEntryPoints does
+    size_t spirvLength = SDL_strlen(info->entrypoint) + 1;
+    size_t length = SDL_strlen(transpileContext->cleansed_entrypoint) + 1;
+    SDL_ShaderCross_SPIRVEntryPointOutput *output = (SDL_ShaderCross_SPIRVEntryPointOutput *)SDL_malloc(sizeof(SDL_ShaderCross_SPIRVEntryPointOutput) + spirvLength + length);
+    if (output == NULL) {
+        SDL_free(code);
+        SDL_free(metadata);
+        SDL_ShaderCross_INTERNAL_DestroyTranspileContext(transpileContext);
+        return NULL;
+    }
+
+    char *names = (char *)(output + 1);
+    SDL_memcpy(names, info->entrypoint, spirvLength);
+    output->spirv_entrypoint = names;
+    SDL_memcpy(names + spirvLength, transpileContext->cleansed_entrypoint, length);
+    output->entrypoint = names + spirvLength;
+    SDL_ShaderCross_INTERNAL_DestroyTranspileContext(transpileContext);
+
+    output->shader_stage = info->shader_stage;
+    output->code = code;
+    output->code_size = codeSize;
+    if (info->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+        output->graphics_metadata = NULL;
+        output->compute_metadata = (SDL_ShaderCross_ComputePipelineMetadata *)metadata;
+    } else {
+        output->graphics_metadata = (SDL_ShaderCross_GraphicsShaderMetadata *)metadata;
+        output->compute_metadata = NULL;
+    }
+    return output;
+}
+
+typedef struct SPIRVEntryPointJob
+{
+    SDL_ShaderCross_SPIRV_Info info;
+    SDL_GPUShaderFormat format;
+    void *code;
+    size_t codeSize;
+    void *metadata;
+    char *cleansedEntrypoint;
+    char *error; // SDL errors are per-thread, so carry them back to the caller
+} SPIRVEntryPointJob;
+
+static int SDLCALL SDL_ShaderCross_INTERNAL_CompileSPIRVEntryPoint(void *data)
+{
+    SPIRVEntryPointJob *job = (SPIRVEntryPointJob *)data;
+
+    SPIRVTranspileContext *transpileContext = SDL_ShaderCross_INTERNAL_CompileSPIRVToFormat(
+        &job->info,
+        job->format,
+        &job->code,
+        &job->codeSize,
+        &job->metadata);
+
+    if (transpileContext == NULL) {
+        job->error = SDL_strdup(SDL_GetError());
+        return 0;
+    }
+
+    // The cleansed name lives in the SPIRV-Cross context, which goes away here
+    job->cleansedEntrypoint = SDL_strdup(transpileContext->cleansed_entrypoint);
+    SDL_ShaderCross_INTERNAL_DestroyTranspileContext(transpileContext);
+    if (job->cleansedEntrypoint == NULL) {
+        job->error = SDL_strdup(SDL_GetError());
+        return 0;
+    }
+    return 1;
+}
+
+SDL_ShaderCross_SPIRVEntryPointOutput *SDL_ShaderCross_CompileAllSPIRVEntryPoints(
+    const Uint8 *bytecode,
+    size_t bytecode_size,
+    SDL_PropertiesID props,
+    SDL_GPUShaderFormat format,
+    int *count)
+{
+    if (bytecode == NULL) {
+        SDL_InvalidParamError("bytecode");
         return NULL;
     }
+    if (count == NULL) {
+        SDL_InvalidParamError("count");
+        return NULL;
+    }
+    *count = 0;
 
-    SPIRVTranspileContext *transpileContext = SDL_ShaderCross_INTERNAL_TranspileFromSPIRV(
-        backend,
-        shadermodel,
-        info->shader_stage,
-        info->bytecode,
-        info->bytecode_size,
-        info->entrypoint,
-        info->props);
-
-    if (transpileContext == NULL) {
+    // Specialize and optimize once for every entry point
+    Uint32 *processed;
+    size_t processedSize;
+    if (!SDL_ShaderCross_INTERNAL_PreprocessSPIRV(bytecode, bytecode_size, props, &processed, &processedSize)) {
         return NULL;
     }
+    if (processed != NULL) {
+        bytecode = (const Uint8 *)processed;
+        bytecode_size = processedSize;
+    }
 
-    void *shaderObject = NULL;
+    spvc_context context;
+    spvc_compiler compiler;
+    spvc_resources resources;
+    if (!SDL_ShaderCross_INTERNAL_CreateReflectionCompiler(bytecode, bytecode_size, &context, &compiler, &resources)) {
+        SDL_free(processed);
+        return NULL;
+    }
 
-    if (info->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
-        SDL_ShaderCross_ComputePipelineMetadata *pipelineInfo = SDL_ShaderCross_ReflectComputeSPIRV(
-            info->bytecode,
-            info->bytecode_size,
-            metadataProps);
-        SDL_GPUComputePipelineCreateInfo createInfo;
+    const spvc_entry_point *entryPoints;
+    size_t numEntryPoints;
+    spvc_result result = spvc_compiler_get_entry_points(compiler, &entryPoints, &numEntryPoints);
+    if (result < 0) {
+        SPVC_ERROR(spvc_compiler_get_entry_points);
+        spvc_context_destroy(context);
+        SDL_free(processed);
+        return NULL;
+    }
 
-        createInfo.entrypoint = transpileContext->cleansed_entrypoint;
-        createInfo.format = targetFormat;
-        createInfo.num_samplers = pipelineInfo->num_samplers;
-        createInfo.num_readonly_storage_textures = pipelineInfo->num_readonly_storage_textures;
-        createInfo.num_readonly_storage_buffers = pipelineInfo->num_readonly_storage_buffers;
-        createInfo.num_readwrite_storage_textures = pipelineInfo->num_readwrite_storage_textures;
-        createInfo.num_readwrite_storage_buffers = pipelineInfo->num_readwrite_storage_buffers;
-        createInfo.num_uniform_buffers = pipelineInfo->num_uniform_buffers;
-        createInfo.threadcount_x = pipelineInfo->threadcount_x;
-        createInfo.threadcount_y = pipelineInfo->threadcount_y;
-        createInfo.threadcount_z = pipelineInfo->threadcount_z;
+    SPIRVEntryPointJob *jobs = (SPIRVEntryPointJob *)SDL_calloc(SDL_max(numEntryPoints, 1), sizeof(SPIRVEntryPointJob));
+    if (jobs == NULL) {
+        spvc_context_destroy(context);
+        SDL_free(processed);
+        return NULL;
+    }
 
-        createInfo.props = 0;
+    // The preprocessed module is already specialized and optimized, don't redo it for every job
+    SDL_PropertiesID jobProps = 0;
+    if (props != 0) {
+        jobProps = SDL_CreateProperties();
+        if (jobProps == 0 || !SDL_CopyProperties(props, jobProps)) {
+            SDL_DestroyProperties(jobProps);
+            SDL_free(jobs);
+            spvc_context_destroy(context);
+            SDL_free(processed);
+            return NULL;
+        }
+        SDL_ClearProperty(jobProps, SDL_SHADERCROSS_PROP_SPIRV_SPECIALIZATION_CONSTANTS_POINTER);
+        SDL_ClearProperty(jobProps, SDL_SHADERCROSS_PROP_SPIRV_NUM_SPECIALIZATION_CONSTANTS_NUMBER);
+        SDL_ClearProperty(jobProps, SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER);
+    }
 
-        const char *debugName = SDL_GetStringProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, NULL);
-        if (debugName) {
-            createInfo.props = SDL_CreateProperties();
-            SDL_SetStringProperty(createInfo.props, SDL_PROP_GPU_COMPUTEPIPELINE_CREATE_NAME_STRING, debugName);
+    int numJobs = 0;
+    bool failed = false;
+    for (size_t i = 0; i < numEntryPoints; i += 1) {
+        SDL_ShaderCross_ShaderStage stage;
+        if (entryPoints[i].execution_model == SpvExecutionModelVertex) {
+            stage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
+        } else if (entryPoints[i].execution_model == SpvExecutionModelFragment) {
+            stage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
+        } else if (entryPoints[i].execution_model == SpvExecutionModelGLCompute) {
+            stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
+        } else {
+            // SDL_GPU has no use for the other stages
+            continue;
         }
 
-        SDL_ShaderCross_HLSL_Info hlslInfo;
-        hlslInfo.source = transpileContext->translated_source;
-        hlslInfo.entrypoint = transpileContext->cleansed_entrypoint;
-        hlslInfo.include_dir = NULL;
-        hlslInfo.defines = NULL;
-        hlslInfo.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
-        hlslInfo.props = info->props;
-
-        if (targetFormat == SDL_GPU_SHADERFORMAT_DXBC) {
-            createInfo.code = SDL_ShaderCross_INTERNAL_CompileDXBCFromHLSL(
-                &hlslInfo,
-                false,
-                &createInfo.code_size);
-        } else if (targetFormat == SDL_GPU_SHADERFORMAT_DXIL) {
-            createInfo.code = SDL_ShaderCross_CompileDXILFromHLSL(
-                &hlslInfo,
-                &createInfo.code_size);
-        } else { // MSL
-            createInfo.code = (const Uint8 *)transpileContext->translated_source;
-            createInfo.code_size = SDL_strlen(transpileContext->translated_source) + 1;
+        SPIRVEntryPointJob *job = &jobs[numJobs];
+        job->info.bytecode = bytecode;
+        job->info.bytecode_size = bytecode_size;
+        job->info.entrypoint = SDL_strdup(entryPoints[i].name);
+        job->info.shader_stage = stage;
+        job->info.props = jobProps;
+        job->format = format;
+        numJobs += 1;
+        if (job->info.entrypoint == NULL) {
+            failed = true;
+            break;
         }
+    }
 
-        shaderObject = SDL_CreateGPUComputePipeline(device, &createInfo);
+    // Each job parses its own copy of the IR, SPIRV-Cross contexts can't be shared between threads
+    spvc_context_destroy(context);
 
-        if (createInfo.props != 0) {
-            SDL_DestroyProperties(createInfo.props);
-        }
-        SDL_free(pipelineInfo);
-    } else {
-        SDL_GPUShaderCreateInfo createInfo;
-        SDL_ShaderCross_GraphicsShaderMetadata *shaderInfo =
-            SDL_ShaderCross_ReflectGraphicsSPIRV(
-                info->bytecode,
-                info->bytecode_size,
-                metadataProps);
-
-        if (shaderInfo == NULL) {
-            SDL_ShaderCross_INTERNAL_DestroyTranspileContext(transpileContext);
-            return NULL;
-        }
-        createInfo.entrypoint = transpileContext->cleansed_entrypoint;
-        createInfo.format = targetFormat;
-        createInfo.stage = (SDL_GPUShaderStage)info->shader_stage;
-        createInfo.num_samplers = shaderInfo->resource_info.num_samplers;
-        createInfo.num_storage_textures = shaderInfo->resource_info.num_storage_textures;
-        createInfo.num_storage_buffers = shaderInfo->resource_info.num_storage_buffers;
-        createInfo.num_uniform_buffers = shaderInfo->resource_info.num_uniform_buffers;
+    if (!failed) {
+        int maxThreads = SDL_max(SDL_GetNumLogicalCPUCores(), 1);
+        SDL_Thread **threads = (SDL_Thread **)SDL_calloc(SDL_max(numJobs, 1), sizeof(SDL_Thread *));
 
-        createInfo.props = 0;
+        for (int start = 0; start < numJobs; start += maxThreads) {
+            int end = SDL_min(start + maxThreads, numJobs);
 
-        const char *debugName = SDL_GetStringProperty(info->props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, NULL);
-        if (debugName) {
-            createInfo.props = SDL_CreateProperties();
-            SDL_SetStringProperty(createInfo.props, SDL_PROP_GPU_SHADER_CREATE_NAME_STRING, debugName);
+            // The last job of a batch runs on the calling thread
+            for (int i = start; i < end - 1 && threads != NULL; i += 1) {
+                threads[i] = SDL_CreateThread(SDL_ShaderCross_INTERNAL_CompileSPIRVEntryPoint, "SDL_shadercross", &jobs[i]);
+            }
+            for (int i = start; i < end; i += 1) {
+                if (threads == NULL || threads[i] == NULL) {
+                    SDL_ShaderCross_INTERNAL_CompileSPIRVEntryPoint(&jobs[i]);
+                }
+            }
+            for (int i = start; i < end && threads != NULL; i += 1) {
+                if (threads[i] != NULL) {
+                    SDL_WaitThread(threads[i], NULL);
+                }
+            }
         }
+        SDL_free(threads);
+    }
+
+    SDL_DestroyProperties(jobProps);
+    SDL_free(processed);
 
-        SDL_ShaderCross_HLSL_Info hlslInfo;
-        hlslInfo.source = transpileContext->translated_source;
-        hlslInfo.entrypoint = transpileContext->cleansed_entrypoint;
-        hlslInfo.include_dir = NULL;
-        hlslInfo.defines = NULL;
-        hlslInfo.shader_stage = info->shader_stage;
-        hlslInfo.props = info->props;
-
-        if (targetFormat == SDL_GPU_SHADERFORMAT_DXBC) {
-            createInfo.code = SDL_ShaderCross_INTERNAL_CompileDXBCFromHLSL(
-                &hlslInfo,
-                false,
-                &createInfo.code_size);
-        } else if (targetFormat == SDL_GPU_SHADERFORMAT_DXIL) {
-            createInfo.code = SDL_ShaderCross_CompileDXILFromHLSL(
-                &hlslInfo,
-                &createInfo.code_size);
-        } else { // MSL
-            createInfo.code = (const Uint8 *)transpileContext->translated_source;
-            createInfo.code_size = SDL_strlen(transpileContext->translated_source) + 1;
+    // Pack the results, with the entry point names stored after the array
+    size_t namesLength = 0;
+    for (int i = 0; i < numJobs; i += 1) {
+        if (jobs[i].info.entrypoint == NULL || jobs[i].cleansedEntrypoint == NULL) {
+            if (!failed && jobs[i].error != NULL) {
+                SDL_SetError("%s: %s", jobs[i].info.entrypoint, jobs[i].error);
+            }
+            failed = true;
+            continue;
         }
+        namesLength += SDL_strlen(jobs[i].info.entrypoint) + 1;
+        namesLength += SDL_strlen(jobs[i].cleansedEntrypoint) + 1;
+    }
 
-        shaderObject = SDL_CreateGPUShader(device, &createInfo);
+    SDL_ShaderCross_SPIRVEntryPointOutput *outputs = NULL;
+    if (!failed) {
+        outputs = (SDL_ShaderCross_SPIRVEntryPointOutput *)SDL_malloc(SDL_max(numJobs, 1) * sizeof(SDL_ShaderCross_SPIRVEntryPointOutput) + namesLength);
+    }
 
-        if (createInfo.props != 0) {
-            SDL_DestroyProperties(createInfo.props);
+    if (outputs != NULL) {
+        char *names = (char *)(outputs + numJobs);
+        for (int i = 0; i < numJobs; i += 1) {
+            SDL_ShaderCross_SPIRVEntryPointOutput *output = &outputs[i];
+            size_t length;
+
+            length = SDL_strlen(jobs[i].info.entrypoint) + 1;
+            SDL_memcpy(names, jobs[i].info.entrypoint, length);
+            output->spirv_entrypoint = names;
+            names += length;
+
+            length = SDL_strlen(jobs[i].cleansedEntrypoint) + 1;
+            SDL_memcpy(names, jobs[i].cleansedEntrypoint, length);
+            output->entrypoint = names;
+            names += length;
+
+            output->shader_stage = jobs[i].info.shader_stage;
+            output->code = jobs[i].code;
+            output->code_size = jobs[i].codeSize;
+            if (output->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+                output->graphics_metadata = NULL;
+                output->compute_metadata = (SDL_ShaderCross_ComputePipelineMetadata *)jobs[i].metadata;
+            } else {
+                output->graphics_metadata = (SDL_ShaderCross_GraphicsShaderMetadata *)jobs[i].metadata;
+                output->compute_metadata = NULL;
+            }
+        }
+        *count = numJobs;
+    } else {
+        for (int i = 0; i < numJobs; i += 1) {
+            SDL_free(jobs[i].code);
+            SDL_free(jobs[i].metadata);
         }
-
-        SDL_free(shaderInfo);
     }
 
-    SDL_ShaderCross_INTERNAL_DestroyTranspileContext(transpileContext);
-    return shaderObject;
+    for (int i = 0; i < numJobs; i += 1) {
+        SDL_free((void *)jobs[i].info.entrypoint);
+        SDL_free(jobs[i].cleansedEntrypoint);
+        SDL_free(jobs[i].error);
+    }
+    SDL_free(jobs);
+    return outputs;
 }
 
 void *SDL_ShaderCross_TranspileMSLFromSPIRV(
@@ -2319,7 +4341,8 @@ void *SDL_ShaderCross_TranspileMSLFromSPIRV(
         info->bytecode,
         info->bytecode_size,
         info->entrypoint,
-        info->props
+        info->props,
+        NULL
     );
 
     if (context == NULL) {
@@ -2334,22 +4357,19 @@ void *SDL_ShaderCross_TranspileMSLFromSPIRV(
     return result;
 }
 
-void *SDL_ShaderCross_TranspileHLSLFromSPIRV(
-    const SDL_ShaderCross_SPIRV_Info *info)
+static char *SDL_ShaderCross_INTERNAL_TranspileHLSLFromSPIRV(
+    const SDL_ShaderCross_SPIRV_Info *info,
+    unsigned shadermodel)
 {
-    if (info == NULL) {
-        SDL_InvalidParamError("info");
-        return NULL;
-    }
-
     SPIRVTranspileContext *context = SDL_ShaderCross_INTERNAL_TranspileFromSPIRV(
         SPVC_BACKEND_HLSL,
-        SDL_GetBooleanProperty(info->props, SDL_SHADERCROSS_PROP_SPIRV_PSSL_COMPATIBILITY_BOOLEAN, false) ? 50 : 60,
+        shadermodel,
         info->shader_stage,
         info->bytecode,
         info->bytecode_size,
         info->entrypoint,
-        info->props
+        info->props,
+        NULL
     );
 
     if (context == NULL) {
@@ -2364,6 +4384,23 @@ void *SDL_ShaderCross_TranspileHLSLFromSPIRV(
     return result;
 }
 
+void *SDL_ShaderCross_TranspileHLSLFromSPIRV(
+    const SDL_ShaderCross_SPIRV_Info *info)
+{
+    if (info == NULL) {
+        SDL_InvalidParamError("info");
+        return NULL;
+    }
+
+    unsigned shadermodel = 50;
+    if (!SDL_GetBooleanProperty(info->props, SDL_SHADERCROSS_PROP_SPIRV_PSSL_COMPATIBILITY_BOOLEAN, false) &&
+        !SDL_ShaderCross_INTERNAL_GetDXILShaderModel(info->props, &shadermodel)) {
+        return NULL;
+    }
+
+    return SDL_ShaderCross_INTERNAL_TranspileHLSLFromSPIRV(info, shadermodel);
+}
+
 void *SDL_ShaderCross_CompileDXBCFromSPIRV(
     const SDL_ShaderCross_SPIRV_Info *info,
     size_t *size)
@@ -2380,7 +4417,8 @@ void *SDL_ShaderCross_CompileDXBCFromSPIRV(
         info->bytecode,
         info->bytecode_size,
         info->entrypoint,
-        info->props);
+        info->props,
+        NULL);
 
     if (context == NULL) {
         return NULL;
@@ -2417,14 +4455,20 @@ void *SDL_ShaderCross_CompileDXILFromSPIRV(
         return NULL;
     }
 
+    unsigned shadermodel;
+    if (!SDL_ShaderCross_INTERNAL_GetDXILShaderModel(info->props, &shadermodel)) {
+        return NULL;
+    }
+
     SPIRVTranspileContext *context = SDL_ShaderCross_INTERNAL_TranspileFromSPIRV(
         SPVC_BACKEND_HLSL,
-        60,
+        shadermodel,
         info->shader_stage,
         info->bytecode,
         info->bytecode_size,
         info->entrypoint,
-        info->props);
+        info->props,
+        NULL);
 
     if (context == NULL) {
         return NULL;
@@ -2454,6 +4498,7 @@ static void *SDL_ShaderCross_INTERNAL_CreateShaderFromSPIRV(
     SDL_PropertiesID metadataProps)
 {
     SDL_GPUShaderFormat format;
+    (void) metadataProps;
 
     SDL_GPUShaderFormat shader_formats = SDL_GetGPUShaderFormats(device);
 
@@ -2541,7 +4586,7 @@ static void *SDL_ShaderCross_INTERNAL_CreateShaderFromSPIRV(
         device,
         info,
         format,
-        metadataProps);
+        metadata);
 }
 
 SDL_GPUShader *SDL_ShaderCross_CompileGraphicsShaderFromSPIRV(
@@ -2660,3 +4705,372 @@ SDL_GPUShaderFormat SDL_ShaderCross_GetHLSLShaderFormats(void)
 
     return supportedFormats;
 }
+
+/* Shader Bundles */
+
+#if defined(SDL_PLATFORM_UNIX) || defined(SDL_PLATFORM_APPLE)
+#define SDL_SHADERCROSS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct SDL_ShaderCross_Bundle
+{
+    SDL_GPUDevice *device;
+    SDL_GPUShaderFormat deviceFormats;
+    const Uint8 *data;
+    size_t size;
+    void *ownedData;  /* SDL_LoadFile'd, freed on close */
+    void *mappedData; /* mmap'd, unmapped on close */
+    Uint32 numEntries;
+    Uint64 entriesOffset;
+    const char *strings;
+    Uint64 stringsSize;
+    SDL_Mutex *lock;
+    void **objects;   /* the shader or pipeline created for each entry, NULL until requested */
+};
+
+static Uint64 SDL_ShaderCross_INTERNAL_HashBundleName(const char *name)
+{
+    Uint64 hash = 0xcbf29ce484222325ULL;
+    for (const Uint8 *c = (const Uint8 *)name; *c != '\0'; c += 1) {
+        hash = (hash ^ *c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/* The data may be unaligned when it comes from memory, so entries are copied out */
+static void SDL_ShaderCross_INTERNAL_ReadBundleEntry(
+    const SDL_ShaderCross_Bundle *bundle,
+    Uint32 index,
+    SDL_ShaderCross_BundleEntry *entry)
+{
+    SDL_memcpy(entry, bundle->data + bundle->entriesOffset + (Uint64)index * sizeof(SDL_ShaderCross_BundleEntry), sizeof(*entry));
+    entry->hash = SDL_Swap64LE(entry->hash);
+    entry->code_offset = SDL_Swap64LE(entry->code_offset);
+    entry->code_size = SDL_Swap64LE(entry->code_size);
+    entry->name_offset = SDL_Swap32LE(entry->name_offset);
+    entry->entrypoint_offset = SDL_Swap32LE(entry->entrypoint_offset);
+    entry->format = SDL_Swap32LE(entry->format);
+    entry->shader_stage = SDL_Swap32LE(entry->shader_stage);
+    entry->num_samplers = SDL_Swap32LE(entry->num_samplers);
+    entry->num_readonly_storage_textures = SDL_Swap32LE(entry->num_readonly_storage_textures);
+    entry->num_readonly_storage_buffers = SDL_Swap32LE(entry->num_readonly_storage_buffers);
+    entry->num_readwrite_storage_textures = SDL_Swap32LE(entry->num_readwrite_storage_textures);
+    entry->num_readwrite_storage_buffers = SDL_Swap32LE(entry->num_readwrite_storage_buffers);
+    entry->num_uniform_buffers = SDL_Swap32LE(entry->num_uniform_buffers);
+    entry->threadcount_x = SDL_Swap32LE(entry->threadcount_x);
+    entry->threadcount_y = SDL_Swap32LE(entry->threadcount_y);
+    entry->threadcount_z = SDL_Swap32LE(entry->threadcount_z);
+}
+
+/* Only the header is read up front, entries are checked when they are looked up */
+static bool SDL_ShaderCross_INTERNAL_InitBundle(SDL_ShaderCross_Bundle *bundle)
+{
+    SDL_ShaderCross_BundleHeader header;
+
+    if (bundle->size < sizeof(header)) {
+        return SDL_SetError("%s", "Shader bundle is truncated");
+    }
+    SDL_memcpy(&header, bundle->data, sizeof(header));
+
+    if (SDL_Swap32LE(header.magic) != SDL_SHADERCROSS_BUNDLE_MAGIC) {
+        return SDL_SetError("%s", "Not a shader bundle");
+    }
+    if (SDL_Swap32LE(header.version) != SDL_SHADERCROSS_BUNDLE_VERSION) {
+        return SDL_SetError("Unsupported shader bundle version %u", (unsigned int)SDL_Swap32LE(header.version));
+    }
+    if (SDL_Swap32LE(header.entry_size) != sizeof(SDL_ShaderCross_BundleEntry)) {
+        return SDL_SetError("%s", "Unsupported shader bundle entry size");
+    }
+
+    bundle->numEntries = SDL_Swap32LE(header.num_entries);
+    bundle->entriesOffset = SDL_Swap64LE(header.entries_offset);
+    Uint64 stringsOffset = SDL_Swap64LE(header.strings_offset);
+    bundle->stringsSize = SDL_Swap64LE(header.strings_size);
+
+    if (bundle->entriesOffset > bundle->size ||
+        (bundle->size - bundle->entriesOffset) / sizeof(SDL_ShaderCross_BundleEntry) < bundle->numEntries ||
+        stringsOffset > bundle->size ||
+        bundle->size - stringsOffset < bundle->stringsSize) {
+        return SDL_SetError("%s", "Shader bundle is truncated");
+    }
+    bundle->strings = (const char *)bundle->data + stringsOffset;
+
+    /* A terminated table means every in-range offset is a terminated string */
+    if (bundle->numEntries > 0 && (bundle->stringsSize == 0 || bundle->strings[bundle->stringsSize - 1] != '\0')) {
+        return SDL_SetError("%s", "Shader bundle string table is not terminated");
+    }
+
+    bundle->objects = (void **)SDL_calloc(SDL_max(bundle->numEntries, 1), sizeof(void *));
+    if (bundle->objects == NULL) {
+        return false;
+    }
+    bundle->lock = SDL_CreateMutex();
+    if (bundle->lock == NULL) {
+        return false;
+    }
+
+    bundle->deviceFormats = SDL_GetGPUShaderFormats(bundle->device);
+    return true;
+}
+
+SDL_ShaderCross_Bundle *SDL_ShaderCross_OpenBundleFromMemory(
+    SDL_GPUDevice *device,
+    const void *data,
+    size_t size)
+{
+    if (device == NULL) {
+        SDL_InvalidParamError("device");
+        return NULL;
+    }
+    if (data == NULL) {
+        SDL_InvalidParamError("data");
+        return NULL;
+    }
+
+    SDL_ShaderCross_Bundle *bundle = (SDL_ShaderCross_Bundle *)SDL_calloc(1, sizeof(SDL_ShaderCross_Bundle));
+    if (bundle == NULL) {
+        return NULL;
+    }
+    bundle->device = device;
+    bundle->data = (const Uint8 *)data;
+    bundle->size = size;
+
+    if (!SDL_ShaderCross_INTERNAL_InitBundle(bundle)) {
+        SDL_ShaderCross_CloseBundle(bundle);
+        return NULL;
+    }
+    return bundle;
+}
+
+SDL_ShaderCross_Bundle *SDL_ShaderCross_OpenBundle(
+    SDL_GPUDevice *device,
+    const char *path)
+{
+    if (device == NULL) {
+        SDL_InvalidParamError("device");
+        return NULL;
+    }
+    if (path == NULL) {
+        SDL_InvalidParamError("path");
+        return NULL;
+    }
+
+    SDL_ShaderCross_Bundle *bundle = (SDL_ShaderCross_Bundle *)SDL_calloc(1, sizeof(SDL_ShaderCross_Bundle));
+    if (bundle == NULL) {
+        return NULL;
+    }
+    bundle->device = device;
+
+#ifdef SDL_SHADERCROSS_MMAP
+    /* Mapping the file only pages in the header and the shaders that are actually created */
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+        void *mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            bundle->mappedData = mapped;
+            bundle->data = (const Uint8 *)mapped;
+            bundle->size = (size_t)info.st_size;
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+
+    if (bundle->data == NULL) {
+        bundle->ownedData = SDL_LoadFile(path, &bundle->size);
+        if (bundle->ownedData == NULL) {
+            SDL_ShaderCross_CloseBundle(bundle);
+            return NULL;
+        }
+        bundle->data = (const Uint8 *)bundle->ownedData;
+    }
+
+    if (!SDL_ShaderCross_INTERNAL_InitBundle(bundle)) {
+        SDL_ShaderCross_CloseBundle(bundle);
+        return NULL;
+    }
+    return bundle;
+}
+
+/* Finds the entry of name in the best format the device takes, returns the index or -1 */
+static Sint64 SDL_ShaderCross_INTERNAL_FindBundleEntry(
+    SDL_ShaderCross_Bundle *bundle,
+    const char *name,
+    SDL_ShaderCross_BundleEntry *result)
+{
+    Uint64 hash = SDL_ShaderCross_INTERNAL_HashBundleName(name);
+    SDL_ShaderCross_BundleEntry entry;
+    Uint32 low = 0;
+    Uint32 high = bundle->numEntries;
+    Sint64 found = -1;
+
+    /* Lower bound of the hash */
+    while (low < high) {
+        Uint32 middle = low + (high - low) / 2;
+        SDL_ShaderCross_INTERNAL_ReadBundleEntry(bundle, middle, &entry);
+        if (entry.hash < hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    /* Formats of a name are sorted by value, so the last match prefers DXIL over DXBC */
+    for (Uint32 i = low; i < bundle->numEntries; i += 1) {
+        SDL_ShaderCross_INTERNAL_ReadBundleEntry(bundle, i, &entry);
+        if (entry.hash != hash) {
+            break;
+        }
+        if (entry.name_offset >= bundle->stringsSize ||
+            entry.entrypoint_offset >= bundle->stringsSize ||
+            entry.shader_stage > SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+            SDL_SetError("Shader bundle entry %u is corrupt", (unsigned int)i);
+            return -1;
+        }
+        if (SDL_strcmp(bundle->strings + entry.name_offset, name) == 0 && (entry.format & bundle->deviceFormats) != 0) {
+            found = i;
+            SDL_copyp(result, &entry);
+        }
+    }
+
+    if (found < 0) {
+        SDL_SetError("Shader bundle has no %s in a format the device supports", name);
+        return -1;
+    }
+    if (result->code_offset > bundle->size || bundle->size - result->code_offset < result->code_size) {
+        SDL_SetError("Shader bundle entry %s is truncated", name);
+        return -1;
+    }
+    return found;
+}
+
+static void *SDL_ShaderCross_INTERNAL_GetBundleObject(
+    SDL_ShaderCross_Bundle *bundle,
+    const char *name,
+    bool compute)
+{
+    SDL_ShaderCross_BundleEntry entry;
+
+    if (bundle == NULL) {
+        SDL_InvalidParamError("bundle");
+        return NULL;
+    }
+    if (name == NULL) {
+        SDL_InvalidParamError("name");
+        return NULL;
+    }
+
+    Sint64 index = SDL_ShaderCross_INTERNAL_FindBundleEntry(bundle, name, &entry);
+    if (index < 0) {
+        return NULL;
+    }
+    if ((entry.shader_stage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) != compute) {
+        SDL_SetError("%s is not a %s shader", name, compute ? "compute" : "graphics");
+        return NULL;
+    }
+
+    SDL_LockMutex(bundle->lock);
+
+    void *shaderObject = bundle->objects[index];
+    if (shaderObject == NULL) {
+        if (compute) {
+            SDL_GPUComputePipelineCreateInfo createInfo;
+
+            createInfo.code = bundle->data + entry.code_offset;
+            createInfo.code_size = (size_t)entry.code_size;
+            createInfo.entrypoint = bundle->strings + entry.entrypoint_offset;
+            createInfo.format = entry.format;
+            createInfo.num_samplers = entry.num_samplers;
+            createInfo.num_readonly_storage_textures = entry.num_readonly_storage_textures;
+            createInfo.num_readonly_storage_buffers = entry.num_readonly_storage_buffers;
+            createInfo.num_readwrite_storage_textures = entry.num_readwrite_storage_textures;
+            createInfo.num_readwrite_storage_buffers = entry.num_readwrite_storage_buffers;
+            createInfo.num_uniform_buffers = entry.num_uniform_buffers;
+            createInfo.threadcount_x = entry.threadcount_x;
+            createInfo.threadcount_y = entry.threadcount_y;
+            createInfo.threadcount_z = entry.threadcount_z;
+
+            createInfo.props = SDL_CreateProperties();
+            SDL_SetStringProperty(createInfo.props, SDL_PROP_GPU_COMPUTEPIPELINE_CREATE_NAME_STRING, name);
+
+            shaderObject = SDL_CreateGPUComputePipeline(bundle->device, &createInfo);
+            SDL_DestroyProperties(createInfo.props);
+        } else {
+            SDL_GPUShaderCreateInfo createInfo;
+
+            createInfo.code = bundle->data + entry.code_offset;
+            createInfo.code_size = (size_t)entry.code_size;
+            createInfo.entrypoint = bundle->strings + entry.entrypoint_offset;
+            createInfo.format = entry.format;
+            createInfo.stage = (SDL_GPUShaderStage)entry.shader_stage;
+            createInfo.num_samplers = entry.num_samplers;
+            createInfo.num_storage_textures = entry.num_readonly_storage_textures;
+            createInfo.num_storage_buffers = entry.num_readonly_storage_buffers;
+            createInfo.num_uniform_buffers = entry.num_uniform_buffers;
+
+            createInfo.props = SDL_CreateProperties();
+            SDL_SetStringProperty(createInfo.props, SDL_PROP_GPU_SHADER_CREATE_NAME_STRING, name);
+
+            shaderObject = SDL_CreateGPUShader(bundle->device, &createInfo);
+            SDL_DestroyProperties(createInfo.props);
+        }
+        bundle->objects[index] = shaderObject;
+    }
+
+    SDL_UnlockMutex(bundle->lock);
+    return shaderObject;
+}
+
+SDL_GPUShader *SDL_ShaderCross_GetBundleGraphicsShader(
+    SDL_ShaderCross_Bundle *bundle,
+    const char *name)
+{
+    return (SDL_GPUShader *)SDL_ShaderCross_INTERNAL_GetBundleObject(bundle, name, false);
+}
+
+SDL_GPUComputePipeline *SDL_ShaderCross_GetBundleComputePipeline(
+    SDL_ShaderCross_Bundle *bundle,
+    const char *name)
+{
+    return (SDL_GPUComputePipeline *)SDL_ShaderCross_INTERNAL_GetBundleObject(bundle, name, true);
+}
+
+void SDL_ShaderCross_CloseBundle(SDL_ShaderCross_Bundle *bundle)
+{
+    if (bundle == NULL) {
+        return;
+    }
+
+    if (bundle->objects != NULL) {
+        for (Uint32 i = 0; i < bundle->numEntries; i += 1) {
+            if (bundle->objects[i] == NULL) {
+                continue;
+            }
+            SDL_ShaderCross_BundleEntry entry;
+            SDL_ShaderCross_INTERNAL_ReadBundleEntry(bundle, i, &entry);
+            if (entry.shader_stage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+                SDL_ReleaseGPUComputePipeline(bundle->device, (SDL_GPUComputePipeline *)bundle->objects[i]);
+            } else {
+                SDL_ReleaseGPUShader(bundle->device, (SDL_GPUShader *)bundle->objects[i]);
+            }
+        }
+        SDL_free(bundle->objects);
+    }
+    if (bundle->lock != NULL) {
+        SDL_DestroyMutex(bundle->lock);
+    }
+
+#ifdef SDL_SHADERCROSS_MMAP
+    if (bundle->mappedData != NULL) {
+        munmap(bundle->mappedData, bundle->size);
+    }
+#endif
+    SDL_free(bundle->ownedData);
+    SDL_free(bundle);
+}
@@ -19,12 +19,45 @@
   3. This notice may not be removed or altered from any source distribution.
 */
 
+#ifdef __linux__
+#define _GNU_SOURCE // for struct ucred
+#endif
+
 #include <SDL3_shadercross/SDL_shadercross.h>
 #include <SDL3/SDL_log.h>
 #include <SDL3/SDL_iostream.h>
+#include <SDL3/SDL_filesystem.h>
 #ifdef LEAKCHECK
 #include <SDL3/SDL_test_memory.h>
 #endif
+#include <stdio.h>
+
+#ifdef SDL_PLATFORM_WINDOWS
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#if defined(SDL_PLATFORM_UNIX) || defined(SDL_PLATFORM_APPLE)
+#define SHADERCROSS_MMAP_INPUT
+#define SHADERCROSS_SERVER
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#ifdef SDL_PLATFORM_LINUX
+#define SHADERCROSS_WATCH
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
 
 // We can emit HLSL and JSON as a destination, so let's redefine the shader format enum.
 typedef enum ShaderCross_DestinationFormat {
@@ -41,21 +74,257 @@ void print_help(void)
 {
     int column_width = 32;
     SDL_Log("Usage: shadercross <input> [options]");
+    SDL_Log("The input may be - to read the standard input, the source format and stage can't be inferred then.");
     SDL_Log("Required options:\n");
     SDL_Log("  %-*s %s", column_width, "-s | --source <value>", "Source language format. May be inferred from the filename. Values: [SPIRV, HLSL]");
     SDL_Log("  %-*s %s", column_width, "-d | --dest <value>", "Destination format. May be inferred from the filename. Values: [DXBC, DXIL, MSL, SPIRV, HLSL, JSON]");
+    SDL_Log("  %-*s %s", column_width, "", "With --embed, a comma-separated list of DXBC, DXIL, MSL and SPIRV.");
     SDL_Log("  %-*s %s", column_width, "-t | --stage <value>", "Shader stage. May be inferred from the filename. Values: [vertex, fragment, compute]");
     SDL_Log("  %-*s %s", column_width, "-e | --entrypoint <value>", "Entrypoint function name. Default: \"main\".");
-    SDL_Log("  %-*s %s", column_width, "-o | --output <value>", "Output file.");
+    SDL_Log("  %-*s %s", column_width, "-o | --output <value>", "Output file, or - for the standard output.");
     SDL_Log("\n");
     SDL_Log("Optional options:\n");
     SDL_Log("  %-*s %s", column_width, "-I | --include <value>", "HLSL include directory. Only used with HLSL source.");
     SDL_Log("  %-*s %s", column_width, "-D<name>[=<value>]", "HLSL define. Only used with HLSL source. Can be repeated.");
     SDL_Log("  %-*s %s", column_width, "", "If =<value> is omitted the define will be treated as equal to 1.");
-    SDL_Log("  %-*s %s", column_width, "--msl-version <value>", "Target MSL version. Only used when transpiling to MSL. The default is 1.2.0.");
+    SDL_Log("  %-*s %s", column_width, "-MD", "Write a Makefile dependency file listing the input and every file it included. Defaults to <output>.d.");
+    SDL_Log("  %-*s %s", column_width, "-MF <value>", "Dependency file to write. Implies -MD.");
+    SDL_Log("  %-*s %s", column_width, "--shader-model <value>", "Target DXIL shader model, e.g. 6.5. Used for DXC profiles and HLSL output. The default is 6.0.");
+    SDL_Log("  %-*s %s", column_width, "--enable-16bit-types", "Compile half and min precision types as native 16-bit types. Implies shader model 6.2 for DXIL.");
+    SDL_Log("  %-*s %s", column_width, "--msl-version <value>", "Target MSL version. Only used when transpiling to MSL. The default is 1.2.0, or 2.0.0 with argument buffers.");
+    SDL_Log("  %-*s %s", column_width, "--msl-argument-buffers", "Gather the textures, samplers and storage buffers of each descriptor set in an MSL argument buffer.");
     SDL_Log("  %-*s %s", column_width, "-c | --cull", "Allow the compiler to cull unused resource bindings. This may lead to surprising binding behavior so be careful when enabling this!");
     SDL_Log("  %-*s %s", column_width, "-g | --debug", "Generate debug information when possible. Shaders are valid only when graphics debuggers are attached.");
     SDL_Log("  %-*s %s", column_width, "-p | --pssl", "Generate PSSL-compatible shader. Destination format should be HLSL.");
+    SDL_Log("  %-*s %s", column_width, "--roundtrip <value>", "When to go through SPIRV for HLSL to DXBC/DXIL. Values: [always, auto, never]. Default: always.");
+    SDL_Log("  %-*s %s", column_width, "", "never requires the source to already follow the SDL_GPU register conventions.");
+    SDL_Log("  %-*s %s", column_width, "-O | -Os", "Optimize SPIRV for performance or for size. Requires SPIRV-Tools support.");
+    SDL_Log("  %-*s %s", column_width, "-O0 | -O1 | -O2 | -O3", "DXC and FXC optimization level. Default: the compiler's default.");
+    SDL_Log("  %-*s %s", column_width, "", "-O0 skips optimization entirely, including SPIRV optimization.");
+    SDL_Log("  %-*s %s", column_width, "--strip", "Strip names, line info and non-semantic instructions from SPIRV output. May be used with SPIRV source.");
+    SDL_Log("  %-*s %s", column_width, "--embed", "Write a C header with the shader as an aligned array and the SDL_GPU create info to use it with.");
+    SDL_Log("  %-*s %s", column_width, "--embed-name <value>", "Prefix of the identifiers in the C header. Default: the input file name without its extension.");
+    SDL_Log("  %-*s %s", column_width, "--mem-stats", "Print allocation counts and peak memory usage of each compilation stage.");
+    SDL_Log("  %-*s %s", column_width, "--time", "Print the wall and CPU time of each compilation stage. Manifest builds sum them and list the slowest shaders.");
+    SDL_Log("  %-*s %s", column_width, "--trace <value>", "Write a Chrome trace event file with the stages of every compilation on every thread, for chrome://tracing or Perfetto.");
+#ifdef SHADERCROSS_WATCH
+    SDL_Log("  %-*s %s", column_width, "--watch", "Keep running and recompile whenever the input or a file it may include changes.");
+#endif
+    SDL_Log("\n");
+    SDL_Log("Manifest options:\n");
+    SDL_Log("  %-*s %s", column_width, "--manifest <value>", "Build every shader listed in a JSON manifest instead of a single input. Takes no input or output.");
+    SDL_Log("  %-*s %s", column_width, "", "The other options on the command line apply to every shader. See src/cli.c for the format.");
+    SDL_Log("  %-*s %s", column_width, "-j | --jobs <value>", "Number of shaders built at the same time. Default: the number of logical CPU cores.");
+    SDL_Log("  %-*s %s", column_width, "--summary <value>", "Write the status and build time of every output to a JSON file.");
+    SDL_Log("  %-*s %s", column_width, "--bundle <value>", "Also pack the DXBC, DXIL, MSL and SPIRV outputs into an indexed shader bundle.");
+#ifdef SHADERCROSS_SERVER
+    SDL_Log("\n");
+    SDL_Log("Server options:\n");
+    SDL_Log("  %-*s %s", column_width, "--server", "Keep running and compile the requests of clients. Takes no input or output.");
+    SDL_Log("  %-*s %s", column_width, "--client", "Forward the compile to a running server. Compiles in-process when no server is listening.");
+    SDL_Log("  %-*s %s", column_width, "--socket <value>", "Server socket path. Default: $XDG_RUNTIME_DIR/shadercross.sock, or /tmp/shadercross-<uid>.sock.");
+#endif
+}
+
+// Prints the statistics of the calling thread when stats is NULL
+static void print_mem_stats(const SDL_ShaderCross_MemoryStats *stats)
+{
+    static const char *stageNames[SDL_SHADERCROSS_MEMORYSTAGE_COUNT] = { "shadercross", "DXC", "SPIRV-Cross", "FXC" };
+    SDL_ShaderCross_MemoryStats threadStats;
+
+    if (stats == NULL) {
+        if (!SDL_ShaderCross_GetMemoryStats(&threadStats)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to get memory statistics: %s", SDL_GetError());
+            return;
+        }
+        stats = &threadStats;
+    }
+
+    SDL_Log("%-12s %12s %14s %14s", "Stage", "Allocations", "Total bytes", "Peak bytes");
+    for (int i = 0; i < SDL_SHADERCROSS_MEMORYSTAGE_COUNT; i += 1) {
+        SDL_Log("%-12s %12" SDL_PRIu64 " %14" SDL_PRIu64 " %14" SDL_PRIu64,
+            stageNames[i],
+            stats->stages[i].num_allocations,
+            stats->stages[i].total_bytes,
+            stats->stages[i].peak_bytes);
+    }
+    SDL_Log("%-12s %12" SDL_PRIu64 " %14" SDL_PRIu64 " %14" SDL_PRIu64,
+        "Total",
+        stats->total.num_allocations,
+        stats->total.total_bytes,
+        stats->total.peak_bytes);
+}
+
+// Statistics are kept per thread, so the ones of separate compiles are added up, except peaks which can't be
+static void add_mem_stage_stats(SDL_ShaderCross_MemoryStageStats *sum, const SDL_ShaderCross_MemoryStageStats *stats)
+{
+    sum->num_allocations += stats->num_allocations;
+    sum->total_bytes += stats->total_bytes;
+    sum->peak_bytes = SDL_max(sum->peak_bytes, stats->peak_bytes);
+}
+
+/* Timing, see --time */
+
+typedef enum ShaderCross_TimeStage {
+    TIME_STAGE_LOAD,
+    TIME_STAGE_HLSL_TO_SPIRV, // the library stages follow in SDL_ShaderCross_TimingStage order
+    TIME_STAGE_TRANSPILE,
+    TIME_STAGE_BACKEND,
+    TIME_STAGE_REFLECTION,
+    TIME_STAGE_WRITE,
+    TIME_STAGE_COUNT
+} ShaderCross_TimeStage;
+
+static const char *timeStageNames[TIME_STAGE_COUNT] = { "load", "HLSL->SPIRV", "transpile", "backend", "reflection", "write" };
+
+typedef struct ShaderCross_Timings {
+    Uint64 wallNS[TIME_STAGE_COUNT];
+    Uint64 cpuNS[TIME_STAGE_COUNT];
+    Uint64 totalWallNS;
+} ShaderCross_Timings;
+
+typedef struct ShaderCross_Stopwatch {
+    Uint64 wallNS;
+    Uint64 cpuNS;
+} ShaderCross_Stopwatch;
+
+// 0 where the platform doesn't report the CPU time of a thread
+static Uint64 get_thread_cpu_time(void)
+{
+#ifdef SHADERCROSS_MMAP_INPUT
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return (Uint64)ts.tv_sec * SDL_NS_PER_SECOND + (Uint64)ts.tv_nsec;
+    }
+#endif
+    return 0;
+}
+
+static void start_stopwatch(ShaderCross_Stopwatch *stopwatch)
+{
+    stopwatch->wallNS = SDL_GetTicksNS();
+    stopwatch->cpuNS = get_thread_cpu_time();
+}
+
+static void stop_stopwatch(const ShaderCross_Stopwatch *stopwatch, ShaderCross_Timings *timings, ShaderCross_TimeStage stage)
+{
+    timings->wallNS[stage] += SDL_GetTicksNS() - stopwatch->wallNS;
+    timings->cpuNS[stage] += get_thread_cpu_time() - stopwatch->cpuNS;
+}
+
+static void add_timings(ShaderCross_Timings *sum, const ShaderCross_Timings *timings)
+{
+    for (int i = 0; i < TIME_STAGE_COUNT; i += 1) {
+        sum->wallNS[i] += timings->wallNS[i];
+        sum->cpuNS[i] += timings->cpuNS[i];
+    }
+    sum->totalWallNS += timings->totalWallNS;
+}
+
+static ShaderCross_TimeStage get_slowest_stage(const ShaderCross_Timings *timings)
+{
+    ShaderCross_TimeStage slowest = TIME_STAGE_LOAD;
+    for (int i = 1; i < TIME_STAGE_COUNT; i += 1) {
+        if (timings->wallNS[i] > timings->wallNS[slowest]) {
+            slowest = (ShaderCross_TimeStage)i;
+        }
+    }
+    return slowest;
+}
+
+static void print_timings(const ShaderCross_Timings *timings)
+{
+    Uint64 stagesNS = 0;
+
+    SDL_Log("%-12s %12s %12s", "Stage", "Wall ms", "CPU ms");
+    for (int i = 0; i < TIME_STAGE_COUNT; i += 1) {
+        SDL_Log("%-12s %12.3f %12.3f", timeStageNames[i], (double)timings->wallNS[i] / SDL_NS_PER_MS, (double)timings->cpuNS[i] / SDL_NS_PER_MS);
+        stagesNS += timings->wallNS[i];
+    }
+    // Option handling, format inference and copying buffers between the stages
+    SDL_Log("%-12s %12.3f", "other", (double)(timings->totalWallNS > stagesNS ? timings->totalWallNS - stagesNS : 0) / SDL_NS_PER_MS);
+    SDL_Log("%-12s %12.3f", "total", (double)timings->totalWallNS / SDL_NS_PER_MS);
+}
+
+/* Tracing, see --trace
+ *
+ * Spans from the library and the CLI are collected in memory from every
+ * thread and written out as Chrome trace events when the CLI exits.
+ */
+
+typedef struct ShaderCross_TraceEvent {
+    const char *name;  // static
+    char *detail;      // SDL_malloc'd, may be NULL
+    Uint64 timeNS;
+    SDL_ThreadID thread;
+    bool begin;
+} ShaderCross_TraceEvent;
+
+static const char *traceFilename = NULL;
+static SDL_Mutex *traceLock = NULL;
+static ShaderCross_TraceEvent *traceEvents = NULL;
+static size_t numTraceEvents = 0;
+static size_t traceEventCapacity = 0;
+
+static void record_trace_event(const char *name, const char *detail, bool begin)
+{
+    if (traceLock == NULL) {
+        return;
+    }
+
+    Uint64 timeNS = SDL_GetTicksNS();
+    SDL_LockMutex(traceLock);
+    if (numTraceEvents == traceEventCapacity) {
+        size_t capacity = SDL_max(traceEventCapacity * 2, 1024);
+        ShaderCross_TraceEvent *events = (ShaderCross_TraceEvent *)SDL_realloc(traceEvents, sizeof(ShaderCross_TraceEvent) * capacity);
+        if (events == NULL) {
+            SDL_UnlockMutex(traceLock);
+            return;
+        }
+        traceEvents = events;
+        traceEventCapacity = capacity;
+    }
+    ShaderCross_TraceEvent *event = &traceEvents[numTraceEvents++];
+    event->name = name;
+    event->detail = detail != NULL ? SDL_strdup(detail) : NULL;
+    event->timeNS = timeNS;
+    event->thread = SDL_GetCurrentThreadID();
+    event->begin = begin;
+    SDL_UnlockMutex(traceLock);
+}
+
+static void SDLCALL record_library_trace_event(void *userdata, const char *name, bool begin)
+{
+    (void)userdata;
+    record_trace_event(name, NULL, begin);
+}
+
+static bool start_trace(const char *filename)
+{
+    traceLock = SDL_CreateMutex();
+    if (traceLock == NULL) {
+        return false;
+    }
+    traceFilename = filename;
+    SDL_ShaderCross_SetTraceCallback(record_library_trace_event, NULL);
+    return true;
+}
+
+static void stop_trace(void)
+{
+    SDL_ShaderCross_SetTraceCallback(NULL, NULL);
+    for (size_t i = 0; i < numTraceEvents; i += 1) {
+        SDL_free(traceEvents[i].detail);
+    }
+    SDL_free(traceEvents);
+    traceEvents = NULL;
+    numTraceEvents = 0;
+    traceEventCapacity = 0;
+    if (traceLock != NULL) {
+        SDL_DestroyMutex(traceLock);
+        traceLock = NULL;
+    }
+    traceFilename = NULL;
 }
 
 static const char* io_var_type_to_string(SDL_ShaderCross_IOVarType io_var_type, Uint32 vector_size)
@@ -221,241 +490,903 @@ void write_compute_reflect_json(SDL_IOStream *outputIO, SDL_ShaderCross_ComputeP
     );
 }
 
-int main(int argc, char *argv[])
+// - stands for the standard input or output, in place of a file name
+static bool is_standard_stream(const char *filename)
 {
-    bool sourceValid = false;
-    bool destinationValid = false;
-    bool stageValid = false;
+    return filename != NULL && SDL_strcmp(filename, "-") == 0;
+}
 
-    bool spirvSource = false;
-    ShaderCross_ShaderFormat destinationFormat = SHADERFORMAT_INVALID;
-    SDL_ShaderCross_ShaderStage shaderStage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
-    char *outputFilename = NULL;
-    char *entrypointName = "main";
-    char *includeDir = NULL;
+static void set_binary_mode(FILE *stream)
+{
+#ifdef SDL_PLATFORM_WINDOWS
+    // Don't let the C runtime translate line endings in SPIRV or DXIL
+    _setmode(_fileno(stream), _O_BINARY);
+#else
+    (void)stream;
+#endif
+}
 
-    char *filename = NULL;
-    size_t fileSize = 0;
-    void *fileData = NULL;
-    bool accept_optionals = true;
+// Reads the standard input to the end, null-terminated like SDL_LoadFile()
+static void *load_standard_input(size_t *size)
+{
+    size_t capacity = 0;
+    size_t length = 0;
+    char *data = NULL;
 
-    SDL_ShaderCross_HLSL_Define *defines = NULL;
-    size_t numDefines = 0;
+    set_binary_mode(stdin);
+    for (;;) {
+        if (capacity - length < 2) {
+            size_t newCapacity = SDL_max(capacity * 2, 65536);
+            char *newData = (char *)SDL_realloc(data, newCapacity);
+            if (newData == NULL) {
+                SDL_free(data);
+                return NULL;
+            }
+            data = newData;
+            capacity = newCapacity;
+        }
+        size_t count = fread(data + length, 1, capacity - length - 1, stdin);
+        length += count;
+        if (count == 0) {
+            break;
+        }
+    }
+    if (ferror(stdin)) {
+        SDL_free(data);
+        SDL_SetError("Failed to read the standard input");
+        return NULL;
+    }
 
-    bool cullUnusedBindings = false;
-    bool enableDebug = false;
-    char *mslVersion = NULL;
+    data[length] = '\0';
+    *size = length;
+    return data;
+}
 
-    bool psslCompat = false;
+static bool write_standard_output(const void *data, size_t size)
+{
+    set_binary_mode(stdout);
+    if (fwrite(data, 1, size, stdout) != size || fflush(stdout) != 0) {
+        return SDL_SetError("Failed to write the standard output");
+    }
+    return true;
+}
 
-#ifdef LEAKCHECK
-    SDLTest_TrackAllocations();
+typedef struct ShaderCross_InputFile {
+    void *data;
+    size_t size;
+    bool mapped;
+} ShaderCross_InputFile;
+
+// Map the input file into memory when possible, otherwise read it whole.
+// Text inputs must be null-terminated, so they are only mapped when the
+// zero-filled tail of the last page provides the terminator for free.
+static bool load_input_file(const char *filename, bool isText, ShaderCross_InputFile *file)
+{
+    SDL_zerop(file);
+
+    if (is_standard_stream(filename)) {
+        file->data = load_standard_input(&file->size);
+        return file->data != NULL;
+    }
+
+#ifdef SHADERCROSS_MMAP_INPUT
+    int fd = open(filename, O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            size_t size = (size_t)st.st_size;
+            long pageSize = sysconf(_SC_PAGESIZE);
+            if (!isText || (pageSize > 0 && (size % (size_t)pageSize) != 0)) {
+                void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    close(fd);
+                    file->data = data;
+                    file->size = size;
+                    file->mapped = true;
+                    return true;
+                }
+            }
+        }
+        close(fd);
+    }
+#else
+    (void)isText;
+#endif
+
+    file->data = SDL_LoadFile(filename, &file->size);
+    return file->data != NULL;
+}
+
+static void unload_input_file(ShaderCross_InputFile *file)
+{
+#ifdef SHADERCROSS_MMAP_INPUT
+    if (file->mapped) {
+        munmap(file->data, file->size);
+        SDL_zerop(file);
+        return;
+    }
+#endif
+    SDL_free(file->data);
+    SDL_zerop(file);
+}
+
+// Write the buffered output in one go to a temporary file next to the
+// destination, then rename it into place so readers never see a partial file.
+static bool write_output_file(const char *filename, const void *data, size_t size)
+{
+    char *tempFilename = NULL;
+    Uint64 processId = 0;
+    bool success;
+
+    if (is_standard_stream(filename)) {
+        return write_standard_output(data, size);
+    }
+
+#ifdef SHADERCROSS_MMAP_INPUT
+    processId = (Uint64)getpid();
 #endif
 
+    // The server writes outputs from several threads at once
+    if (SDL_asprintf(&tempFilename, "%s.%" SDL_PRIu64 ".%" SDL_PRIu64 ".tmp", filename, processId, (Uint64)SDL_GetCurrentThreadID()) < 0) {
+        return false;
+    }
+
+    success = SDL_SaveFile(tempFilename, data, size);
+    if (success) {
+        success = SDL_RenamePath(tempFilename, filename);
+    }
+    if (!success) {
+        // Keep the original error, removing a missing file would replace it
+        char *error = SDL_strdup(SDL_GetError());
+        SDL_RemovePath(tempFilename);
+        SDL_SetError("%s", error);
+        SDL_free(error);
+    }
+
+    SDL_free(tempFilename);
+    return success;
+}
+
+// Returns an SDL_malloc'd copy of the directory part of path, "." when there is none
+static char *get_parent_directory(const char *path)
+{
+    const char *slash = SDL_strrchr(path, '/');
+    if (slash == NULL) {
+        return SDL_strdup(".");
+    }
+    if (slash == path) {
+        return SDL_strdup("/");
+    }
+    return SDL_strndup(path, slash - path);
+}
+
+static const char *get_file_name(const char *path)
+{
+    const char *slash = SDL_strrchr(path, '/');
+    return slash != NULL ? slash + 1 : path;
+}
+
+// Relative paths are taken relative to base
+static char *resolve_path(const char *base, const char *path)
+{
+    char *resolved = NULL;
+    if (path[0] == '/') {
+        return SDL_strdup(path);
+    }
+    size_t length = SDL_strlen(base);
+    bool separator = length > 0 && base[length - 1] == '/';
+    SDL_asprintf(&resolved, "%s%s%s", base, separator ? "" : "/", path);
+    return resolved;
+}
+
+typedef struct ShaderCross_Options {
+    bool sourceValid;
+    bool destinationValid;
+    bool stageValid;
+
+    bool spirvSource;
+    ShaderCross_ShaderFormat destinationFormat;
+    SDL_ShaderCross_ShaderStage shaderStage;
+    char *outputFilename;
+    char *entrypointName;
+    char *includeDir;
+    char *filename;
+    char *depfileName;
+    bool writeDepfile;
+    bool embed;
+    char *embedName;
+    Uint32 embedFormats; // a bit per ShaderCross_ShaderFormat, several destinations are only allowed with --embed
+
+    SDL_ShaderCross_HLSL_Define *defines;
+    size_t numDefines;
+
+    bool cullUnusedBindings;
+    bool enableDebug;
+    char *mslVersion;
+    bool mslArgumentBuffers;
+    int shaderModel;
+    bool enable16BitTypes;
+
+    bool psslCompat;
+    bool stripDebugInfo;
+    const char *roundtripMode;
+    SDL_ShaderCross_SPIRVOptimization spirvOptimization;
+    int optimizationLevel;
+    bool memStats;
+    bool time;
+    bool watch;
+    bool trace;
+
+    // The directory relative paths are opened from, NULL for the working directory.
+    // The paths themselves are kept as given, for the depfile and the log.
+    const char *workingDir;
+} ShaderCross_Options;
+
+static void free_options(ShaderCross_Options *options)
+{
+    for (Uint32 i = 0; i < options->numDefines; i += 1) {
+        SDL_free(options->defines[i].name);
+    }
+    SDL_free(options->defines);
+    options->defines = NULL;
+    options->numDefines = 0;
+}
+
+// Returns an SDL_malloc'd path to open one of the paths of the options with
+static char *get_option_path(const ShaderCross_Options *options, const char *path)
+{
+    if (options->workingDir == NULL || is_standard_stream(path)) {
+        return SDL_strdup(path);
+    }
+    return resolve_path(options->workingDir, path);
+}
+
+static bool load_option_file(const ShaderCross_Options *options, const char *filename, bool isText, ShaderCross_InputFile *file)
+{
+    SDL_zerop(file);
+    char *path = get_option_path(options, filename);
+    bool success = path != NULL && load_input_file(path, isText, file);
+    SDL_free(path);
+    return success;
+}
+
+static bool write_option_file(const ShaderCross_Options *options, const char *filename, const void *data, size_t size)
+{
+    char *path = get_option_path(options, filename);
+    bool success = path != NULL && write_output_file(path, data, size);
+    SDL_free(path);
+    return success;
+}
+
+static ShaderCross_ShaderFormat parse_destination_format(const char *name, size_t length)
+{
+    static const struct {
+        const char *name;
+        ShaderCross_ShaderFormat format;
+    } formats[] = {
+        { "DXBC", SHADERFORMAT_DXBC },
+        { "DXIL", SHADERFORMAT_DXIL },
+        { "MSL", SHADERFORMAT_MSL },
+        { "SPIRV", SHADERFORMAT_SPIRV },
+        { "HLSL", SHADERFORMAT_HLSL },
+        { "JSON", SHADERFORMAT_JSON }
+    };
+    for (size_t i = 0; i < SDL_arraysize(formats); i += 1) {
+        if (SDL_strlen(formats[i].name) == length && SDL_strncasecmp(name, formats[i].name, length) == 0) {
+            return formats[i].format;
+        }
+    }
+    return SHADERFORMAT_INVALID;
+}
+
+// Returns false when the program should exit right away with *exitCode, after --help or a bad argument.
+// The options point into argv, which must outlive them.
+// Without requireOutput the output is optional, for shaders that are only added to a bundle.
+static bool parse_options(int argc, char *argv[], ShaderCross_Options *options, int *exitCode, bool requireOutput)
+{
+    bool accept_optionals = true;
+
+    SDL_zerop(options);
+    options->destinationFormat = SHADERFORMAT_INVALID;
+    options->shaderStage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
+    options->entrypointName = "main";
+    options->spirvOptimization = SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE;
+    options->optimizationLevel = -1;
+    *exitCode = 1;
+
     for (int i = 1; i < argc; i += 1) {
         char *arg = argv[i];
 
-        if (accept_optionals && arg[0] == '-') {
+        // A lone - is the standard input
+        if (accept_optionals && arg[0] == '-' && arg[1] != '\0') {
             if (SDL_strcmp(arg, "-h") == 0 || SDL_strcmp(arg, "--help") == 0) {
                 print_help();
-                return 0;
+                *exitCode = 0;
+                return false;
             } else if (SDL_strcmp(arg, "-s") == 0 || SDL_strcmp(arg, "--source") == 0) {
                 if (i + 1 >= argc) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
                     print_help();
-                    return 1;
+                    return false;
                 }
                 i += 1;
                 if (SDL_strcasecmp(argv[i], "spirv") == 0) {
-                    spirvSource = true;
-                    sourceValid = true;
+                    options->spirvSource = true;
+                    options->sourceValid = true;
                 } else if (SDL_strcasecmp(argv[i], "hlsl") == 0) {
-                    spirvSource = false;
-                    sourceValid = true;
+                    options->spirvSource = false;
+                    options->sourceValid = true;
                 } else {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unrecognized source input %s, source must be SPIRV or HLSL!", argv[i]);
                     print_help();
-                    return 1;
+                    return false;
                 }
             } else if (SDL_strcmp(arg, "-d") == 0 || SDL_strcmp(arg, "--dest") == 0) {
                 if (i + 1 >= argc) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
                     print_help();
-                    return 1;
+                    return false;
                 }
                 i += 1;
-                if (SDL_strcasecmp(argv[i], "DXBC") == 0) {
-                    destinationFormat = SHADERFORMAT_DXBC;
-                    destinationValid = true;
-                } else if (SDL_strcasecmp(argv[i], "DXIL") == 0) {
-                    destinationFormat = SHADERFORMAT_DXIL;
-                    destinationValid = true;
-                } else if (SDL_strcasecmp(argv[i], "MSL") == 0) {
-                    destinationFormat = SHADERFORMAT_MSL;
-                    destinationValid = true;
-                } else if (SDL_strcasecmp(argv[i], "SPIRV") == 0) {
-                    destinationFormat = SHADERFORMAT_SPIRV;
-                    destinationValid = true;
-                } else if (SDL_strcasecmp(argv[i], "HLSL") == 0) {
-                    destinationFormat = SHADERFORMAT_HLSL;
-                    destinationValid = true;
-                } else if (SDL_strcasecmp(argv[i], "JSON") == 0) {
-                    destinationFormat = SHADERFORMAT_JSON;
-                    destinationValid = true;
-                } else {
-                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unrecognized destination input %s, destination must be DXBC, DXIL, MSL or SPIRV!", argv[i]);
-                    print_help();
-                    return 1;
+                options->destinationValid = false;
+                options->embedFormats = 0;
+                for (const char *name = argv[i]; name != NULL;) {
+                    const char *comma = SDL_strchr(name, ',');
+                    size_t length = comma != NULL ? (size_t)(comma - name) : SDL_strlen(name);
+                    ShaderCross_ShaderFormat format = parse_destination_format(name, length);
+                    if (format == SHADERFORMAT_INVALID) {
+                        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unrecognized destination input %s, destination must be DXBC, DXIL, MSL or SPIRV!", argv[i]);
+                        print_help();
+                        return false;
+                    }
+                    if (!options->destinationValid) {
+                        options->destinationFormat = format;
+                        options->destinationValid = true;
+                    }
+                    options->embedFormats |= 1u << format;
+                    name = comma != NULL ? comma + 1 : NULL;
                 }
             } else if (SDL_strcmp(arg, "-t") == 0 || SDL_strcmp(arg, "--stage") == 0) {
                 if (i + 1 >= argc) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
                     print_help();
-                    return 1;
+                    return false;
                 }
                 i += 1;
                 if (SDL_strcasecmp(argv[i], "vertex") == 0) {
-                    shaderStage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
-                    stageValid = true;
+                    options->shaderStage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
+                    options->stageValid = true;
                 } else if (SDL_strcasecmp(argv[i], "fragment") == 0) {
-                    shaderStage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
-                    stageValid = true;
+                    options->shaderStage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
+                    options->stageValid = true;
                 } else if (SDL_strcasecmp(argv[i], "compute") == 0) {
-                    shaderStage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
-                    stageValid = true;
+                    options->shaderStage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
+                    options->stageValid = true;
                 } else {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unrecognized shader stage input %s, must be vertex, fragment, or compute.", argv[i]);
                     print_help();
-                    return 1;
+                    return false;
                 }
             } else if (SDL_strcmp(arg, "-e") == 0 || SDL_strcmp(arg, "--entrypoint") == 0) {
                 if (i + 1 >= argc) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
                     print_help();
-                    return 1;
+                    return false;
                 }
                 i += 1;
-                entrypointName = argv[i];
+                options->entrypointName = argv[i];
             } else if (SDL_strcmp(arg, "-I") == 0 || SDL_strcmp(arg, "--include") == 0) {
-                if (includeDir) {
+                if (options->includeDir) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "'%s' can only be used once", arg);
                     print_help();
-                    return 1;
+                    return false;
                 }
                 if (i + 1 >= argc) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
                     print_help();
-                    return 1;
+                    return false;
+                }
+                i += 1;
+                options->includeDir = argv[i];
+            } else if (SDL_strcmp(arg, "-MD") == 0) {
+                options->writeDepfile = true;
+            } else if (SDL_strcmp(arg, "-MF") == 0) {
+                if (i + 1 >= argc) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
+                    print_help();
+                    return false;
                 }
                 i += 1;
-                includeDir = argv[i];
+                options->depfileName = argv[i];
+                options->writeDepfile = true;
             } else if (SDL_strcmp(arg, "-o") == 0 || SDL_strcmp(arg, "--output") == 0) {
                 if (i + 1 >= argc) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
                     print_help();
-                    return 1;
+                    return false;
                 }
                 i += 1;
-                outputFilename = argv[i];
+                options->outputFilename = argv[i];
             } else if (SDL_strncmp(argv[i], "-D", SDL_strlen("-D")) == 0) {
-                numDefines += 1;
-                defines = SDL_realloc(defines, sizeof(SDL_ShaderCross_HLSL_Define) * numDefines);
+                options->numDefines += 1;
+                options->defines = SDL_realloc(options->defines, sizeof(SDL_ShaderCross_HLSL_Define) * options->numDefines);
+                SDL_ShaderCross_HLSL_Define *define = &options->defines[options->numDefines - 1];
                 char *equalSign = SDL_strchr(argv[i], '=');
                 if (equalSign != NULL) {
-                    defines[numDefines - 1].value = equalSign + 1;
-                    size_t len = defines[numDefines - 1].value - argv[i] - 2;
-                    defines[numDefines - 1].name = SDL_malloc(len);
-                    SDL_utf8strlcpy(defines[numDefines - 1].name, (const char *)argv[i] + 2, len);
+                    define->value = equalSign + 1;
+                    size_t len = define->value - argv[i] - 2;
+                    define->name = SDL_malloc(len);
+                    SDL_utf8strlcpy(define->name, (const char *)argv[i] + 2, len);
                 } else { // no '=' was found
-                    defines[numDefines - 1].value = NULL;
+                    define->value = NULL;
                     size_t len = SDL_utf8strlen(argv[i]) + 1 - 2;
-                    defines[numDefines - 1].name = SDL_malloc(len);
-                    SDL_utf8strlcpy(defines[numDefines - 1].name, (const char *)argv[i] + 2, len);
+                    define->name = SDL_malloc(len);
+                    SDL_utf8strlcpy(define->name, (const char *)argv[i] + 2, len);
                 }
             } else if (SDL_strcmp(arg, "--msl-version") == 0) {
                 if (i + 1 >= argc) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
                     print_help();
-                    return 1;
+                    return false;
+                }
+                i += 1;
+                options->mslVersion = argv[i];
+            } else if (SDL_strcmp(arg, "--msl-argument-buffers") == 0) {
+                options->mslArgumentBuffers = true;
+            } else if (SDL_strcmp(arg, "--shader-model") == 0) {
+                if (i + 1 >= argc) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
+                    print_help();
+                    return false;
                 }
                 i += 1;
-                mslVersion = argv[i];
+                // Accepts both 6.5 and 65
+                const char *model = argv[i];
+                if (SDL_isdigit(model[0]) && (model[1] == '.' || model[1] == '_') && SDL_isdigit(model[2]) && model[3] == '\0') {
+                    options->shaderModel = (model[0] - '0') * 10 + (model[2] - '0');
+                } else if (SDL_isdigit(model[0]) && SDL_isdigit(model[1]) && model[2] == '\0') {
+                    options->shaderModel = (model[0] - '0') * 10 + (model[1] - '0');
+                } else {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unrecognized shader model %s, expected a value such as 6.5", model);
+                    print_help();
+                    return false;
+                }
+            } else if (SDL_strcmp(arg, "--enable-16bit-types") == 0) {
+                options->enable16BitTypes = true;
             } else if (SDL_strcmp(arg, "-c") == 0 || SDL_strcmp(arg, "--cull") == 0) {
-                cullUnusedBindings = true;
+                options->cullUnusedBindings = true;
             }  else if (SDL_strcmp(arg, "-g") == 0 || SDL_strcmp(arg, "--debug") == 0) {
-                enableDebug = true;
+                options->enableDebug = true;
             } else if (SDL_strcmp(arg, "-p") == 0 || SDL_strcmp(arg, "--pssl") == 0) {
-                psslCompat = true;
+                options->psslCompat = true;
+            } else if (SDL_strcmp(arg, "--roundtrip") == 0) {
+                if (i + 1 >= argc) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
+                    print_help();
+                    return false;
+                }
+                i += 1;
+                if (SDL_strcasecmp(argv[i], "always") != 0 &&
+                    SDL_strcasecmp(argv[i], "auto") != 0 &&
+                    SDL_strcasecmp(argv[i], "never") != 0) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unrecognized roundtrip mode %s, valid options are always, auto and never", argv[i]);
+                    print_help();
+                    return false;
+                }
+                options->roundtripMode = argv[i];
+            } else if (SDL_strcmp(arg, "-O") == 0) {
+                options->spirvOptimization = SDL_SHADERCROSS_SPIRVOPTIMIZATION_PERFORMANCE;
+            } else if (SDL_strcmp(arg, "-Os") == 0) {
+                options->spirvOptimization = SDL_SHADERCROSS_SPIRVOPTIMIZATION_SIZE;
+            } else if (SDL_strcmp(arg, "-O0") == 0) {
+                options->spirvOptimization = SDL_SHADERCROSS_SPIRVOPTIMIZATION_NONE;
+                options->optimizationLevel = 0;
+            } else if (SDL_strcmp(arg, "-O1") == 0 || SDL_strcmp(arg, "-O2") == 0 || SDL_strcmp(arg, "-O3") == 0) {
+                options->optimizationLevel = arg[2] - '0';
+            } else if (SDL_strcmp(arg, "--strip") == 0) {
+                options->stripDebugInfo = true;
+            } else if (SDL_strcmp(arg, "--embed") == 0) {
+                options->embed = true;
+            } else if (SDL_strcmp(arg, "--embed-name") == 0) {
+                if (i + 1 >= argc) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
+                    print_help();
+                    return false;
+                }
+                i += 1;
+                options->embedName = argv[i];
+            } else if (SDL_strcmp(arg, "--mem-stats") == 0) {
+                // tracking itself is enabled before anything else, see main()
+                options->memStats = true;
+            } else if (SDL_strcmp(arg, "--time") == 0) {
+                options->time = true;
+            } else if (SDL_strcmp(arg, "--trace") == 0) {
+                if (i + 1 >= argc) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
+                    print_help();
+                    return false;
+                }
+                // the trace itself is started before anything else, see main()
+                i += 1;
+                options->trace = true;
+#ifdef SHADERCROSS_WATCH
+            } else if (SDL_strcmp(arg, "--watch") == 0) {
+                options->watch = true;
+#endif
             } else if (SDL_strcmp(arg, "--") == 0) {
                 accept_optionals = false;
             } else {
                 SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Unknown argument: %s", argv[0], arg);
                 print_help();
-                return 1;
+                return false;
             }
-        } else if (!filename) {
-            filename = arg;
+        } else if (!options->filename) {
+            options->filename = arg;
         } else {
             SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Unknown argument: %s", argv[0], arg);
             print_help();
-            return 1;
+            return false;
         }
     }
-    if (!filename) {
+    if (!options->filename) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: missing input path", argv[0]);
         print_help();
-        return 1;
+        return false;
     }
-    if (!outputFilename) {
+    if (!options->outputFilename && requireOutput) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: missing output path", argv[0]);
         print_help();
-        return 1;
+        return false;
     }
-    fileData = SDL_LoadFile(filename, &fileSize);
-    if (fileData == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Invalid file (%s)", SDL_GetError());
-        return 1;
+    if ((options->embedFormats & (options->embedFormats - 1)) != 0 && !options->embed) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: several destinations can only be written with --embed", argv[0]);
+        print_help();
+        return false;
+    }
+    if (options->writeDepfile && (is_standard_stream(options->filename) || is_standard_stream(options->outputFilename))) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: -MD can't be used with the standard input or output", argv[0]);
+        print_help();
+        return false;
+    }
+    if (options->watch && is_standard_stream(options->filename)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: --watch can't be used with the standard input", argv[0]);
+        print_help();
+        return false;
+    }
+    if (options->trace && options->watch) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: --trace can't be used with --watch", argv[0]);
+        print_help();
+        return false;
     }
 
-    if (!SDL_ShaderCross_Init())
-    {
-        SDL_LogError(SDL_LOG_CATEGORY_GPU, "%s", "Failed to initialize shadercross!");
-        return 1;
+    // null-terminate the defines array
+    if (options->defines != NULL) {
+        options->defines = SDL_realloc(options->defines, sizeof(SDL_ShaderCross_HLSL_Define) * (options->numDefines + 1));
+        options->defines[options->numDefines].name = NULL;
+        options->defines[options->numDefines].value = NULL;
     }
 
-    if (!sourceValid) {
-        if (SDL_strstr(filename, ".spv")) {
-            spirvSource = true;
-        } else if (SDL_strstr(filename, ".hlsl")) {
-            spirvSource = false;
-        } else {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "Could not infer source format!");
-            print_help();
-            return 1;
+    return true;
+}
+
+/* Dependency tracking */
+
+typedef struct ShaderCross_Dependencies {
+    char **paths;
+    size_t count;
+} ShaderCross_Dependencies;
+
+static void clear_dependencies(ShaderCross_Dependencies *dependencies)
+{
+    for (size_t i = 0; i < dependencies->count; i += 1) {
+        SDL_free(dependencies->paths[i]);
+    }
+    SDL_free(dependencies->paths);
+    SDL_zerop(dependencies);
+}
+
+static void SDLCALL record_dependency(void *userdata, const char *path)
+{
+    ShaderCross_Dependencies *dependencies = (ShaderCross_Dependencies *)userdata;
+
+    // Headers without include guards are opened once per #include
+    for (size_t i = 0; i < dependencies->count; i += 1) {
+        if (SDL_strcmp(dependencies->paths[i], path) == 0) {
+            return;
         }
     }
 
-    if (!destinationValid) {
-        if (SDL_strstr(outputFilename, ".dxbc")) {
-            destinationFormat = SHADERFORMAT_DXBC;
-        } else if (SDL_strstr(outputFilename, ".dxil")) {
-            destinationFormat = SHADERFORMAT_DXIL;
-        } else if (SDL_strstr(outputFilename, ".msl")) {
-            destinationFormat = SHADERFORMAT_MSL;
-        } else if (SDL_strstr(outputFilename, ".spv")) {
-            destinationFormat = SHADERFORMAT_SPIRV;
-        } else if (SDL_strstr(outputFilename, ".hlsl")) {
-            destinationFormat = SHADERFORMAT_HLSL;
-        } else if (SDL_strstr(outputFilename, ".json")) {
+    char **paths = (char **)SDL_realloc(dependencies->paths, sizeof(char *) * (dependencies->count + 1));
+    if (paths == NULL) {
+        return;
+    }
+    dependencies->paths = paths;
+    paths[dependencies->count] = SDL_strdup(path);
+    if (paths[dependencies->count] != NULL) {
+        dependencies->count += 1;
+    }
+}
+
+// Escapes a path the way Make and Ninja's depfile parser expect
+static void write_depfile_path(SDL_IOStream *io, const char *path)
+{
+    for (const char *c = path; *c != '\0'; c += 1) {
+        if (*c == ' ' || *c == '#') {
+            SDL_WriteIO(io, "\\", 1);
+        } else if (*c == '$') {
+            SDL_WriteIO(io, "$", 1);
+        }
+        SDL_WriteIO(io, c, 1);
+    }
+}
+
+static bool write_depfile(const ShaderCross_Options *options, const char *depfileName, const char *outputFilename, const char *filename, const ShaderCross_Dependencies *dependencies)
+{
+    SDL_IOStream *io = SDL_IOFromDynamicMem();
+    if (io == NULL) {
+        return false;
+    }
+
+    write_depfile_path(io, outputFilename);
+    SDL_IOprintf(io, ": ");
+    write_depfile_path(io, filename);
+    for (size_t i = 0; i < dependencies->count; i += 1) {
+        SDL_IOprintf(io, " \\\n  ");
+        write_depfile_path(io, dependencies->paths[i]);
+    }
+    SDL_IOprintf(io, "\n");
+
+    void *data = SDL_GetPointerProperty(SDL_GetIOProperties(io), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    Sint64 size = SDL_TellIO(io);
+    bool success = size >= 0 && write_option_file(options, depfileName, data, (size_t)size);
+    SDL_CloseIO(io);
+    return success;
+}
+
+// Writes the depfile the options ask for, if any, once the output has been written
+static bool write_output_depfile(const ShaderCross_Options *options, const char *outputFilename, const ShaderCross_Dependencies *dependencies)
+{
+    if (!options->writeDepfile || outputFilename == NULL) {
+        return true;
+    }
+
+    char *depfileName = options->depfileName;
+    if (depfileName == NULL) {
+        SDL_asprintf(&depfileName, "%s.d", outputFilename);
+    }
+    bool success = depfileName != NULL && write_depfile(options, depfileName, outputFilename, options->filename, dependencies);
+    if (!success) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write %s: %s", depfileName ? depfileName : "dependency file", SDL_GetError());
+    }
+    if (depfileName != options->depfileName) {
+        SDL_free(depfileName);
+    }
+    return success;
+}
+
+/* Shaders headed for a bundle or a C header */
+
+// A compiled shader handed back to the caller, in addition to the output file if there is one
+typedef struct ShaderCross_CompiledShader {
+    void *code;
+    size_t codeSize;
+    char *entrypoint;                   // the name to create the shader with
+    SDL_ShaderCross_BundleEntry entry;  // the format, stage and reflection, the bundle writer fills in the rest
+} ShaderCross_CompiledShader;
+
+static void free_compiled_shader(ShaderCross_CompiledShader *compiled)
+{
+    SDL_free(compiled->code);
+    SDL_free(compiled->entrypoint);
+    SDL_zerop(compiled);
+}
+
+static SDL_GPUShaderFormat get_gpu_shader_format(ShaderCross_ShaderFormat format)
+{
+    switch (format) {
+        case SHADERFORMAT_DXBC: return SDL_GPU_SHADERFORMAT_DXBC;
+        case SHADERFORMAT_DXIL: return SDL_GPU_SHADERFORMAT_DXIL;
+        case SHADERFORMAT_MSL: return SDL_GPU_SHADERFORMAT_MSL;
+        case SHADERFORMAT_SPIRV: return SDL_GPU_SHADERFORMAT_SPIRV;
+        default: return SDL_GPU_SHADERFORMAT_INVALID;
+    }
+}
+
+// Fills in the resource counts SDL_GPU needs to create the shader, from the metadata of its stage
+static void set_compiled_metadata(SDL_ShaderCross_BundleEntry *entry, const SDL_ShaderCross_GraphicsShaderMetadata *graphics, const SDL_ShaderCross_ComputePipelineMetadata *compute)
+{
+    if (compute != NULL) {
+        entry->num_samplers = compute->num_samplers;
+        entry->num_readonly_storage_textures = compute->num_readonly_storage_textures;
+        entry->num_readonly_storage_buffers = compute->num_readonly_storage_buffers;
+        entry->num_readwrite_storage_textures = compute->num_readwrite_storage_textures;
+        entry->num_readwrite_storage_buffers = compute->num_readwrite_storage_buffers;
+        entry->num_uniform_buffers = compute->num_uniform_buffers;
+        entry->threadcount_x = compute->threadcount_x;
+        entry->threadcount_y = compute->threadcount_y;
+        entry->threadcount_z = compute->threadcount_z;
+    } else {
+        entry->num_samplers = graphics->resource_info.num_samplers;
+        entry->num_readonly_storage_textures = graphics->resource_info.num_storage_textures;
+        entry->num_readonly_storage_buffers = graphics->resource_info.num_storage_buffers;
+        entry->num_uniform_buffers = graphics->resource_info.num_uniform_buffers;
+    }
+}
+
+// Reflects shipped SPIRV, the other formats are reflected as they are compiled by compile_from_spirv()
+static bool reflect_compiled_shader(const void *spirv, size_t spirvSize, SDL_ShaderCross_ShaderStage shaderStage, SDL_ShaderCross_BundleEntry *entry)
+{
+    if (shaderStage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+        SDL_ShaderCross_ComputePipelineMetadata *info = SDL_ShaderCross_ReflectComputeSPIRV(spirv, spirvSize, 0);
+        if (info == NULL) {
+            return false;
+        }
+        set_compiled_metadata(entry, NULL, info);
+        SDL_free(info);
+    } else {
+        SDL_ShaderCross_GraphicsShaderMetadata *info = SDL_ShaderCross_ReflectGraphicsSPIRV(spirv, spirvSize, 0);
+        if (info == NULL) {
+            return false;
+        }
+        set_compiled_metadata(entry, info, NULL);
+        SDL_free(info);
+    }
+    return true;
+}
+
+// Compiles SPIRV to DXBC, DXIL or MSL. MSL comes back null-terminated, with the terminator counted in size.
+// When compiled isn't NULL, the same compile also fills in its reflection and the entry point to create the shader with.
+static void *compile_from_spirv(const SDL_ShaderCross_SPIRV_Info *spirvInfo, SDL_GPUShaderFormat format, size_t *size, ShaderCross_CompiledShader *compiled)
+{
+    if (compiled == NULL) {
+        if (format == SDL_GPU_SHADERFORMAT_DXBC) {
+            return SDL_ShaderCross_CompileDXBCFromSPIRV(spirvInfo, size);
+        } else if (format == SDL_GPU_SHADERFORMAT_DXIL) {
+            return SDL_ShaderCross_CompileDXILFromSPIRV(spirvInfo, size);
+        }
+        char *msl = (char *)SDL_ShaderCross_TranspileMSLFromSPIRV(spirvInfo);
+        if (msl != NULL) {
+            *size = SDL_strlen(msl) + 1;
+        }
+        return msl;
+    }
+
+    SDL_ShaderCross_SPIRVEntryPointOutput *output = SDL_ShaderCross_CompileSPIRVEntryPoint(spirvInfo, format);
+    if (output == NULL) {
+        return NULL;
+    }
+    void *code = output->code;
+    *size = output->code_size;
+    set_compiled_metadata(&compiled->entry, output->graphics_metadata, output->compute_metadata);
+    SDL_free(compiled->entrypoint);
+    compiled->entrypoint = SDL_strdup(output->entrypoint);
+    SDL_free(output->graphics_metadata);
+    SDL_free(output->compute_metadata);
+    SDL_free(output);
+    if (compiled->entrypoint == NULL) {
+        SDL_free(code);
+        return NULL;
+    }
+    return code;
+}
+
+// The SPIRV compiled from HLSL is already optimized, so the further stages only take the target options
+static SDL_PropertiesID create_spirv_stage_props(const ShaderCross_Options *options)
+{
+    SDL_PropertiesID props = SDL_CreateProperties();
+    if (options->enableDebug) {
+        SDL_SetBooleanProperty(props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, true);
+        SDL_SetStringProperty(props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, options->filename);
+    }
+    if (options->cullUnusedBindings) {
+        SDL_SetBooleanProperty(props, SDL_SHADERCROSS_PROP_SHADER_CULL_UNUSED_BINDINGS_BOOLEAN, true);
+    }
+    if (options->mslVersion) {
+        SDL_SetStringProperty(props, SDL_SHADERCROSS_PROP_SPIRV_MSL_VERSION_STRING, options->mslVersion);
+    }
+    if (options->mslArgumentBuffers) {
+        SDL_SetBooleanProperty(props, SDL_SHADERCROSS_PROP_SPIRV_MSL_ARGUMENT_BUFFERS_BOOLEAN, true);
+    }
+    if (options->shaderModel != 0) {
+        SDL_SetNumberProperty(props, SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER, options->shaderModel);
+    }
+    if (options->enable16BitTypes) {
+        SDL_SetBooleanProperty(props, SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN, true);
+    }
+    return props;
+}
+
+// Compiles HLSL to SPIRV, then on to DXBC, DXIL or MSL with compile_from_spirv()
+static void *compile_hlsl_through_spirv(const ShaderCross_Options *options, const SDL_ShaderCross_HLSL_Info *hlslInfo, SDL_GPUShaderFormat format, size_t *size, ShaderCross_CompiledShader *compiled)
+{
+    SDL_ShaderCross_SPIRV_Info spirvInfo;
+    void *spirv = SDL_ShaderCross_CompileSPIRVFromHLSL(hlslInfo, &spirvInfo.bytecode_size);
+    if (spirv == NULL) {
+        return NULL;
+    }
+    spirvInfo.bytecode = (const Uint8 *)spirv;
+    spirvInfo.entrypoint = hlslInfo->entrypoint;
+    spirvInfo.shader_stage = hlslInfo->shader_stage;
+    spirvInfo.props = create_spirv_stage_props(options);
+
+    void *code = compile_from_spirv(&spirvInfo, format, size, compiled);
+    SDL_free(spirv);
+    SDL_DestroyProperties(spirvInfo.props);
+    return code;
+}
+
+static int embed_shader(const ShaderCross_Options *options, ShaderCross_Dependencies *dependencies);
+
+// Compiles a single shader as described by the options. SDL_ShaderCross_Init() must have been called.
+// The files included by HLSL source are recorded into dependencies when it isn't NULL.
+// The shader is also handed back with its reflection through compiled when it isn't NULL.
+// The time spent in each stage is stored in timings when it isn't NULL, and printed with --time otherwise.
+// Returns the process exit code.
+static int compile_shader(const ShaderCross_Options *options, ShaderCross_Dependencies *dependencies, ShaderCross_CompiledShader *compiled, ShaderCross_Timings *timings)
+{
+    bool spirvSource = options->spirvSource;
+    ShaderCross_ShaderFormat destinationFormat = options->destinationFormat;
+    SDL_ShaderCross_ShaderStage shaderStage = options->shaderStage;
+    const char *filename = options->filename;
+    const char *outputFilename = options->outputFilename;
+    const char *entrypointName = options->entrypointName;
+    ShaderCross_InputFile inputFile;
+    size_t fileSize = 0;
+    void *fileData = NULL;
+
+    if (options->embed && compiled == NULL) {
+        return embed_shader(options, dependencies);
+    }
+
+    ShaderCross_Timings localTimings;
+    ShaderCross_Stopwatch stopwatch;
+    Uint64 startNS = SDL_GetTicksNS();
+    bool printTimings = options->time && timings == NULL;
+    bool timed = options->time || timings != NULL;
+    if (timings == NULL) {
+        timings = &localTimings;
+    }
+    SDL_zerop(timings);
+    if (timed) {
+        SDL_ShaderCross_ResetTimingStats();
+    }
+
+    if (!options->sourceValid) {
+        if (SDL_strstr(filename, ".spv")) {
+            spirvSource = true;
+        } else if (SDL_strstr(filename, ".hlsl")) {
+            spirvSource = false;
+        } else {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", is_standard_stream(filename) ? "The standard input requires a source format (-s)!" : "Could not infer source format!");
+            print_help();
+            return 1;
+        }
+    }
+
+    if (!options->destinationValid && outputFilename == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "Destination format not provided!");
+        return 1;
+    } else if (!options->destinationValid) {
+        if (SDL_strstr(outputFilename, ".dxbc")) {
+            destinationFormat = SHADERFORMAT_DXBC;
+        } else if (SDL_strstr(outputFilename, ".dxil")) {
+            destinationFormat = SHADERFORMAT_DXIL;
+        } else if (SDL_strstr(outputFilename, ".msl")) {
+            destinationFormat = SHADERFORMAT_MSL;
+        } else if (SDL_strstr(outputFilename, ".spv")) {
+            destinationFormat = SHADERFORMAT_SPIRV;
+        } else if (SDL_strstr(outputFilename, ".hlsl")) {
+            destinationFormat = SHADERFORMAT_HLSL;
+        } else if (SDL_strstr(outputFilename, ".json")) {
             destinationFormat = SHADERFORMAT_JSON;
         } else {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "Could not infer destination format!");
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", is_standard_stream(outputFilename) ? "The standard output requires a destination format (-d)!" : "Could not infer destination format!");
             print_help();
             return 1;
         }
     }
 
-    if (!stageValid) {
+    if (!options->stageValid) {
         if (SDL_strcasestr(filename, ".vert")) {
             shaderStage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
         } else if (SDL_strcasestr(filename, ".frag")) {
@@ -463,27 +1394,61 @@ int main(int argc, char *argv[])
         } else if (SDL_strcasestr(filename, ".comp")) {
             shaderStage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
         } else {
-            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Could not infer shader stage from filename!");
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", is_standard_stream(filename) ? "The standard input requires a shader stage (-t)!" : "Could not infer shader stage from filename!");
             print_help();
             return 1;
         }
     }
 
-    SDL_IOStream *outputIO = SDL_IOFromFile(outputFilename, "w");
+    if (compiled != NULL && get_gpu_shader_format(destinationFormat) == SDL_GPU_SHADERFORMAT_INVALID) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "Only DXBC, DXIL, MSL and SPIRV shaders can be bundled or embedded");
+        return 1;
+    }
+
+    // Reflection comes from SPIRV, so bundled and embedded HLSL is always compiled through the SPIRV that is reflected
+    if (compiled != NULL && !spirvSource && options->roundtripMode != NULL && SDL_strcmp(options->roundtripMode, "never") == 0 &&
+        (destinationFormat == SHADERFORMAT_DXBC || destinationFormat == SHADERFORMAT_DXIL)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "--roundtrip never can't be used for bundled or embedded DXBC and DXIL, which are compiled through SPIRV");
+        return 1;
+    }
+
+    record_trace_event("compile", filename, true);
+    start_stopwatch(&stopwatch);
+    record_trace_event("load", NULL, true);
+    bool loaded = load_option_file(options, filename, !spirvSource, &inputFile);
+    record_trace_event("load", NULL, false);
+    if (!loaded) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Invalid file (%s)", SDL_GetError());
+        record_trace_event("compile", NULL, false);
+        return 1;
+    }
+    stop_stopwatch(&stopwatch, timings, TIME_STAGE_LOAD);
+    fileData = inputFile.data;
+    fileSize = inputFile.size;
+
+    // Output is buffered in memory and written out in a single call once compilation succeeded
+    SDL_IOStream *outputIO = SDL_IOFromDynamicMem();
 
     if (outputIO == NULL) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+        unload_input_file(&inputFile);
+        record_trace_event("compile", NULL, false);
         return 1;
     }
 
     size_t bytecodeSize;
     int result = 0;
 
-    // null-terminate the defines array
-    if (defines != NULL) {
-        defines = SDL_realloc(defines, sizeof(SDL_ShaderCross_HLSL_Define) * (numDefines + 1));
-        defines[numDefines].name = NULL;
-        defines[numDefines].value = NULL;
+    ShaderCross_Dependencies localDependencies;
+    SDL_zero(localDependencies);
+    bool trackIncludes = dependencies != NULL || options->writeDepfile;
+    if (dependencies == NULL) {
+        dependencies = &localDependencies;
+    }
+    clear_dependencies(dependencies);
+
+    if (options->memStats) {
+        SDL_ShaderCross_ResetMemoryStats();
     }
 
     if (spirvSource) {
@@ -493,25 +1458,40 @@ int main(int argc, char *argv[])
         spirvInfo.entrypoint = entrypointName;
         spirvInfo.shader_stage = shaderStage;
         spirvInfo.props = SDL_CreateProperties();
-        if (enableDebug) {
+        if (options->enableDebug) {
             SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, true);
             SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, filename);
         }
-        if (cullUnusedBindings) {
+        if (options->cullUnusedBindings) {
             SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_CULL_UNUSED_BINDINGS_BOOLEAN, true);
         }
-        if (mslVersion) {
-            SDL_SetStringProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SPIRV_MSL_VERSION_STRING, mslVersion);
+        if (options->mslVersion) {
+            SDL_SetStringProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SPIRV_MSL_VERSION_STRING, options->mslVersion);
+        }
+        if (options->mslArgumentBuffers) {
+            SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SPIRV_MSL_ARGUMENT_BUFFERS_BOOLEAN, true);
         }
-        if (psslCompat) {
+        if (options->psslCompat) {
             SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SPIRV_PSSL_COMPATIBILITY_BOOLEAN, true);
         }
+        SDL_SetNumberProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER, options->spirvOptimization);
+        if (options->optimizationLevel >= 0) {
+            SDL_SetNumberProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_OPTIMIZATION_LEVEL_NUMBER, options->optimizationLevel);
+        }
+        if (options->shaderModel != 0) {
+            SDL_SetNumberProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER, options->shaderModel);
+        }
+        if (options->enable16BitTypes) {
+            SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN, true);
+        }
 
         switch (destinationFormat) {
             case SHADERFORMAT_DXBC: {
-                Uint8 *buffer = SDL_ShaderCross_CompileDXBCFromSPIRV(
+                Uint8 *buffer = compile_from_spirv(
                     &spirvInfo,
-                    &bytecodeSize);
+                    SDL_GPU_SHADERFORMAT_DXBC,
+                    &bytecodeSize,
+                    compiled);
                 if (buffer == NULL) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to compile DXBC from SPIR-V: %s", SDL_GetError());
                     result = 1;
@@ -523,9 +1503,11 @@ int main(int argc, char *argv[])
             }
 
             case SHADERFORMAT_DXIL: {
-                Uint8 *buffer = SDL_ShaderCross_CompileDXILFromSPIRV(
+                Uint8 *buffer = compile_from_spirv(
                     &spirvInfo,
-                    &bytecodeSize);
+                    SDL_GPU_SHADERFORMAT_DXIL,
+                    &bytecodeSize,
+                    compiled);
                 if (buffer == NULL) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to compile DXIL from SPIR-V: %s", SDL_GetError());
                     result = 1;
@@ -537,8 +1519,11 @@ int main(int argc, char *argv[])
             }
 
             case SHADERFORMAT_MSL: {
-                char *buffer = SDL_ShaderCross_TranspileMSLFromSPIRV(
-                    &spirvInfo);
+                char *buffer = compile_from_spirv(
+                    &spirvInfo,
+                    SDL_GPU_SHADERFORMAT_MSL,
+                    &bytecodeSize,
+                    compiled);
                 if (buffer == NULL) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to transpile MSL from SPIR-V: %s", SDL_GetError());
                     result = 1;
@@ -563,8 +1548,22 @@ int main(int argc, char *argv[])
             }
 
             case SHADERFORMAT_SPIRV: {
-                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Input and output are both SPIRV. Did you mean to do that?");
-                result = 1;
+                if (!options->stripDebugInfo) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Input and output are both SPIRV. Did you mean to do that?");
+                    result = 1;
+                    break;
+                }
+                Uint8 *buffer = SDL_ShaderCross_StripSPIRV(
+                    fileData,
+                    fileSize,
+                    &bytecodeSize);
+                if (buffer == NULL) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to strip SPIRV: %s", SDL_GetError());
+                    result = 1;
+                } else {
+                    SDL_WriteIO(outputIO, buffer, bytecodeSize);
+                    SDL_free(buffer);
+                }
                 break;
             }
 
@@ -604,30 +1603,67 @@ int main(int argc, char *argv[])
             }
         }
 
+        if (result == 0 && compiled != NULL && destinationFormat == SHADERFORMAT_SPIRV && !reflect_compiled_shader(fileData, fileSize, shaderStage, &compiled->entry)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to reflect SPIRV: %s", SDL_GetError());
+            result = 1;
+        }
+
         SDL_DestroyProperties(spirvInfo.props);
     } else {
         SDL_ShaderCross_HLSL_Info hlslInfo;
         hlslInfo.source = fileData;
         hlslInfo.entrypoint = entrypointName;
-        hlslInfo.include_dir = includeDir;
-        hlslInfo.defines = defines;
+        hlslInfo.include_dir = options->includeDir;
+        hlslInfo.defines = options->defines;
         hlslInfo.shader_stage = shaderStage;
         hlslInfo.props = SDL_CreateProperties();
 
-        if (enableDebug) {
+        if (options->enableDebug) {
             SDL_SetBooleanProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, true);
             SDL_SetStringProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, filename);
         }
 
-        if (cullUnusedBindings) {
+        if (options->cullUnusedBindings) {
             SDL_SetBooleanProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_CULL_UNUSED_BINDINGS_BOOLEAN, true);
         }
 
+        if (options->roundtripMode != NULL) {
+            SDL_SetStringProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_HLSL_ROUNDTRIP_STRING, options->roundtripMode);
+        }
+
+        if (options->workingDir != NULL) {
+            SDL_SetStringProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_INCLUDE_BASE_DIRECTORY_STRING, options->workingDir);
+        }
+
+        SDL_ShaderCross_IncludeCallbackInfo includeCallback;
+        includeCallback.callback = record_dependency;
+        includeCallback.userdata = dependencies;
+        if (trackIncludes) {
+            SDL_SetPointerProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_INCLUDE_CALLBACK_POINTER, &includeCallback);
+        }
+
+        // Optimized once when compiling to SPIRV, the SPIRV infos created below for further stages leave it alone
+        SDL_SetNumberProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_SPIRV_OPTIMIZATION_NUMBER, options->spirvOptimization);
+        if (options->optimizationLevel >= 0) {
+            SDL_SetNumberProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_OPTIMIZATION_LEVEL_NUMBER, options->optimizationLevel);
+        }
+        if (options->shaderModel != 0) {
+            SDL_SetNumberProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER, options->shaderModel);
+        }
+        if (options->enable16BitTypes) {
+            SDL_SetBooleanProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN, true);
+        }
+
+        // Only the shipped SPIR-V is stripped, the other destinations reflect names from the intermediate SPIR-V
+        if (options->stripDebugInfo && destinationFormat == SHADERFORMAT_SPIRV) {
+            SDL_SetBooleanProperty(hlslInfo.props, SDL_SHADERCROSS_PROP_SHADER_STRIP_DEBUG_INFO_BOOLEAN, true);
+        }
+
         switch (destinationFormat) {
             case SHADERFORMAT_DXBC: {
-                Uint8 *buffer = SDL_ShaderCross_CompileDXBCFromHLSL(
-                    &hlslInfo,
-                    &bytecodeSize);
+                Uint8 *buffer = compiled != NULL ?
+                    compile_hlsl_through_spirv(options, &hlslInfo, SDL_GPU_SHADERFORMAT_DXBC, &bytecodeSize, compiled) :
+                    SDL_ShaderCross_CompileDXBCFromHLSL(&hlslInfo, &bytecodeSize);
                 if (buffer == NULL) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to compile DXBC from HLSL: %s", SDL_GetError());
                     result = 1;
@@ -639,9 +1675,9 @@ int main(int argc, char *argv[])
             }
 
             case SHADERFORMAT_DXIL: {
-                Uint8 *buffer = SDL_ShaderCross_CompileDXILFromHLSL(
-                    &hlslInfo,
-                    &bytecodeSize);
+                Uint8 *buffer = compiled != NULL ?
+                    compile_hlsl_through_spirv(options, &hlslInfo, SDL_GPU_SHADERFORMAT_DXIL, &bytecodeSize, compiled) :
+                    SDL_ShaderCross_CompileDXILFromHLSL(&hlslInfo, &bytecodeSize);
                 if (buffer == NULL) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to compile DXIL from HLSL: %s", SDL_GetError());
                     result = 1;
@@ -654,42 +1690,18 @@ int main(int argc, char *argv[])
 
             // TODO: Should we have TranspileMSLFromHLSL?
             case SHADERFORMAT_MSL: {
-                void *spirv = SDL_ShaderCross_CompileSPIRVFromHLSL(
+                char *buffer = compile_hlsl_through_spirv(
+                    options,
                     &hlslInfo,
-                    &bytecodeSize);
-                if (spirv == NULL) {
+                    SDL_GPU_SHADERFORMAT_MSL,
+                    &bytecodeSize,
+                    compiled);
+                if (buffer == NULL) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to transpile MSL from HLSL: %s", SDL_GetError());
                     result = 1;
                 } else {
-                    SDL_ShaderCross_SPIRV_Info spirvInfo;
-                    spirvInfo.bytecode = spirv;
-                    spirvInfo.bytecode_size = bytecodeSize;
-                    spirvInfo.entrypoint = entrypointName;
-                    spirvInfo.shader_stage = shaderStage;
-                    spirvInfo.props = SDL_CreateProperties();
-
-                    if (enableDebug) {
-                        SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, true);
-                        SDL_SetStringProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, filename);
-                    }
-                    if (cullUnusedBindings) {
-                        SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, true);
-                    }
-                    if (mslVersion) {
-                        SDL_SetStringProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SPIRV_MSL_VERSION_STRING, mslVersion);
-                    }
-
-                    char *buffer = SDL_ShaderCross_TranspileMSLFromSPIRV(
-                        &spirvInfo);
-                    if (buffer == NULL) {
-                        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to transpile MSL from HLSL: %s", SDL_GetError());
-                        result = 1;
-                    } else {
-                        SDL_IOprintf(outputIO, "%s", buffer);
-                        SDL_free(spirv);
-                        SDL_free(buffer);
-                    }
-                    SDL_DestroyProperties(spirvInfo.props);
+                    SDL_IOprintf(outputIO, "%s", buffer);
+                    SDL_free(buffer);
                 }
                 break;
             }
@@ -703,6 +1715,10 @@ int main(int argc, char *argv[])
                     result = 1;
                 } else {
                     SDL_WriteIO(outputIO, buffer, bytecodeSize);
+                    if (compiled != NULL && !reflect_compiled_shader(buffer, bytecodeSize, shaderStage, &compiled->entry)) {
+                        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to reflect SPIRV: %s", SDL_GetError());
+                        result = 1;
+                    }
                     SDL_free(buffer);
                 }
                 break;
@@ -726,19 +1742,27 @@ int main(int argc, char *argv[])
                 spirvInfo.shader_stage = shaderStage;
                 spirvInfo.props = SDL_CreateProperties();
 
-                if (enableDebug) {
+                if (options->enableDebug) {
                     SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_ENABLE_BOOLEAN, true);
                     SDL_SetStringProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_DEBUG_NAME_STRING, filename);
                 }
-                if (cullUnusedBindings) {
+                if (options->cullUnusedBindings) {
                     SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_CULL_UNUSED_BINDINGS_BOOLEAN, true);
                 }
-                if (psslCompat) {
+                if (options->psslCompat) {
                     SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SPIRV_PSSL_COMPATIBILITY_BOOLEAN, true);
                 }
+                if (options->shaderModel != 0) {
+                    SDL_SetNumberProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER, options->shaderModel);
+                }
+                if (options->enable16BitTypes) {
+                    SDL_SetBooleanProperty(spirvInfo.props, SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN, true);
+                }
 
                 char *buffer = SDL_ShaderCross_TranspileHLSLFromSPIRV(
                     &spirvInfo);
+                SDL_free(spirv);
+                SDL_DestroyProperties(spirvInfo.props);
 
                 if (buffer == NULL) {
                     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to transpile HLSL from SPIRV: %s", SDL_GetError());
@@ -747,9 +1771,7 @@ int main(int argc, char *argv[])
                 }
 
                 SDL_IOprintf(outputIO, "%s", buffer);
-                SDL_free(spirv);
                 SDL_free(buffer);
-                SDL_DestroyProperties(spirvInfo.props);
                 break;
             }
 
@@ -807,13 +1829,2295 @@ int main(int argc, char *argv[])
         SDL_DestroyProperties(hlslInfo.props);
     }
 
+    if (options->memStats) {
+        print_mem_stats(NULL);
+    }
+
+    void *outputData = SDL_GetPointerProperty(SDL_GetIOProperties(outputIO), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    Sint64 outputSize = SDL_TellIO(outputIO);
+    if (result == 0 && outputSize < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+        result = 1;
+    }
+
+    start_stopwatch(&stopwatch);
+    record_trace_event("write", NULL, true);
+    if (result == 0 && outputFilename != NULL) {
+        if (!write_option_file(options, outputFilename, outputData, (size_t)outputSize)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write %s: %s", outputFilename, SDL_GetError());
+            result = 1;
+        }
+    }
+
+    if (result == 0 && compiled != NULL) {
+        // Bundled MSL is null-terminated, like the MSL the library returns
+        bool terminate = destinationFormat == SHADERFORMAT_MSL;
+        compiled->codeSize = (size_t)outputSize + (terminate ? 1 : 0);
+        compiled->code = SDL_malloc(SDL_max(compiled->codeSize, 1));
+        // compile_from_spirv() already set the entry point that SPIRV-Cross may have renamed, SPIRV keeps its own
+        if (compiled->entrypoint == NULL) {
+            compiled->entrypoint = SDL_strdup(entrypointName);
+        }
+        if (compiled->code == NULL || compiled->entrypoint == NULL) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+            free_compiled_shader(compiled);
+            result = 1;
+        } else {
+            SDL_memcpy(compiled->code, outputData, (size_t)outputSize);
+            if (terminate) {
+                ((char *)compiled->code)[outputSize] = '\0';
+            }
+            compiled->entry.format = get_gpu_shader_format(destinationFormat);
+            compiled->entry.shader_stage = shaderStage;
+        }
+    }
+
+    // Written after the output, so that a build system never sees it newer than the output
+    if (result == 0 && !write_output_depfile(options, outputFilename, dependencies)) {
+        result = 1;
+    }
+    record_trace_event("write", NULL, false);
+    stop_stopwatch(&stopwatch, timings, TIME_STAGE_WRITE);
+
+    SDL_ShaderCross_TimingStats libraryTimings;
+    if (timed && SDL_ShaderCross_GetTimingStats(&libraryTimings)) {
+        for (int i = 0; i < SDL_SHADERCROSS_TIMINGSTAGE_COUNT; i += 1) {
+            timings->wallNS[TIME_STAGE_HLSL_TO_SPIRV + i] = libraryTimings.stages[i].wall_ns;
+            timings->cpuNS[TIME_STAGE_HLSL_TO_SPIRV + i] = libraryTimings.stages[i].cpu_ns;
+        }
+    }
+    timings->totalWallNS = SDL_GetTicksNS() - startNS;
+    if (printTimings) {
+        static const char *formatNames[] = { "", "SPIRV", "DXBC", "DXIL", "MSL", "HLSL", "JSON" };
+        SDL_Log("Time per stage of %s (%s):", outputFilename != NULL ? outputFilename : filename, formatNames[destinationFormat]);
+        print_timings(timings);
+    }
+
+    clear_dependencies(&localDependencies);
     SDL_CloseIO(outputIO);
-    SDL_free(fileData);
-    for (Uint32 i = 0; i < numDefines; i += 1) {
-        SDL_free(defines[i].name);
+    unload_input_file(&inputFile);
+    record_trace_event("compile", NULL, false);
+    return result;
+}
+
+/* C header output
+ *
+ * Replaces running test/embed.py after the CLI: each destination becomes a
+ * 16-byte aligned array next to the SDL_GPUShaderCreateInfo, or
+ * SDL_GPUComputePipelineCreateInfo, that creates the shader from it.
+ */
+
+#define EMBED_ALIGNMENT 16
+#define EMBED_BYTES_PER_LINE 16
+
+static void write_embedded_array(SDL_IOStream *io, const char *identifier, const Uint8 *data, size_t size)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+    char line[EMBED_BYTES_PER_LINE * 6 + 4];
+
+    SDL_IOprintf(io, "static SDL_ALIGNED(%d) const Uint8 %s[%" SDL_PRIu64 "] = {\n", EMBED_ALIGNMENT, identifier, (Uint64)size);
+    for (size_t i = 0; i < size; i += EMBED_BYTES_PER_LINE) {
+        size_t length = 0;
+        line[length++] = ' ';
+        line[length++] = ' ';
+        for (size_t j = i; j < size && j < i + EMBED_BYTES_PER_LINE; j += 1) {
+            line[length++] = '0';
+            line[length++] = 'x';
+            line[length++] = hexDigits[data[j] >> 4];
+            line[length++] = hexDigits[data[j] & 0xF];
+            line[length++] = ',';
+            line[length++] = ' ';
+        }
+        line[length - 1] = '\n';
+        SDL_WriteIO(io, line, length);
     }
-    SDL_free(defines);
-    SDL_ShaderCross_Quit();
+    SDL_IOprintf(io, "};\n\n");
+}
+
+static void write_embedded_info(SDL_IOStream *io, const char *prefix, const ShaderCross_CompiledShader *compiled)
+{
+    static const char *formatNames[] = { "INVALID", "SPIRV", "DXBC", "DXIL", "MSL" };
+    const SDL_ShaderCross_BundleEntry *entry = &compiled->entry;
+    const char *formatName = "INVALID";
+
+    for (int i = 0; i < (int)SDL_arraysize(formatNames); i += 1) {
+        if (get_gpu_shader_format((ShaderCross_ShaderFormat)i) == entry->format) {
+            formatName = formatNames[i];
+        }
+    }
+
+    // Positional initializers, so that the header also builds as C++
+    if (entry->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_COMPUTE) {
+        SDL_IOprintf(io, "static const SDL_GPUComputePipelineCreateInfo %s_info = {\n", prefix);
+        SDL_IOprintf(io, "    sizeof(%s_code), /* code_size */\n", prefix);
+        SDL_IOprintf(io, "    %s_code, /* code */\n", prefix);
+        SDL_IOprintf(io, "    \"%s\", /* entrypoint */\n", compiled->entrypoint);
+        SDL_IOprintf(io, "    SDL_GPU_SHADERFORMAT_%s, /* format */\n", formatName);
+        SDL_IOprintf(io, "    %u, /* num_samplers */\n", (unsigned int)entry->num_samplers);
+        SDL_IOprintf(io, "    %u, /* num_readonly_storage_textures */\n", (unsigned int)entry->num_readonly_storage_textures);
+        SDL_IOprintf(io, "    %u, /* num_readonly_storage_buffers */\n", (unsigned int)entry->num_readonly_storage_buffers);
+        SDL_IOprintf(io, "    %u, /* num_readwrite_storage_textures */\n", (unsigned int)entry->num_readwrite_storage_textures);
+        SDL_IOprintf(io, "    %u, /* num_readwrite_storage_buffers */\n", (unsigned int)entry->num_readwrite_storage_buffers);
+        SDL_IOprintf(io, "    %u, /* num_uniform_buffers */\n", (unsigned int)entry->num_uniform_buffers);
+        SDL_IOprintf(io, "    %u, /* threadcount_x */\n", (unsigned int)entry->threadcount_x);
+        SDL_IOprintf(io, "    %u, /* threadcount_y */\n", (unsigned int)entry->threadcount_y);
+        SDL_IOprintf(io, "    %u, /* threadcount_z */\n", (unsigned int)entry->threadcount_z);
+    } else {
+        SDL_IOprintf(io, "static const SDL_GPUShaderCreateInfo %s_info = {\n", prefix);
+        SDL_IOprintf(io, "    sizeof(%s_code), /* code_size */\n", prefix);
+        SDL_IOprintf(io, "    %s_code, /* code */\n", prefix);
+        SDL_IOprintf(io, "    \"%s\", /* entrypoint */\n", compiled->entrypoint);
+        SDL_IOprintf(io, "    SDL_GPU_SHADERFORMAT_%s, /* format */\n", formatName);
+        SDL_IOprintf(io, "    %s, /* stage */\n", entry->shader_stage == SDL_SHADERCROSS_SHADERSTAGE_VERTEX ? "SDL_GPU_SHADERSTAGE_VERTEX" : "SDL_GPU_SHADERSTAGE_FRAGMENT");
+        SDL_IOprintf(io, "    %u, /* num_samplers */\n", (unsigned int)entry->num_samplers);
+        SDL_IOprintf(io, "    %u, /* num_storage_textures */\n", (unsigned int)entry->num_readonly_storage_textures);
+        SDL_IOprintf(io, "    %u, /* num_storage_buffers */\n", (unsigned int)entry->num_readonly_storage_buffers);
+        SDL_IOprintf(io, "    %u, /* num_uniform_buffers */\n", (unsigned int)entry->num_uniform_buffers);
+    }
+    SDL_IOprintf(io, "    0 /* props */\n");
+    SDL_IOprintf(io, "};\n\n");
+}
+
+// Returns an SDL_malloc'd C identifier made from the input file name, minus its extension
+static char *get_embed_name(const ShaderCross_Options *options)
+{
+    if (options->embedName != NULL) {
+        for (const char *c = options->embedName; *c != '\0'; c += 1) {
+            if (!(SDL_isalnum(*c) || *c == '_') || (c == options->embedName && SDL_isdigit(*c))) {
+                SDL_SetError("%s is not a valid C identifier", options->embedName);
+                return NULL;
+            }
+        }
+        return SDL_strdup(options->embedName);
+    }
+    if (is_standard_stream(options->filename)) {
+        SDL_SetError("%s", "--embed-name is required with the standard input");
+        return NULL;
+    }
+
+    const char *fileName = get_file_name(options->filename);
+    const char *extension = SDL_strrchr(fileName, '.');
+    size_t length = (extension != NULL && extension != fileName) ? (size_t)(extension - fileName) : SDL_strlen(fileName);
+    char *name = (char *)SDL_malloc(length + 2);
+    if (name == NULL) {
+        return NULL;
+    }
+    size_t start = SDL_isdigit(fileName[0]) ? 1 : 0;
+    name[0] = '_';
+    for (size_t i = 0; i < length; i += 1) {
+        name[start + i] = (SDL_isalnum(fileName[i]) || fileName[i] == '_') ? fileName[i] : '_';
+    }
+    name[start + length] = '\0';
+    return name;
+}
+
+// Compiles the shader once per destination and writes all of them to one C header
+static int embed_shader(const ShaderCross_Options *options, ShaderCross_Dependencies *dependencies)
+{
+    static const char *suffixes[] = { "", "spirv", "dxbc", "dxil", "msl" };
+
+    if (options->outputFilename == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "--embed requires an output file");
+        return 1;
+    }
+    if (!options->destinationValid) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "--embed requires the destination formats, it can't infer them from a .h file name");
+        return 1;
+    }
+    if (options->embedFormats & ((1u << SHADERFORMAT_HLSL) | (1u << SHADERFORMAT_JSON))) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "Only DXBC, DXIL, MSL and SPIRV shaders can be bundled or embedded");
+        return 1;
+    }
+
+    char *name = get_embed_name(options);
+    if (name == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+        return 1;
+    }
+
+    SDL_IOStream *io = SDL_IOFromDynamicMem();
+    if (io == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+        SDL_free(name);
+        return 1;
+    }
+    SDL_IOprintf(io, "#pragma once\n");
+    SDL_IOprintf(io, "\n");
+    SDL_IOprintf(io, "// This file is auto-generated by shadercross. Manual modifications will be lost.\n");
+    SDL_IOprintf(io, "\n");
+    SDL_IOprintf(io, "#include <SDL3/SDL_gpu.h>\n");
+    SDL_IOprintf(io, "\n");
+
+    // The destinations all build from the same source, so the first one records the dependencies
+    ShaderCross_Dependencies localDependencies;
+    SDL_zero(localDependencies);
+    if (dependencies == NULL) {
+        dependencies = &localDependencies;
+    }
+
+    ShaderCross_Options targetOptions = *options;
+    targetOptions.outputFilename = NULL;
+    targetOptions.writeDepfile = false;
+
+    int result = 0;
+    bool first = true;
+    for (int format = SHADERFORMAT_SPIRV; result == 0 && format <= SHADERFORMAT_MSL; format += 1) {
+        if (!(options->embedFormats & (1u << format))) {
+            continue;
+        }
+        ShaderCross_CompiledShader compiled;
+        SDL_zero(compiled);
+        targetOptions.destinationFormat = (ShaderCross_ShaderFormat)format;
+        result = compile_shader(&targetOptions, first ? dependencies : NULL, &compiled, NULL);
+        first = false;
+        if (result == 0) {
+            char *prefix = NULL;
+            char *codeIdentifier = NULL;
+            SDL_asprintf(&prefix, "%s_%s", name, suffixes[format]);
+            SDL_asprintf(&codeIdentifier, "%s_code", prefix);
+            if (prefix == NULL || codeIdentifier == NULL) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+                result = 1;
+            } else {
+                write_embedded_array(io, codeIdentifier, (const Uint8 *)compiled.code, compiled.codeSize);
+                write_embedded_info(io, prefix, &compiled);
+            }
+            SDL_free(codeIdentifier);
+            SDL_free(prefix);
+        }
+        free_compiled_shader(&compiled);
+    }
+
+    if (result == 0) {
+        void *data = SDL_GetPointerProperty(SDL_GetIOProperties(io), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+        Sint64 size = SDL_TellIO(io);
+        if (size < 0 || !write_option_file(options, options->outputFilename, data, (size_t)size)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write %s: %s", options->outputFilename, SDL_GetError());
+            result = 1;
+        }
+    }
+    if (result == 0 && !write_output_depfile(options, options->outputFilename, dependencies)) {
+        result = 1;
+    }
+
+    clear_dependencies(&localDependencies);
+    SDL_CloseIO(io);
+    SDL_free(name);
+    return result;
+}
+
+#ifdef SHADERCROSS_WATCH
+
+/* Watch mode
+ *
+ * Directories are watched rather than files, because editors often save by
+ * writing a new file and renaming it over the old one. The process stays
+ * alive between rebuilds, so DXC is only loaded once.
+ */
+
+#define WATCH_SETTLE_MS 50
+
+typedef struct ShaderCross_Watch {
+    int fd;
+    int inputDir;
+    int includeDir;
+    const char *inputName;
+    const char *outputName;
+    bool outputInInputDir;
+    bool outputInIncludeDir;
+    bool spirvSource;
+    ShaderCross_Dependencies dependencies;
+    int *dependencyDirs;  // the watch descriptor of the directory of each dependency
+} ShaderCross_Watch;
+
+static bool has_include_extension(const char *name)
+{
+    static const char *extensions[] = { ".hlsl", ".hlsli", ".h", ".fxh", ".inc" };
+    const char *dot = SDL_strrchr(name, '.');
+    if (dot == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < SDL_arraysize(extensions); i += 1) {
+        if (SDL_strcasecmp(dot, extensions[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_watched_change(const ShaderCross_Watch *watch, const struct inotify_event *event)
+{
+    if (event->len == 0) {
+        return false;
+    }
+
+    // Our own output, and the temporary file it is written through, must not trigger a rebuild
+    bool isOutput = SDL_strncmp(event->name, watch->outputName, SDL_strlen(watch->outputName)) == 0;
+
+    if (event->wd == watch->inputDir) {
+        if (SDL_strcmp(event->name, watch->inputName) == 0) {
+            return true;
+        }
+        if (watch->outputInInputDir && isOutput) {
+            return false;
+        }
+        // Sibling headers may be included with quotes
+        if (!watch->spirvSource && has_include_extension(event->name)) {
+            return true;
+        }
+    }
+    if (event->wd == watch->includeDir) {
+        return !(watch->outputInIncludeDir && isOutput);
+    }
+    for (size_t i = 0; i < watch->dependencies.count; i += 1) {
+        if (event->wd == watch->dependencyDirs[i] && SDL_strcmp(event->name, get_file_name(watch->dependencies.paths[i])) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Includes can live anywhere, so the directory of each file the last build included is watched as well
+static void watch_dependencies(ShaderCross_Watch *watch)
+{
+    SDL_free(watch->dependencyDirs);
+    watch->dependencyDirs = (int *)SDL_malloc(sizeof(int) * SDL_max(watch->dependencies.count, 1));
+    if (watch->dependencyDirs == NULL) {
+        clear_dependencies(&watch->dependencies);
+        return;
+    }
+    for (size_t i = 0; i < watch->dependencies.count; i += 1) {
+        char *directory = get_parent_directory(watch->dependencies.paths[i]);
+        watch->dependencyDirs[i] = directory != NULL ? inotify_add_watch(watch->fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) : -1;
+        SDL_free(directory);
+    }
+}
+
+// Reads the pending events, returns true if one of them should trigger a rebuild
+static bool read_watch_events(const ShaderCross_Watch *watch, bool *failed)
+{
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+
+    ssize_t length = read(watch->fd, buffer, sizeof(buffer));
+    if (length < 0) {
+        *failed = errno != EINTR;
+        return false;
+    }
+    for (char *p = buffer; p < buffer + length; ) {
+        const struct inotify_event *event = (const struct inotify_event *)p;
+        if (is_watched_change(watch, event)) {
+            changed = true;
+        }
+        p += sizeof(struct inotify_event) + event->len;
+    }
+    return changed;
+}
+
+static int watch_shader(const ShaderCross_Options *options)
+{
+    ShaderCross_Watch watch;
+    const Uint32 mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    SDL_zero(watch);
+    watch.inputName = get_file_name(options->filename);
+    watch.outputName = get_file_name(options->outputFilename);
+    watch.spirvSource = options->sourceValid ? options->spirvSource : (SDL_strstr(options->filename, ".spv") != NULL);
+    watch.includeDir = -1;
+
+    watch.fd = inotify_init1(IN_CLOEXEC);
+    if (watch.fd < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to watch for changes: %s", strerror(errno));
+        return 1;
+    }
+
+    char *inputDir = get_parent_directory(options->filename);
+    char *outputDir = get_parent_directory(options->outputFilename);
+    watch.inputDir = inputDir != NULL ? inotify_add_watch(watch.fd, inputDir, mask) : -1;
+    if (watch.inputDir < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to watch %s: %s", inputDir ? inputDir : options->filename, strerror(errno));
+        SDL_free(inputDir);
+        SDL_free(outputDir);
+        close(watch.fd);
+        return 1;
+    }
+    if (options->includeDir != NULL && !watch.spirvSource) {
+        watch.includeDir = inotify_add_watch(watch.fd, options->includeDir, mask);
+        if (watch.includeDir < 0) {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Failed to watch %s: %s", options->includeDir, strerror(errno));
+        }
+    }
+
+    // inotify hands out the same descriptor for the same directory
+    if (outputDir != NULL) {
+        int outputWatch = inotify_add_watch(watch.fd, outputDir, mask);
+        watch.outputInInputDir = outputWatch == watch.inputDir;
+        watch.outputInIncludeDir = outputWatch == watch.includeDir;
+        if (outputWatch >= 0 && !watch.outputInInputDir && !watch.outputInIncludeDir) {
+            inotify_rm_watch(watch.fd, outputWatch);
+        }
+    }
+    SDL_free(inputDir);
+    SDL_free(outputDir);
+
+    int result = compile_shader(options, &watch.dependencies, NULL, NULL);
+    watch_dependencies(&watch);
+    SDL_Log("Watching %s for changes", options->filename);
+
+    for (;;) {
+        bool failed = false;
+        if (!read_watch_events(&watch, &failed)) {
+            if (failed) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to watch for changes: %s", strerror(errno));
+                break;
+            }
+            continue;
+        }
+
+        // Editors often save in several steps, wait for them to settle before rebuilding
+        struct pollfd pending = { watch.fd, POLLIN, 0 };
+        while (!failed && poll(&pending, 1, WATCH_SETTLE_MS) > 0) {
+            read_watch_events(&watch, &failed);
+        }
+
+        result = compile_shader(options, &watch.dependencies, NULL, NULL);
+        watch_dependencies(&watch);
+        if (result == 0) {
+            SDL_Log("Rebuilt %s", options->outputFilename);
+        }
+    }
+
+    clear_dependencies(&watch.dependencies);
+    SDL_free(watch.dependencyDirs);
+    close(watch.fd);
+    return result != 0 ? result : 1;
+}
+
+#endif /* SHADERCROSS_WATCH */
+
+static bool memStatsEnabled = false;
+
+/* Manifest builds
+ *
+ * --manifest builds every shader listed in a JSON file in one process, on a
+ * pool of worker threads:
+ *
+ * {
+ *     "args": [ "-O" ],
+ *     "shaders": [
+ *         {
+ *             "source": "lighting.frag.hlsl",
+ *             "stage": "fragment",
+ *             "entrypoint": "main",
+ *             "include_dir": "include",
+ *             "defines": { "SHADOWS": "1", "FAST_PATH": null },
+ *             "args": [ "--shader-model", "6.5" ],
+ *             "targets": { "dxil": "out/lighting.frag.dxil", "msl": "out/lighting.frag.msl" }
+ *         },
+ *         {
+ *             "name": "blur",
+ *             "source": "blur.comp.hlsl",
+ *             "targets": [ "dxil", "msl", "spirv" ]
+ *         }
+ *     ]
+ * }
+ *
+ * Everything but "source" and "targets" is optional. "include_dir" may also be
+ * an array, but of one directory at most, as that is all SDL_shadercross takes.
+ * Relative paths are relative to the manifest. Each target becomes a job with
+ * its own command line: the manifest "args", the options given next to
+ * --manifest, the shader's fields and "args", then the target.
+ *
+ * With --bundle, the DXBC, DXIL, MSL and SPIRV targets are also packed into a
+ * shader bundle under the shader's "name", which defaults to its "source" as
+ * written. Targets given as an array of formats only go into the bundle.
+ */
+
+#define JSON_MAX_DEPTH 64
+
+typedef enum ShaderCross_JSONType {
+    JSON_TYPE_NULL,
+    JSON_TYPE_BOOLEAN,
+    JSON_TYPE_NUMBER,
+    JSON_TYPE_STRING,
+    JSON_TYPE_ARRAY,
+    JSON_TYPE_OBJECT
+} ShaderCross_JSONType;
+
+typedef struct ShaderCross_JSONValue {
+    ShaderCross_JSONType type;
+    char *key;       // the member name when inside an object
+    char *string;    // the contents of strings, and the text of numbers
+    bool boolean;
+    struct ShaderCross_JSONValue *children;  // array elements or object members
+    size_t numChildren;
+} ShaderCross_JSONValue;
+
+typedef struct ShaderCross_JSONParser {
+    const char *filename;
+    const char *at;
+    const char *end;
+    int line;
+} ShaderCross_JSONParser;
+
+static void free_json_value(ShaderCross_JSONValue *value)
+{
+    for (size_t i = 0; i < value->numChildren; i += 1) {
+        free_json_value(&value->children[i]);
+    }
+    SDL_free(value->children);
+    SDL_free(value->key);
+    SDL_free(value->string);
+    SDL_zerop(value);
+}
+
+static bool json_error(ShaderCross_JSONParser *parser, const char *message)
+{
+    return SDL_SetError("%s:%d: %s", parser->filename, parser->line, message);
+}
+
+static void skip_json_whitespace(ShaderCross_JSONParser *parser)
+{
+    while (parser->at < parser->end && (*parser->at == ' ' || *parser->at == '\t' || *parser->at == '\r' || *parser->at == '\n')) {
+        if (*parser->at == '\n') {
+            parser->line += 1;
+        }
+        parser->at += 1;
+    }
+}
+
+static bool parse_json_hex(ShaderCross_JSONParser *parser, Uint32 *codepoint)
+{
+    *codepoint = 0;
+    for (int i = 0; i < 4; i += 1) {
+        if (parser->at >= parser->end || !SDL_isxdigit((unsigned char)*parser->at)) {
+            return json_error(parser, "Invalid \\u escape");
+        }
+        char c = *parser->at++;
+        *codepoint = (*codepoint << 4) | (Uint32)(SDL_isdigit((unsigned char)c) ? c - '0' : (SDL_tolower((unsigned char)c) - 'a' + 10));
+    }
+    return true;
+}
+
+static size_t encode_utf8(Uint32 codepoint, char *dst)
+{
+    if (codepoint < 0x80) {
+        dst[0] = (char)codepoint;
+        return 1;
+    } else if (codepoint < 0x800) {
+        dst[0] = (char)(0xC0 | (codepoint >> 6));
+        dst[1] = (char)(0x80 | (codepoint & 0x3F));
+        return 2;
+    } else if (codepoint < 0x10000) {
+        dst[0] = (char)(0xE0 | (codepoint >> 12));
+        dst[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        dst[2] = (char)(0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+    dst[0] = (char)(0xF0 | (codepoint >> 18));
+    dst[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+    dst[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+    dst[3] = (char)(0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+static bool parse_json_string(ShaderCross_JSONParser *parser, char **string)
+{
+    parser->at += 1; // opening quote
+
+    // Escapes never make the string longer
+    const char *start = parser->at;
+    char *dst = (char *)SDL_malloc(parser->end - start + 1);
+    size_t length = 0;
+    if (dst == NULL) {
+        return false;
+    }
+
+    while (parser->at < parser->end && *parser->at != '"') {
+        char c = *parser->at++;
+        if ((unsigned char)c < 0x20) {
+            SDL_free(dst);
+            return json_error(parser, "Unescaped control character in string");
+        }
+        if (c != '\\') {
+            dst[length++] = c;
+            continue;
+        }
+        if (parser->at >= parser->end) {
+            break;
+        }
+        c = *parser->at++;
+        switch (c) {
+            case '"': dst[length++] = '"'; break;
+            case '\\': dst[length++] = '\\'; break;
+            case '/': dst[length++] = '/'; break;
+            case 'b': dst[length++] = '\b'; break;
+            case 'f': dst[length++] = '\f'; break;
+            case 'n': dst[length++] = '\n'; break;
+            case 'r': dst[length++] = '\r'; break;
+            case 't': dst[length++] = '\t'; break;
+            case 'u': {
+                Uint32 codepoint;
+                if (!parse_json_hex(parser, &codepoint)) {
+                    SDL_free(dst);
+                    return false;
+                }
+                // Characters outside the BMP are escaped as a surrogate pair
+                if (codepoint >= 0xD800 && codepoint < 0xDC00 && parser->end - parser->at >= 6 && parser->at[0] == '\\' && parser->at[1] == 'u') {
+                    Uint32 low;
+                    parser->at += 2;
+                    if (!parse_json_hex(parser, &low)) {
+                        SDL_free(dst);
+                        return false;
+                    }
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        SDL_free(dst);
+                        return json_error(parser, "Invalid surrogate pair");
+                    }
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                if (codepoint == 0) {
+                    SDL_free(dst);
+                    return json_error(parser, "Strings can't contain NUL characters");
+                }
+                length += encode_utf8(codepoint, dst + length);
+                break;
+            }
+            default:
+                SDL_free(dst);
+                return json_error(parser, "Invalid escape sequence");
+        }
+    }
+
+    if (parser->at >= parser->end) {
+        SDL_free(dst);
+        return json_error(parser, "Unterminated string");
+    }
+    parser->at += 1; // closing quote
+    dst[length] = '\0';
+    *string = dst;
+    return true;
+}
+
+static bool parse_json_value(ShaderCross_JSONParser *parser, ShaderCross_JSONValue *value, int depth);
+
+static bool parse_json_children(ShaderCross_JSONParser *parser, ShaderCross_JSONValue *value, int depth)
+{
+    bool object = value->type == JSON_TYPE_OBJECT;
+    char closing = object ? '}' : ']';
+
+    parser->at += 1; // opening bracket
+    skip_json_whitespace(parser);
+    if (parser->at < parser->end && *parser->at == closing) {
+        parser->at += 1;
+        return true;
+    }
+
+    for (;;) {
+        char *key = NULL;
+        if (object) {
+            skip_json_whitespace(parser);
+            if (parser->at >= parser->end || *parser->at != '"') {
+                return json_error(parser, "Expected a member name");
+            }
+            if (!parse_json_string(parser, &key)) {
+                return false;
+            }
+            skip_json_whitespace(parser);
+            if (parser->at >= parser->end || *parser->at != ':') {
+                SDL_free(key);
+                return json_error(parser, "Expected ':' after the member name");
+            }
+            parser->at += 1;
+        }
+
+        ShaderCross_JSONValue *children = (ShaderCross_JSONValue *)SDL_realloc(value->children, sizeof(ShaderCross_JSONValue) * (value->numChildren + 1));
+        if (children == NULL) {
+            SDL_free(key);
+            return false;
+        }
+        value->children = children;
+        ShaderCross_JSONValue *child = &children[value->numChildren++];
+        SDL_zerop(child);
+        child->key = key;
+        if (!parse_json_value(parser, child, depth + 1)) {
+            return false;
+        }
+
+        skip_json_whitespace(parser);
+        if (parser->at < parser->end && *parser->at == ',') {
+            parser->at += 1;
+        } else if (parser->at < parser->end && *parser->at == closing) {
+            parser->at += 1;
+            return true;
+        } else {
+            return json_error(parser, object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+        }
+    }
+}
+
+static bool parse_json_value(ShaderCross_JSONParser *parser, ShaderCross_JSONValue *value, int depth)
+{
+    if (depth > JSON_MAX_DEPTH) {
+        return json_error(parser, "Too deeply nested");
+    }
+
+    skip_json_whitespace(parser);
+    if (parser->at >= parser->end) {
+        return json_error(parser, "Unexpected end of file");
+    }
+
+    size_t remaining = parser->end - parser->at;
+    char c = *parser->at;
+    if (c == '{') {
+        value->type = JSON_TYPE_OBJECT;
+        return parse_json_children(parser, value, depth);
+    } else if (c == '[') {
+        value->type = JSON_TYPE_ARRAY;
+        return parse_json_children(parser, value, depth);
+    } else if (c == '"') {
+        value->type = JSON_TYPE_STRING;
+        return parse_json_string(parser, &value->string);
+    } else if (remaining >= 4 && SDL_strncmp(parser->at, "null", 4) == 0) {
+        value->type = JSON_TYPE_NULL;
+        parser->at += 4;
+        return true;
+    } else if (remaining >= 4 && SDL_strncmp(parser->at, "true", 4) == 0) {
+        value->type = JSON_TYPE_BOOLEAN;
+        value->boolean = true;
+        parser->at += 4;
+        return true;
+    } else if (remaining >= 5 && SDL_strncmp(parser->at, "false", 5) == 0) {
+        value->type = JSON_TYPE_BOOLEAN;
+        value->boolean = false;
+        parser->at += 5;
+        return true;
+    } else if (c == '-' || SDL_isdigit((unsigned char)c)) {
+        // Numbers are only ever passed on as text, so they are kept as written
+        const char *start = parser->at;
+        while (parser->at < parser->end && (SDL_isdigit((unsigned char)*parser->at) || SDL_strchr("+-.eE", *parser->at) != NULL)) {
+            parser->at += 1;
+        }
+        value->type = JSON_TYPE_NUMBER;
+        value->string = SDL_strndup(start, parser->at - start);
+        if (value->string == NULL) {
+            return false;
+        }
+        char *numberEnd = NULL;
+        SDL_strtod(value->string, &numberEnd);
+        if (numberEnd == value->string || *numberEnd != '\0') {
+            return json_error(parser, "Invalid number");
+        }
+        return true;
+    }
+    return json_error(parser, "Unexpected character");
+}
+
+static bool parse_json(const char *filename, const char *text, size_t length, ShaderCross_JSONValue *root)
+{
+    ShaderCross_JSONParser parser;
+    parser.filename = filename;
+    parser.at = text;
+    parser.end = text + length;
+    parser.line = 1;
+
+    SDL_zerop(root);
+    if (!parse_json_value(&parser, root, 0)) {
+        free_json_value(root);
+        return false;
+    }
+    skip_json_whitespace(&parser);
+    if (parser.at != parser.end) {
+        free_json_value(root);
+        return json_error(&parser, "Unexpected data after the end of the manifest");
+    }
+    return true;
+}
+
+static const ShaderCross_JSONValue *find_json_member(const ShaderCross_JSONValue *object, const char *key)
+{
+    for (size_t i = 0; i < object->numChildren; i += 1) {
+        if (SDL_strcmp(object->children[i].key, key) == 0) {
+            return &object->children[i];
+        }
+    }
+    return NULL;
+}
+
+static void write_json_string(SDL_IOStream *io, const char *string)
+{
+    SDL_IOprintf(io, "\"");
+    for (const char *c = string; *c != '\0'; c += 1) {
+        if (*c == '"' || *c == '\\') {
+            SDL_IOprintf(io, "\\%c", *c);
+        } else if ((unsigned char)*c < 0x20) {
+            SDL_IOprintf(io, "\\u%04x", (unsigned)(unsigned char)*c);
+        } else {
+            SDL_WriteIO(io, c, 1);
+        }
+    }
+    SDL_IOprintf(io, "\"");
+}
+
+typedef struct ShaderCross_ArgList {
+    char **args;
+    int count;
+} ShaderCross_ArgList;
+
+// Takes ownership of arg
+static bool push_arg(ShaderCross_ArgList *list, char *arg)
+{
+    if (arg == NULL) {
+        return false;
+    }
+    char **args = (char **)SDL_realloc(list->args, sizeof(char *) * (list->count + 2));
+    if (args == NULL) {
+        SDL_free(arg);
+        return false;
+    }
+    list->args = args;
+    list->args[list->count++] = arg;
+    list->args[list->count] = NULL;
+    return true;
+}
+
+static void free_args(ShaderCross_ArgList *list)
+{
+    for (int i = 0; i < list->count; i += 1) {
+        SDL_free(list->args[i]);
+    }
+    SDL_free(list->args);
+    SDL_zerop(list);
+}
+
+typedef struct ShaderCross_ManifestJob {
+    ShaderCross_ArgList args;
+    const char *source;  // points into args
+    const char *target;
+    const char *output;  // NULL when the shader only goes into the bundle
+    char *name;          // the bundle entry name, NULL when the shader isn't bundled
+    ShaderCross_CompiledShader compiled;
+    int result;
+    Uint64 elapsedNS;
+    bool timed;
+    ShaderCross_Timings timings;
+    SDL_ShaderCross_MemoryStats memStats;  // recorded on the worker thread that built the job
+} ShaderCross_ManifestJob;
+
+typedef struct ShaderCross_Manifest {
+    ShaderCross_ManifestJob *jobs;
+    int numJobs;
+    bool bundle;
+    SDL_AtomicInt nextJob;
+} ShaderCross_Manifest;
+
+static const char *manifestTargets[] = { "dxbc", "dxil", "msl", "spirv", "hlsl", "json" };
+#define NUM_BUNDLE_TARGETS 4 // the leading targets that can be bundled
+
+static bool push_json_args(ShaderCross_ArgList *list, const ShaderCross_JSONValue *args)
+{
+    if (args->type != JSON_TYPE_ARRAY) {
+        return SDL_SetError("%s", "\"args\" must be an array of strings");
+    }
+    for (size_t i = 0; i < args->numChildren; i += 1) {
+        if (args->children[i].type != JSON_TYPE_STRING && args->children[i].type != JSON_TYPE_NUMBER) {
+            return SDL_SetError("%s", "\"args\" must be an array of strings");
+        }
+        if (!push_arg(list, SDL_strdup(args->children[i].string))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Builds the command line shared by the targets of a shader, without the target itself
+static bool build_shader_args(ShaderCross_ArgList *list, const ShaderCross_JSONValue *shader, const char *baseDir)
+{
+    const ShaderCross_JSONValue *member;
+
+    member = find_json_member(shader, "stage");
+    if (member != NULL) {
+        if (member->type != JSON_TYPE_STRING ||
+            (SDL_strcasecmp(member->string, "vertex") != 0 && SDL_strcasecmp(member->string, "fragment") != 0 && SDL_strcasecmp(member->string, "compute") != 0)) {
+            return SDL_SetError("%s", "\"stage\" must be vertex, fragment or compute");
+        }
+        if (!push_arg(list, SDL_strdup("-t")) || !push_arg(list, SDL_strdup(member->string))) {
+            return false;
+        }
+    }
+
+    member = find_json_member(shader, "entrypoint");
+    if (member != NULL) {
+        if (member->type != JSON_TYPE_STRING) {
+            return SDL_SetError("%s", "\"entrypoint\" must be a string");
+        }
+        if (!push_arg(list, SDL_strdup("-e")) || !push_arg(list, SDL_strdup(member->string))) {
+            return false;
+        }
+    }
+
+    // SDL_shadercross takes a single include directory, so an array may only hold one
+    member = find_json_member(shader, "include_dir");
+    if (member != NULL && member->type == JSON_TYPE_ARRAY) {
+        if (member->numChildren > 1) {
+            return SDL_SetError("\"include_dir\" has %d directories, but SDL_shadercross supports a single include directory", (int)member->numChildren);
+        }
+        member = member->numChildren == 1 ? &member->children[0] : NULL;
+    }
+    if (member != NULL) {
+        if (member->type != JSON_TYPE_STRING) {
+            return SDL_SetError("%s", "\"include_dir\" must be a string or an array of one string");
+        }
+        if (!push_arg(list, SDL_strdup("-I")) || !push_arg(list, resolve_path(baseDir, member->string))) {
+            return false;
+        }
+    }
+
+    member = find_json_member(shader, "defines");
+    if (member != NULL) {
+        if (member->type != JSON_TYPE_OBJECT) {
+            return SDL_SetError("%s", "\"defines\" must be an object");
+        }
+        for (size_t i = 0; i < member->numChildren; i += 1) {
+            const ShaderCross_JSONValue *define = &member->children[i];
+            char *arg = NULL;
+            if (define->type == JSON_TYPE_NULL) {
+                SDL_asprintf(&arg, "-D%s", define->key);
+            } else if (define->type == JSON_TYPE_STRING || define->type == JSON_TYPE_NUMBER) {
+                SDL_asprintf(&arg, "-D%s=%s", define->key, define->string);
+            } else {
+                return SDL_SetError("Define %s must be a string, a number or null", define->key);
+            }
+            if (!push_arg(list, arg)) {
+                return false;
+            }
+        }
+    }
+
+    member = find_json_member(shader, "args");
+    if (member != NULL && !push_json_args(list, member)) {
+        return false;
+    }
+    return true;
+}
+
+static bool add_manifest_jobs(ShaderCross_Manifest *manifest, const ShaderCross_JSONValue *shader, const char *baseDir, const ShaderCross_ArgList *commonArgs)
+{
+    ShaderCross_ArgList shaderArgs;
+    SDL_zero(shaderArgs);
+
+    if (shader->type != JSON_TYPE_OBJECT) {
+        return SDL_SetError("%s", "Shaders must be objects");
+    }
+    const ShaderCross_JSONValue *source = find_json_member(shader, "source");
+    if (source == NULL || source->type != JSON_TYPE_STRING) {
+        return SDL_SetError("%s", "\"source\" must be a string");
+    }
+    const ShaderCross_JSONValue *targets = find_json_member(shader, "targets");
+    if (targets == NULL || (targets->type != JSON_TYPE_OBJECT && targets->type != JSON_TYPE_ARRAY) || targets->numChildren == 0) {
+        return SDL_SetError("%s", "\"targets\" must be an object mapping formats to output paths, or an array of formats to bundle");
+    }
+    if (targets->type == JSON_TYPE_ARRAY && !manifest->bundle) {
+        return SDL_SetError("%s", "Targets without an output path need --bundle");
+    }
+    const ShaderCross_JSONValue *name = find_json_member(shader, "name");
+    if (name != NULL && name->type != JSON_TYPE_STRING) {
+        return SDL_SetError("%s", "\"name\" must be a string");
+    }
+    if (!build_shader_args(&shaderArgs, shader, baseDir)) {
+        free_args(&shaderArgs);
+        return false;
+    }
+
+    ShaderCross_ManifestJob *jobs = (ShaderCross_ManifestJob *)SDL_realloc(manifest->jobs, sizeof(ShaderCross_ManifestJob) * (manifest->numJobs + targets->numChildren));
+    if (jobs == NULL) {
+        free_args(&shaderArgs);
+        return false;
+    }
+    manifest->jobs = jobs;
+
+    bool success = true;
+    for (size_t i = 0; success && i < targets->numChildren; i += 1) {
+        const ShaderCross_JSONValue *target = &targets->children[i];
+        const char *targetName = targets->type == JSON_TYPE_ARRAY ? target->string : target->key;
+        const char *format = NULL;
+        bool bundled = false;
+        if (targetName == NULL) {
+            success = SDL_SetError("%s", "Targets must be strings");
+            break;
+        }
+        for (size_t j = 0; j < SDL_arraysize(manifestTargets); j += 1) {
+            if (SDL_strcasecmp(targetName, manifestTargets[j]) == 0) {
+                format = manifestTargets[j];
+                bundled = manifest->bundle && j < NUM_BUNDLE_TARGETS;
+            }
+        }
+        if (format == NULL) {
+            success = SDL_SetError("Unknown target %s, valid targets are dxbc, dxil, msl, spirv, hlsl and json", targetName);
+            break;
+        }
+        if (targets->type == JSON_TYPE_ARRAY && !bundled) {
+            success = SDL_SetError("Target %s can't be bundled, it needs an output path", targetName);
+            break;
+        }
+        if (targets->type == JSON_TYPE_OBJECT && target->type != JSON_TYPE_STRING) {
+            success = SDL_SetError("The output of target %s must be a string", targetName);
+            break;
+        }
+
+        ShaderCross_ManifestJob *job = &manifest->jobs[manifest->numJobs];
+        SDL_zerop(job);
+        for (int j = 0; success && j < commonArgs->count; j += 1) {
+            success = push_arg(&job->args, SDL_strdup(commonArgs->args[j]));
+        }
+        for (int j = 0; success && j < shaderArgs.count; j += 1) {
+            success = push_arg(&job->args, SDL_strdup(shaderArgs.args[j]));
+        }
+        success = success &&
+            push_arg(&job->args, SDL_strdup("-d")) &&
+            push_arg(&job->args, SDL_strdup(format));
+        if (success && targets->type == JSON_TYPE_OBJECT) {
+            success = push_arg(&job->args, SDL_strdup("-o")) &&
+                push_arg(&job->args, resolve_path(baseDir, target->string));
+            job->output = success ? job->args.args[job->args.count - 1] : NULL;
+        }
+        success = success &&
+            push_arg(&job->args, SDL_strdup("--")) &&
+            push_arg(&job->args, resolve_path(baseDir, source->string));
+        if (success && bundled) {
+            job->name = SDL_strdup(name != NULL ? name->string : source->string);
+            success = job->name != NULL;
+        }
+        if (!success) {
+            free_args(&job->args);
+            SDL_free(job->name);
+            break;
+        }
+        job->source = job->args.args[job->args.count - 1];
+        job->target = format;
+        manifest->numJobs += 1;
+    }
+
+    free_args(&shaderArgs);
+    return success;
+}
+
+// Fills in the jobs of the manifest, manifest->bundle must be set already
+static bool load_manifest(const char *filename, const ShaderCross_ArgList *cliArgs, ShaderCross_Manifest *manifest)
+{
+    ShaderCross_JSONValue root;
+    ShaderCross_ArgList commonArgs;
+    size_t length;
+    bool success = true;
+
+    char *text = (char *)SDL_LoadFile(filename, &length);
+    if (text == NULL) {
+        return false;
+    }
+    success = parse_json(filename, text, length, &root);
+    SDL_free(text);
+    if (!success) {
+        return false;
+    }
+
+    // argv[0], then the manifest's args, then the command line's, so that the command line wins
+    SDL_zero(commonArgs);
+    success = push_arg(&commonArgs, SDL_strdup(cliArgs->args[0]));
+
+    const ShaderCross_JSONValue *args = root.type == JSON_TYPE_OBJECT ? find_json_member(&root, "args") : NULL;
+    if (success && args != NULL) {
+        success = push_json_args(&commonArgs, args);
+    }
+    for (int i = 1; success && i < cliArgs->count; i += 1) {
+        success = push_arg(&commonArgs, SDL_strdup(cliArgs->args[i]));
+    }
+
+    const ShaderCross_JSONValue *shaders = root.type == JSON_TYPE_OBJECT ? find_json_member(&root, "shaders") : NULL;
+    if (success && (shaders == NULL || shaders->type != JSON_TYPE_ARRAY)) {
+        success = SDL_SetError("%s: \"shaders\" must be an array", filename);
+    }
+
+    char *baseDir = get_parent_directory(filename);
+    success = success && baseDir != NULL;
+    for (size_t i = 0; success && i < shaders->numChildren; i += 1) {
+        if (!add_manifest_jobs(manifest, &shaders->children[i], baseDir, &commonArgs)) {
+            // Keep the error, but point at the offending shader
+            char *error = SDL_strdup(SDL_GetError());
+            SDL_SetError("%s: shaders[%d]: %s", filename, (int)i, error ? error : "");
+            SDL_free(error);
+            success = false;
+        }
+    }
+
+    SDL_free(baseDir);
+    free_args(&commonArgs);
+    free_json_value(&root);
+    return success;
+}
+
+static void free_manifest(ShaderCross_Manifest *manifest)
+{
+    for (int i = 0; i < manifest->numJobs; i += 1) {
+        free_args(&manifest->jobs[i].args);
+        free_compiled_shader(&manifest->jobs[i].compiled);
+        SDL_free(manifest->jobs[i].name);
+    }
+    SDL_free(manifest->jobs);
+    SDL_zerop(manifest);
+}
+
+static int SDLCALL run_manifest_jobs(void *data)
+{
+    ShaderCross_Manifest *manifest = (ShaderCross_Manifest *)data;
+
+    for (;;) {
+        int index = SDL_AddAtomicInt(&manifest->nextJob, 1);
+        if (index >= manifest->numJobs) {
+            break;
+        }
+
+        ShaderCross_ManifestJob *job = &manifest->jobs[index];
+        ShaderCross_Options options;
+        Uint64 start = SDL_GetTicksNS();
+
+        if (parse_options(job->args.count, job->args.args, &options, &job->result, job->name == NULL)) {
+            if (options.watch) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "--watch can't be used in a manifest build");
+                job->result = 1;
+            } else {
+                // The statistics are per thread, so each job records its own and they are printed once for the whole build
+                options.memStats = false;
+                job->timed = options.time;
+                if (memStatsEnabled) {
+                    SDL_ShaderCross_ResetMemoryStats();
+                }
+                job->result = compile_shader(&options, NULL, job->name != NULL ? &job->compiled : NULL, options.time ? &job->timings : NULL);
+                if (memStatsEnabled && !SDL_ShaderCross_GetMemoryStats(&job->memStats)) {
+                    SDL_zero(job->memStats);
+                }
+            }
+        }
+        free_options(&options);
+
+        job->elapsedNS = SDL_GetTicksNS() - start;
+        if (job->result != 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to build the %s target of %s", job->target, job->source);
+        }
+    }
+    return 0;
+}
+
+static bool write_manifest_summary(const char *filename, const ShaderCross_Manifest *manifest, int numFailed, Uint64 elapsedNS)
+{
+    SDL_IOStream *io = SDL_IOFromDynamicMem();
+    if (io == NULL) {
+        return false;
+    }
+
+    SDL_IOprintf(io, "{\n  \"succeeded\": %d,\n  \"failed\": %d,\n  \"seconds\": %.3f,\n  \"results\": [\n",
+        manifest->numJobs - numFailed, numFailed, (double)elapsedNS / SDL_NS_PER_SECOND);
+    for (int i = 0; i < manifest->numJobs; i += 1) {
+        const ShaderCross_ManifestJob *job = &manifest->jobs[i];
+        SDL_IOprintf(io, "    { \"source\": ");
+        write_json_string(io, job->source);
+        SDL_IOprintf(io, ", \"target\": \"%s\", \"output\": ", job->target);
+        if (job->output != NULL) {
+            write_json_string(io, job->output);
+        } else {
+            SDL_IOprintf(io, "null");
+        }
+        SDL_IOprintf(io, ", \"status\": \"%s\", \"milliseconds\": %.3f",
+            job->result == 0 ? "ok" : "failed",
+            (double)job->elapsedNS / SDL_NS_PER_MS);
+        if (job->timed) {
+            SDL_IOprintf(io, ", \"stages\": {");
+            for (int j = 0; j < TIME_STAGE_COUNT; j += 1) {
+                SDL_IOprintf(io, "%s \"%s\": { \"wall\": %.3f, \"cpu\": %.3f }", j > 0 ? "," : "", timeStageNames[j],
+                    (double)job->timings.wallNS[j] / SDL_NS_PER_MS, (double)job->timings.cpuNS[j] / SDL_NS_PER_MS);
+            }
+            SDL_IOprintf(io, " }");
+        }
+        SDL_IOprintf(io, " }%s\n", i + 1 < manifest->numJobs ? "," : "");
+    }
+    SDL_IOprintf(io, "  ]\n}\n");
+
+    void *data = SDL_GetPointerProperty(SDL_GetIOProperties(io), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    Sint64 size = SDL_TellIO(io);
+    bool success = size >= 0 && write_output_file(filename, data, (size_t)size);
+    SDL_CloseIO(io);
+    return success;
+}
+
+#define MANIFEST_SLOWEST_SHADERS 5
+
+static void print_manifest_timings(const ShaderCross_Manifest *manifest)
+{
+    const ShaderCross_ManifestJob *slowest[MANIFEST_SLOWEST_SHADERS];
+    int numSlowest = 0;
+    int numTimed = 0;
+    ShaderCross_Timings sum;
+    SDL_zero(sum);
+
+    for (int i = 0; i < manifest->numJobs; i += 1) {
+        const ShaderCross_ManifestJob *job = &manifest->jobs[i];
+        if (!job->timed) {
+            continue;
+        }
+        numTimed += 1;
+        add_timings(&sum, &job->timings);
+
+        // Insertion into the short list, slowest first
+        int slot = numSlowest;
+        while (slot > 0 && slowest[slot - 1]->timings.totalWallNS < job->timings.totalWallNS) {
+            if (slot < MANIFEST_SLOWEST_SHADERS) {
+                slowest[slot] = slowest[slot - 1];
+            }
+            slot -= 1;
+        }
+        if (slot < MANIFEST_SLOWEST_SHADERS) {
+            slowest[slot] = job;
+            numSlowest = SDL_min(numSlowest + 1, MANIFEST_SLOWEST_SHADERS);
+        }
+    }
+    if (numTimed == 0) {
+        return;
+    }
+
+    SDL_Log("Time per stage, summed over %d outputs:", numTimed);
+    print_timings(&sum);
+    SDL_Log("Slowest outputs:");
+    for (int i = 0; i < numSlowest; i += 1) {
+        ShaderCross_TimeStage stage = get_slowest_stage(&slowest[i]->timings);
+        SDL_Log("  %10.3f ms  %s target of %s, %.0f%% %s", (double)slowest[i]->timings.totalWallNS / SDL_NS_PER_MS,
+            slowest[i]->target, slowest[i]->source,
+            slowest[i]->timings.totalWallNS > 0 ? 100.0 * (double)slowest[i]->timings.wallNS[stage] / (double)slowest[i]->timings.totalWallNS : 0.0,
+            timeStageNames[stage]);
+    }
+}
+
+// The options of parse_options() that take a separate value
+static const char *optionsWithValues[] = {
+    "-s", "--source", "-d", "--dest", "-t", "--stage", "-e", "--entrypoint", "-o", "--output",
+    "-I", "--include", "-MF", "--shader-model", "--msl-version", "--roundtrip", "--embed-name", "--trace"
+};
+
+/* Shader bundles, see SDL_ShaderCross_BundleHeader */
+
+static Uint64 hash_fnv1a(const void *data, size_t size)
+{
+    const Uint8 *bytes = (const Uint8 *)data;
+    Uint64 hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i += 1) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static int SDLCALL compare_bundle_jobs(const void *a, const void *b)
+{
+    const ShaderCross_ManifestJob *jobA = *(const ShaderCross_ManifestJob **)a;
+    const ShaderCross_ManifestJob *jobB = *(const ShaderCross_ManifestJob **)b;
+    if (jobA->compiled.entry.hash != jobB->compiled.entry.hash) {
+        return jobA->compiled.entry.hash < jobB->compiled.entry.hash ? -1 : 1;
+    }
+    int names = SDL_strcmp(jobA->name, jobB->name);
+    if (names != 0) {
+        return names;
+    }
+    if (jobA->compiled.entry.format != jobB->compiled.entry.format) {
+        return jobA->compiled.entry.format < jobB->compiled.entry.format ? -1 : 1;
+    }
+    return 0;
+}
+
+static Uint32 add_bundle_string(SDL_IOStream *strings, const char *string)
+{
+    Uint32 offset = (Uint32)SDL_TellIO(strings);
+    SDL_WriteIO(strings, string, SDL_strlen(string) + 1);
+    return offset;
+}
+
+static void write_bundle_padding(SDL_IOStream *io)
+{
+    static const Uint8 zeroes[SDL_SHADERCROSS_BUNDLE_ALIGNMENT] = { 0 };
+    Sint64 misalignment = SDL_TellIO(io) % SDL_SHADERCROSS_BUNDLE_ALIGNMENT;
+    if (misalignment != 0) {
+        SDL_WriteIO(io, zeroes, (size_t)(SDL_SHADERCROSS_BUNDLE_ALIGNMENT - misalignment));
+    }
+}
+
+static bool write_bundle(const char *filename, ShaderCross_Manifest *manifest)
+{
+    ShaderCross_ManifestJob **jobs = (ShaderCross_ManifestJob **)SDL_malloc(sizeof(ShaderCross_ManifestJob *) * SDL_max(manifest->numJobs, 1));
+    Uint32 numEntries = 0;
+    if (jobs == NULL) {
+        return false;
+    }
+    for (int i = 0; i < manifest->numJobs; i += 1) {
+        ShaderCross_ManifestJob *job = &manifest->jobs[i];
+        if (job->name != NULL) {
+            job->compiled.entry.hash = hash_fnv1a(job->name, SDL_strlen(job->name));
+            jobs[numEntries++] = job;
+        }
+    }
+    SDL_qsort(jobs, numEntries, sizeof(ShaderCross_ManifestJob *), compare_bundle_jobs);
+
+    for (Uint32 i = 1; i < numEntries; i += 1) {
+        if (compare_bundle_jobs(&jobs[i - 1], &jobs[i]) == 0) {
+            SDL_free(jobs);
+            return SDL_SetError("%s has more than one %s target, give the shaders distinct names", jobs[i]->name, jobs[i]->target);
+        }
+    }
+
+    // Identical code is stored once, found through an open addressing table keyed by its hash
+    Uint32 tableSize = 1;
+    while (tableSize < numEntries * 2) {
+        tableSize *= 2;
+    }
+    Sint32 *table = (Sint32 *)SDL_malloc(sizeof(Sint32) * tableSize);
+    Uint64 *codeHashes = (Uint64 *)SDL_malloc(sizeof(Uint64) * SDL_max(numEntries, 1));
+    SDL_IOStream *strings = SDL_IOFromDynamicMem();
+    SDL_IOStream *io = SDL_IOFromDynamicMem();
+    bool success = table != NULL && codeHashes != NULL && strings != NULL && io != NULL;
+
+    if (success) {
+        SDL_memset(table, 0xFF, sizeof(Sint32) * tableSize);
+    }
+
+    // Names repeat once per target and are adjacent once sorted, entry points are nearly always the same few
+    Uint64 codeSize = 0;
+    for (Uint32 i = 0; success && i < numEntries; i += 1) {
+        SDL_ShaderCross_BundleEntry *entry = &jobs[i]->compiled.entry;
+        entry->name_offset = (i > 0 && SDL_strcmp(jobs[i - 1]->name, jobs[i]->name) == 0) ? jobs[i - 1]->compiled.entry.name_offset : add_bundle_string(strings, jobs[i]->name);
+        entry->entrypoint_offset = (Uint32)-1;
+        for (Uint32 j = i; j > 0 && i - j < 8; j -= 1) {
+            if (SDL_strcmp(jobs[j - 1]->compiled.entrypoint, jobs[i]->compiled.entrypoint) == 0) {
+                entry->entrypoint_offset = jobs[j - 1]->compiled.entry.entrypoint_offset;
+                break;
+            }
+        }
+        if (entry->entrypoint_offset == (Uint32)-1) {
+            entry->entrypoint_offset = add_bundle_string(strings, jobs[i]->compiled.entrypoint);
+        }
+
+        entry->code_size = jobs[i]->compiled.codeSize;
+        codeHashes[i] = hash_fnv1a(jobs[i]->compiled.code, jobs[i]->compiled.codeSize);
+        Uint32 slot = (Uint32)codeHashes[i] & (tableSize - 1);
+        while (table[slot] >= 0) {
+            const ShaderCross_ManifestJob *other = jobs[table[slot]];
+            if (codeHashes[table[slot]] == codeHashes[i] &&
+                other->compiled.codeSize == jobs[i]->compiled.codeSize &&
+                SDL_memcmp(other->compiled.code, jobs[i]->compiled.code, jobs[i]->compiled.codeSize) == 0) {
+                break;
+            }
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (table[slot] >= 0) {
+            entry->code_offset = jobs[table[slot]]->compiled.entry.code_offset;
+        } else {
+            table[slot] = (Sint32)i;
+            entry->code_offset = codeSize; // relative to the code section until it is placed
+            codeSize += (entry->code_size + SDL_SHADERCROSS_BUNDLE_ALIGNMENT - 1) & ~(Uint64)(SDL_SHADERCROSS_BUNDLE_ALIGNMENT - 1);
+        }
+    }
+
+    Sint64 stringsSize = strings != NULL ? SDL_TellIO(strings) : -1;
+    success = success && stringsSize >= 0;
+    if (success) {
+        SDL_ShaderCross_BundleHeader header;
+        Uint64 entriesOffset = sizeof(SDL_ShaderCross_BundleHeader);
+        Uint64 stringsOffset = entriesOffset + sizeof(SDL_ShaderCross_BundleEntry) * numEntries;
+        Uint64 codeOffset = (stringsOffset + stringsSize + SDL_SHADERCROSS_BUNDLE_ALIGNMENT - 1) & ~(Uint64)(SDL_SHADERCROSS_BUNDLE_ALIGNMENT - 1);
+
+        header.magic = SDL_Swap32LE(SDL_SHADERCROSS_BUNDLE_MAGIC);
+        header.version = SDL_Swap32LE(SDL_SHADERCROSS_BUNDLE_VERSION);
+        header.num_entries = SDL_Swap32LE(numEntries);
+        header.entry_size = SDL_Swap32LE((Uint32)sizeof(SDL_ShaderCross_BundleEntry));
+        header.entries_offset = SDL_Swap64LE(entriesOffset);
+        header.strings_offset = SDL_Swap64LE(stringsOffset);
+        header.strings_size = SDL_Swap64LE((Uint64)stringsSize);
+        SDL_WriteIO(io, &header, sizeof(header));
+
+        for (Uint32 i = 0; i < numEntries; i += 1) {
+            const SDL_ShaderCross_BundleEntry *entry = &jobs[i]->compiled.entry;
+            SDL_ShaderCross_BundleEntry swapped;
+            swapped.hash = SDL_Swap64LE(entry->hash);
+            swapped.code_offset = SDL_Swap64LE(codeOffset + entry->code_offset);
+            swapped.code_size = SDL_Swap64LE(entry->code_size);
+            swapped.name_offset = SDL_Swap32LE(entry->name_offset);
+            swapped.entrypoint_offset = SDL_Swap32LE(entry->entrypoint_offset);
+            swapped.format = SDL_Swap32LE(entry->format);
+            swapped.shader_stage = SDL_Swap32LE(entry->shader_stage);
+            swapped.num_samplers = SDL_Swap32LE(entry->num_samplers);
+            swapped.num_readonly_storage_textures = SDL_Swap32LE(entry->num_readonly_storage_textures);
+            swapped.num_readonly_storage_buffers = SDL_Swap32LE(entry->num_readonly_storage_buffers);
+            swapped.num_readwrite_storage_textures = SDL_Swap32LE(entry->num_readwrite_storage_textures);
+            swapped.num_readwrite_storage_buffers = SDL_Swap32LE(entry->num_readwrite_storage_buffers);
+            swapped.num_uniform_buffers = SDL_Swap32LE(entry->num_uniform_buffers);
+            swapped.threadcount_x = SDL_Swap32LE(entry->threadcount_x);
+            swapped.threadcount_y = SDL_Swap32LE(entry->threadcount_y);
+            swapped.threadcount_z = SDL_Swap32LE(entry->threadcount_z);
+            swapped.reserved = 0;
+            SDL_WriteIO(io, &swapped, sizeof(swapped));
+        }
+
+        void *stringData = SDL_GetPointerProperty(SDL_GetIOProperties(strings), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+        SDL_WriteIO(io, stringData, (size_t)stringsSize);
+        write_bundle_padding(io);
+
+        // The table holds exactly the entries that own their code, placed in entry order
+        for (Uint32 i = 0; i < numEntries; i += 1) {
+            Uint32 slot = (Uint32)codeHashes[i] & (tableSize - 1);
+            while (table[slot] >= 0 && table[slot] != (Sint32)i) {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            if (table[slot] == (Sint32)i) {
+                SDL_WriteIO(io, jobs[i]->compiled.code, jobs[i]->compiled.codeSize);
+                write_bundle_padding(io);
+            }
+        }
+
+        Sint64 size = SDL_TellIO(io);
+        void *data = SDL_GetPointerProperty(SDL_GetIOProperties(io), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+        success = size == (Sint64)(codeOffset + codeSize) && write_output_file(filename, data, (size_t)size);
+    }
+
+    if (io != NULL) {
+        SDL_CloseIO(io);
+    }
+    if (strings != NULL) {
+        SDL_CloseIO(strings);
+    }
+    SDL_free(codeHashes);
+    SDL_free(table);
+    SDL_free(jobs);
+    return success;
+}
+
+static bool is_manifest_build(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i += 1) {
+        if (SDL_strcmp(argv[i], "--") == 0) {
+            break;
+        } else if (SDL_strcmp(argv[i], "--manifest") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int build_manifest(int argc, char *argv[])
+{
+    const char *manifestFilename = NULL;
+    const char *summaryFilename = NULL;
+    const char *bundleFilename = NULL;
+    int numThreads = SDL_GetNumLogicalCPUCores();
+    ShaderCross_ArgList cliArgs;
+    ShaderCross_Manifest manifest;
+
+    SDL_zero(cliArgs);
+    SDL_zero(manifest);
+
+    // Pick out the manifest options, the others apply to every shader
+    bool success = push_arg(&cliArgs, SDL_strdup(argv[0]));
+    for (int i = 1; success && i < argc; i += 1) {
+        const char *arg = argv[i];
+        if (SDL_strcmp(arg, "--manifest") == 0 || SDL_strcmp(arg, "--summary") == 0 || SDL_strcmp(arg, "--bundle") == 0 ||
+            SDL_strcmp(arg, "-j") == 0 || SDL_strcmp(arg, "--jobs") == 0) {
+            if (i + 1 >= argc) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", arg);
+                print_help();
+                free_args(&cliArgs);
+                return 1;
+            }
+            i += 1;
+            if (SDL_strcmp(arg, "--manifest") == 0) {
+                manifestFilename = argv[i];
+            } else if (SDL_strcmp(arg, "--summary") == 0) {
+                summaryFilename = argv[i];
+            } else if (SDL_strcmp(arg, "--bundle") == 0) {
+                bundleFilename = argv[i];
+            } else {
+                numThreads = SDL_atoi(argv[i]);
+                if (numThreads < 1) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Invalid number of jobs %s", argv[i]);
+                    print_help();
+                    free_args(&cliArgs);
+                    return 1;
+                }
+            }
+        } else if (arg[0] != '-' || SDL_strcmp(arg, "--") == 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: Inputs and outputs of a manifest build come from the manifest, not the command line: %s", argv[0], arg);
+            print_help();
+            free_args(&cliArgs);
+            return 1;
+        } else {
+            success = push_arg(&cliArgs, SDL_strdup(arg));
+            // Options with a value take it along, so it isn't mistaken for an input
+            for (size_t j = 0; success && j < SDL_arraysize(optionsWithValues); j += 1) {
+                if (SDL_strcmp(arg, optionsWithValues[j]) == 0 && i + 1 < argc) {
+                    i += 1;
+                    success = push_arg(&cliArgs, SDL_strdup(argv[i]));
+                    break;
+                }
+            }
+        }
+    }
+
+    manifest.bundle = bundleFilename != NULL;
+    if (!success || !load_manifest(manifestFilename, &cliArgs, &manifest)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load manifest: %s", SDL_GetError());
+        free_args(&cliArgs);
+        free_manifest(&manifest);
+        return 1;
+    }
+    free_args(&cliArgs);
+
+    if (!SDL_ShaderCross_Init()) {
+        SDL_LogError(SDL_LOG_CATEGORY_GPU, "%s", "Failed to initialize shadercross!");
+        free_manifest(&manifest);
+        return 1;
+    }
+
+    // Jobs are handed out one at a time, so a few slow shaders don't hold up a whole thread's share
+    numThreads = SDL_clamp(numThreads, 1, SDL_max(manifest.numJobs, 1));
+    SDL_Thread **threads = (SDL_Thread **)SDL_calloc(numThreads, sizeof(SDL_Thread *));
+    int numStarted = 0;
+    Uint64 start = SDL_GetTicksNS();
+
+    for (int i = 0; threads != NULL && i < numThreads; i += 1) {
+        threads[i] = SDL_CreateThread(run_manifest_jobs, "shadercross job", &manifest);
+        if (threads[i] == NULL) {
+            break;
+        }
+        numStarted += 1;
+    }
+    if (numStarted == 0) {
+        run_manifest_jobs(&manifest);
+    }
+    for (int i = 0; i < numStarted; i += 1) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    SDL_free(threads);
+
+    Uint64 elapsedNS = SDL_GetTicksNS() - start;
+    int numFailed = 0;
+    for (int i = 0; i < manifest.numJobs; i += 1) {
+        if (manifest.jobs[i].result != 0) {
+            numFailed += 1;
+        }
+    }
+
+    SDL_Log("Built %d of %d outputs in %.2f seconds on %d threads", manifest.numJobs - numFailed, manifest.numJobs, (double)elapsedNS / SDL_NS_PER_SECOND, SDL_max(numStarted, 1));
+    for (int i = 0; i < manifest.numJobs; i += 1) {
+        if (manifest.jobs[i].result != 0) {
+            SDL_Log("  failed: %s target of %s", manifest.jobs[i].target, manifest.jobs[i].source);
+        }
+    }
+    print_manifest_timings(&manifest);
+    if (memStatsEnabled) {
+        SDL_ShaderCross_MemoryStats memStats;
+        SDL_zero(memStats);
+        for (int i = 0; i < manifest.numJobs; i += 1) {
+            add_mem_stage_stats(&memStats.total, &manifest.jobs[i].memStats.total);
+            for (int j = 0; j < SDL_SHADERCROSS_MEMORYSTAGE_COUNT; j += 1) {
+                add_mem_stage_stats(&memStats.stages[j], &manifest.jobs[i].memStats.stages[j]);
+            }
+        }
+        SDL_Log("Memory of all %d outputs, with the peaks of the largest one:", manifest.numJobs);
+        print_mem_stats(&memStats);
+    }
+
+    int result = numFailed == 0 ? 0 : 1;
+    if (bundleFilename != NULL && numFailed != 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Not writing %s, some of its shaders failed to build", bundleFilename);
+    } else if (bundleFilename != NULL && !write_bundle(bundleFilename, &manifest)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write %s: %s", bundleFilename, SDL_GetError());
+        result = 1;
+    }
+    if (summaryFilename != NULL && !write_manifest_summary(summaryFilename, &manifest, numFailed, elapsedNS)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write %s: %s", summaryFilename, SDL_GetError());
+        result = 1;
+    }
+
+    free_manifest(&manifest);
+    SDL_ShaderCross_Quit();
+    return result;
+}
+
+// Writes the recorded spans in the Chrome trace event format
+static bool write_trace(const char *filename)
+{
+    SDL_IOStream *io = SDL_IOFromDynamicMem();
+    if (io == NULL) {
+        return false;
+    }
+
+    SDL_IOprintf(io, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < numTraceEvents; i += 1) {
+        const ShaderCross_TraceEvent *event = &traceEvents[i];
+        SDL_IOprintf(io, "  {\"name\":");
+        write_json_string(io, event->name);
+        SDL_IOprintf(io, ",\"cat\":\"shadercross\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%" SDL_PRIu64,
+            event->begin ? "B" : "E", (double)event->timeNS / 1000.0, (Uint64)event->thread);
+        if (event->detail != NULL) {
+            SDL_IOprintf(io, ",\"args\":{\"detail\":");
+            write_json_string(io, event->detail);
+            SDL_IOprintf(io, "}");
+        }
+        SDL_IOprintf(io, "}%s\n", i + 1 < numTraceEvents ? "," : "");
+    }
+    SDL_IOprintf(io, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    void *data = SDL_GetPointerProperty(SDL_GetIOProperties(io), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    bool result = write_output_file(filename, data, (size_t)SDL_GetIOSize(io));
+    SDL_CloseIO(io);
+    return result;
+}
+
+static int compile_local(int argc, char *argv[])
+{
+    ShaderCross_Options options;
+    int result;
+
+    if (is_manifest_build(argc, argv)) {
+        return build_manifest(argc, argv);
+    }
+
+    if (parse_options(argc, argv, &options, &result, true)) {
+        options.memStats = options.memStats && memStatsEnabled;
+        if (!SDL_ShaderCross_Init()) {
+            SDL_LogError(SDL_LOG_CATEGORY_GPU, "%s", "Failed to initialize shadercross!");
+            result = 1;
+        } else {
+#ifdef SHADERCROSS_WATCH
+            if (options.watch) {
+                result = watch_shader(&options);
+            } else
+#endif
+            result = compile_shader(&options, NULL, NULL, NULL);
+            SDL_ShaderCross_Quit();
+        }
+    }
+
+    free_options(&options);
+    return result;
+}
+
+#ifdef SHADERCROSS_SERVER
+
+/* Compile server
+ *
+ * The server keeps SDL_shadercross initialized, with DXC and vkd3d loaded, and
+ * compiles requests from clients on a pool of one worker thread per CPU core,
+ * queueing the connections that arrive while all of them are busy. Only the
+ * user running the server may connect, since it reads and writes files as
+ * that user. A request is a Uint32
+ * string count followed by the strings, each a Uint32 length and its bytes:
+ * the client's working directory, then its arguments. The server answers with
+ * the log messages of the compile, then its exit code. SIGINT and SIGTERM stop
+ * the server once the connections it accepted are served, and remove the
+ * socket.
+ */
+
+#define SERVER_MAX_STRINGS 4096
+#define SERVER_MAX_STRING_LENGTH (1024 * 1024)
+
+typedef enum ShaderCross_ServerMessage {
+    SERVER_MESSAGE_LOG,
+    SERVER_MESSAGE_EXIT
+} ShaderCross_ServerMessage;
+
+typedef struct ShaderCross_ServerClient {
+    int socket;
+    struct ShaderCross_ServerClient *next; // in the queue of pending connections
+} ShaderCross_ServerClient;
+
+typedef struct ShaderCross_ServerQueue {
+    SDL_Mutex *lock;
+    SDL_Condition *pending;
+    ShaderCross_ServerClient *head;
+    ShaderCross_ServerClient *tail;
+    bool quit;
+} ShaderCross_ServerQueue;
+
+static SDL_TLSID serverClientTLS;
+static SDL_LogOutputFunction serverDefaultLogOutput;
+static void *serverDefaultLogOutputData;
+
+static bool send_all(int fd, const void *data, size_t size)
+{
+    const Uint8 *bytes = (const Uint8 *)data;
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= (size_t)written;
+    }
+    return true;
+}
+
+static bool recv_all(int fd, void *data, size_t size)
+{
+    Uint8 *bytes = (Uint8 *)data;
+    while (size > 0) {
+        ssize_t received = read(fd, bytes, size);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return false;
+        }
+        bytes += received;
+        size -= (size_t)received;
+    }
+    return true;
+}
+
+static bool send_string(int fd, const char *str)
+{
+    Uint32 length = (Uint32)SDL_strlen(str);
+    return send_all(fd, &length, sizeof(length)) && send_all(fd, str, length);
+}
+
+// Returns an SDL_malloc'd null-terminated string, or NULL if the peer went away or sent garbage
+static char *recv_string(int fd)
+{
+    Uint32 length;
+    if (!recv_all(fd, &length, sizeof(length)) || length > SERVER_MAX_STRING_LENGTH) {
+        return NULL;
+    }
+    char *str = (char *)SDL_malloc(length + 1);
+    if (str == NULL) {
+        return NULL;
+    }
+    if (!recv_all(fd, str, length)) {
+        SDL_free(str);
+        return NULL;
+    }
+    str[length] = '\0';
+    return str;
+}
+
+static char *get_default_socket_path(void)
+{
+    char *path = NULL;
+    const char *runtimeDir = SDL_getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir != NULL && *runtimeDir != '\0') {
+        SDL_asprintf(&path, "%s/shadercross.sock", runtimeDir);
+    } else {
+        SDL_asprintf(&path, "/tmp/shadercross-%u.sock", (unsigned int)getuid());
+    }
+    return path;
+}
+
+static int connect_to_server(const char *socketPath)
+{
+    struct sockaddr_un address;
+    if (SDL_strlen(socketPath) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    SDL_zero(address);
+    address.sun_family = AF_UNIX;
+    SDL_strlcpy(address.sun_path, socketPath, sizeof(address.sun_path));
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Log messages of a request go back to the client that sent it
+static void SDLCALL server_log_output(void *userdata, int category, SDL_LogPriority priority, const char *message)
+{
+    ShaderCross_ServerClient *client = (ShaderCross_ServerClient *)SDL_GetTLS(&serverClientTLS);
+    if (client == NULL) {
+        serverDefaultLogOutput(serverDefaultLogOutputData, category, priority, message);
+        return;
+    }
+
+    // A client that went away only loses its log, the compile still finishes
+    Sint32 header[3] = { SERVER_MESSAGE_LOG, category, (Sint32)priority };
+    if (send_all(client->socket, header, sizeof(header))) {
+        send_string(client->socket, message);
+    }
+}
+
+static int serve_request(const char *cwd, int argc, char *argv[])
+{
+    ShaderCross_Options options;
+    int result;
+
+    if (parse_options(argc, argv, &options, &result, true)) {
+        if (options.watch || options.trace) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s can't be used through the server", options.watch ? "--watch" : "--trace");
+            result = 1;
+        } else if (is_standard_stream(options.filename) || is_standard_stream(options.outputFilename)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", "The standard input and output can't be used through the server");
+            result = 1;
+        } else {
+            // Paths, includes among them, are relative to the client's working directory, not the server's.
+            // They are kept relative otherwise, so the depfile is the same as a local compile's.
+            options.workingDir = cwd;
+            options.memStats = options.memStats && memStatsEnabled;
+            result = compile_shader(&options, NULL, NULL, NULL);
+        }
+    }
+
+    free_options(&options);
+    return result;
+}
+
+static void serve_client(ShaderCross_ServerClient *client)
+{
+    char **strings = NULL;
+    Uint32 count = 0;
+    int result = 1;
+
+    // The working directory and at least argv[0]
+    if (recv_all(client->socket, &count, sizeof(count)) && count >= 2 && count <= SERVER_MAX_STRINGS) {
+        strings = (char **)SDL_calloc(count + 1, sizeof(char *));
+        bool received = strings != NULL;
+        for (Uint32 i = 0; received && i < count; i += 1) {
+            strings[i] = recv_string(client->socket);
+            received = strings[i] != NULL;
+        }
+
+        if (received) {
+            SDL_SetTLS(&serverClientTLS, client, NULL);
+            result = serve_request(strings[0], (int)count - 1, strings + 1);
+            SDL_SetTLS(&serverClientTLS, NULL, NULL);
+        }
+    }
+
+    Sint32 message[2] = { SERVER_MESSAGE_EXIT, result };
+    send_all(client->socket, message, sizeof(message));
+
+    if (strings != NULL) {
+        for (Uint32 i = 0; i < count; i += 1) {
+            SDL_free(strings[i]);
+        }
+        SDL_free(strings);
+    }
+    close(client->socket);
+    SDL_free(client);
+}
+
+static int SDLCALL run_server_worker(void *data)
+{
+    ShaderCross_ServerQueue *queue = (ShaderCross_ServerQueue *)data;
+    for (;;) {
+        SDL_LockMutex(queue->lock);
+        while (queue->head == NULL && !queue->quit) {
+            SDL_WaitCondition(queue->pending, queue->lock);
+        }
+        ShaderCross_ServerClient *client = queue->head;
+        if (client != NULL) {
+            queue->head = client->next;
+            if (queue->head == NULL) {
+                queue->tail = NULL;
+            }
+        }
+        SDL_UnlockMutex(queue->lock);
+
+        // The queue is drained before the workers quit
+        if (client == NULL) {
+            return 0;
+        }
+        serve_client(client);
+    }
+}
+
+static bool is_peer_same_user(int fd)
+{
+#ifdef SO_PEERCRED
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) < 0) {
+        return false;
+    }
+    return credentials.uid == getuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    if (getpeereid(fd, &uid, &gid) < 0) {
+        return false;
+    }
+    return uid == getuid();
+#endif
+}
+
+// Written to by the signal handler to wake the accept loop
+static int serverStopPipe[2] = { -1, -1 };
+
+static void server_stop_handler(int signum)
+{
+    int savedErrno = errno;
+    char byte = (char)signum;
+    ssize_t written = write(serverStopPipe[1], &byte, 1);
+    (void)written;
+    errno = savedErrno;
+}
+
+static int run_server(const char *socketPath)
+{
+    struct sockaddr_un address;
+
+    if (SDL_strlen(socketPath) >= sizeof(address.sun_path)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Socket path is too long: %s", socketPath);
+        return 1;
+    }
+
+    // A socket nobody answers on is left over from a server that didn't shut down cleanly
+    int existing = connect_to_server(socketPath);
+    if (existing >= 0) {
+        close(existing);
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "A server is already listening on %s", socketPath);
+        return 1;
+    }
+    unlink(socketPath);
+
+    SDL_zero(address);
+    address.sun_family = AF_UNIX;
+    SDL_strlcpy(address.sun_path, socketPath, sizeof(address.sun_path));
+
+    // The socket is only accessible to the user from the moment it exists, whatever the umask
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    mode_t previousMask = umask(0077);
+    bool bound = listener >= 0 && bind(listener, (struct sockaddr *)&address, sizeof(address)) == 0;
+    umask(previousMask);
+    if (!bound ||
+        chmod(socketPath, S_IRUSR | S_IWUSR) < 0 ||
+        listen(listener, SOMAXCONN) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to listen on %s: %s", socketPath, strerror(errno));
+        if (listener >= 0) {
+            close(listener);
+        }
+        return 1;
+    }
+
+    if (pipe(serverStopPipe) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to create a pipe: %s", strerror(errno));
+        close(listener);
+        unlink(socketPath);
+        return 1;
+    }
+    fcntl(serverStopPipe[1], F_SETFL, O_NONBLOCK);
+
+    // Without SA_RESTART, so that a signal also interrupts poll()
+    struct sigaction stopAction;
+    struct sigaction previousInterrupt;
+    struct sigaction previousTerminate;
+    SDL_zero(stopAction);
+    stopAction.sa_handler = server_stop_handler;
+    sigemptyset(&stopAction.sa_mask);
+    sigaction(SIGINT, &stopAction, &previousInterrupt);
+    sigaction(SIGTERM, &stopAction, &previousTerminate);
+
+    if (!SDL_ShaderCross_Init()) {
+        SDL_LogError(SDL_LOG_CATEGORY_GPU, "%s", "Failed to initialize shadercross!");
+        sigaction(SIGINT, &previousInterrupt, NULL);
+        sigaction(SIGTERM, &previousTerminate, NULL);
+        close(serverStopPipe[0]);
+        close(serverStopPipe[1]);
+        close(listener);
+        unlink(socketPath);
+        return 1;
+    }
+
+    ShaderCross_ServerQueue queue;
+    SDL_zero(queue);
+    queue.lock = SDL_CreateMutex();
+    queue.pending = SDL_CreateCondition();
+    int numWorkers = SDL_max(SDL_GetNumLogicalCPUCores(), 1);
+    SDL_Thread **workers = (SDL_Thread **)SDL_calloc(numWorkers, sizeof(SDL_Thread *));
+    int numStarted = 0;
+    if (queue.lock != NULL && queue.pending != NULL && workers != NULL) {
+        for (int i = 0; i < numWorkers; i += 1) {
+            workers[i] = SDL_CreateThread(run_server_worker, "shadercross worker", &queue);
+            if (workers[i] != NULL) {
+                numStarted += 1;
+            }
+        }
+    }
+    if (numStarted == 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to start the server workers: %s", SDL_GetError());
+    }
+
+    SDL_GetLogOutputFunction(&serverDefaultLogOutput, &serverDefaultLogOutputData);
+    SDL_SetLogOutputFunction(server_log_output, NULL);
+    if (numStarted > 0) {
+        SDL_Log("Listening on %s with %d workers", socketPath, numStarted);
+    }
+
+    bool stopped = false;
+    while (numStarted > 0) {
+        struct pollfd fds[2];
+        fds[0].fd = listener;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = serverStopPipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        if (poll(fds, SDL_arraysize(fds), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to wait for a connection: %s", strerror(errno));
+            break;
+        }
+        if (fds[1].revents != 0) {
+            SDL_Log("Stopping the server on %s", socketPath);
+            stopped = true;
+            break;
+        }
+        if (fds[0].revents == 0) {
+            continue;
+        }
+
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to accept a connection: %s", strerror(errno));
+            break;
+        }
+
+        if (!is_peer_same_user(fd)) {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Rejected a connection from another user");
+            close(fd);
+            continue;
+        }
+
+        ShaderCross_ServerClient *client = (ShaderCross_ServerClient *)SDL_malloc(sizeof(ShaderCross_ServerClient));
+        if (client == NULL) {
+            close(fd);
+            continue;
+        }
+        client->socket = fd;
+        client->next = NULL;
+
+        SDL_LockMutex(queue.lock);
+        if (queue.tail != NULL) {
+            queue.tail->next = client;
+        } else {
+            queue.head = client;
+        }
+        queue.tail = client;
+        SDL_SignalCondition(queue.pending);
+        SDL_UnlockMutex(queue.lock);
+    }
+
+    SDL_LockMutex(queue.lock);
+    queue.quit = true;
+    SDL_BroadcastCondition(queue.pending);
+    SDL_UnlockMutex(queue.lock);
+    for (int i = 0; workers != NULL && i < numWorkers; i += 1) {
+        if (workers[i] != NULL) {
+            SDL_WaitThread(workers[i], NULL);
+        }
+    }
+    SDL_free(workers);
+    SDL_DestroyCondition(queue.pending);
+    SDL_DestroyMutex(queue.lock);
+
+    SDL_SetLogOutputFunction(serverDefaultLogOutput, serverDefaultLogOutputData);
+    SDL_ShaderCross_Quit();
+    sigaction(SIGINT, &previousInterrupt, NULL);
+    sigaction(SIGTERM, &previousTerminate, NULL);
+    close(serverStopPipe[0]);
+    close(serverStopPipe[1]);
+    close(listener);
+    unlink(socketPath);
+    return stopped ? 0 : 1;
+}
+
+// The server has no access to the client's standard input and output
+static bool uses_standard_streams(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i += 1) {
+        if (is_standard_stream(argv[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns -1 when no server is listening, so the caller can compile in-process instead
+static int run_client(const char *socketPath, int argc, char *argv[])
+{
+    int fd = connect_to_server(socketPath);
+    if (fd < 0) {
+        return -1;
+    }
+
+    char *cwd = SDL_GetCurrentDirectory();
+    Uint32 count = (Uint32)argc + 1;
+    bool sent = cwd != NULL && send_all(fd, &count, sizeof(count)) && send_string(fd, cwd);
+    for (int i = 0; sent && i < argc; i += 1) {
+        sent = send_string(fd, argv[i]);
+    }
+    SDL_free(cwd);
+
+    int result = -1;
+    while (sent) {
+        Sint32 type;
+        if (!recv_all(fd, &type, sizeof(type))) {
+            break;
+        }
+        if (type == SERVER_MESSAGE_LOG) {
+            Sint32 header[2];
+            if (!recv_all(fd, header, sizeof(header))) {
+                break;
+            }
+            char *message = recv_string(fd);
+            if (message == NULL) {
+                break;
+            }
+            SDL_LogMessage(header[0], (SDL_LogPriority)header[1], "%s", message);
+            SDL_free(message);
+        } else if (type == SERVER_MESSAGE_EXIT) {
+            Sint32 exitCode;
+            if (recv_all(fd, &exitCode, sizeof(exitCode))) {
+                result = exitCode;
+            }
+            break;
+        } else {
+            break;
+        }
+    }
+    close(fd);
+
+    if (result < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Lost the connection to the server on %s", socketPath);
+        result = 1;
+    }
+    return result;
+}
+
+#endif /* SHADERCROSS_SERVER */
+
+int main(int argc, char *argv[])
+{
+    int result;
+
+    // Memory tracking has to be installed before anything is allocated
+    for (int i = 1; i < argc; i += 1) {
+        if (SDL_strcmp(argv[i], "--") == 0) {
+            break;
+        } else if (SDL_strcmp(argv[i], "--mem-stats") == 0) {
+            memStatsEnabled = SDL_ShaderCross_EnableMemoryStats();
+            if (!memStatsEnabled) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to enable memory statistics: %s", SDL_GetError());
+            }
+            break;
+        }
+    }
+
+#ifdef LEAKCHECK
+    SDLTest_TrackAllocations();
+#endif
+
+    for (int i = 1; i + 1 < argc; i += 1) {
+        if (SDL_strcmp(argv[i], "--") == 0) {
+            break;
+        } else if (SDL_strcmp(argv[i], "--trace") == 0) {
+            if (!start_trace(argv[i + 1])) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to start tracing: %s", SDL_GetError());
+            }
+            break;
+        }
+    }
+
+#ifdef SHADERCROSS_SERVER
+    // Pick out the server options, everything else is compiled or forwarded as is
+    bool serverMode = false;
+    bool clientMode = false;
+    const char *socketPath = NULL;
+    char **compileArgv = (char **)SDL_calloc(argc + 1, sizeof(char *));
+    int compileArgc = 0;
+    if (compileArgv == NULL) {
+        return 1;
+    }
+
+    bool accept_optionals = true;
+    for (int i = 0; i < argc; i += 1) {
+        if (i > 0 && accept_optionals) {
+            if (SDL_strcmp(argv[i], "--server") == 0) {
+                serverMode = true;
+                continue;
+            } else if (SDL_strcmp(argv[i], "--client") == 0) {
+                clientMode = true;
+                continue;
+            } else if (SDL_strcmp(argv[i], "--socket") == 0) {
+                if (i + 1 >= argc) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s requires an argument", argv[i]);
+                    print_help();
+                    SDL_free(compileArgv);
+                    return 1;
+                }
+                i += 1;
+                socketPath = argv[i];
+                continue;
+            } else if (SDL_strcmp(argv[i], "--") == 0) {
+                accept_optionals = false;
+            }
+        }
+        compileArgv[compileArgc++] = argv[i];
+    }
+
+    char *defaultSocketPath = NULL;
+    if (socketPath == NULL && (serverMode || clientMode)) {
+        defaultSocketPath = get_default_socket_path();
+        socketPath = defaultSocketPath;
+    }
+
+    // The server and client write to sockets whose peer may be gone
+    if (serverMode || clientMode) {
+        signal(SIGPIPE, SIG_IGN);
+    }
+
+    if (serverMode && socketPath == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", SDL_GetError());
+        result = 1;
+    } else if (serverMode) {
+        result = run_server(socketPath);
+    } else {
+        result = -1;
+        // A manifest build already keeps everything loaded across its shaders, and traces and standard streams stay here
+        if (clientMode && socketPath != NULL && traceFilename == NULL && !uses_standard_streams(compileArgc, compileArgv) && !is_manifest_build(compileArgc, compileArgv)) {
+            result = run_client(socketPath, compileArgc, compileArgv);
+        }
+        if (result < 0) {
+            result = compile_local(compileArgc, compileArgv);
+        }
+    }
+
+    SDL_free(defaultSocketPath);
+    SDL_free(compileArgv);
+#else
+    result = compile_local(argc, argv);
+#endif
+
+    if (traceFilename != NULL) {
+        if (!write_trace(traceFilename)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write %s: %s", traceFilename, SDL_GetError());
+            result = result != 0 ? result : 1;
+        }
+        stop_trace();
+    }
+
     SDL_Quit();
 
 #ifdef LEAKCHECK
@@ -4,6 +4,12 @@
 
 #include "shaders/hinc/simple.vert.hlsl.h"
 
+/* Memory statistics can only be enabled before the first allocation, so main() does it */
+static bool memory_stats_enabled = false;
+
+/* A bundle written by the command line tool from shaders/bundle.json, given with --bundle */
+static const char *written_bundle_path = NULL;
+
 static int SDLCALL shadercross_testInitQuit(void *args)
 {
     SDL_GPUShaderFormat hlsl_formats;
@@ -78,6 +84,21 @@ static int SDLCALL shadercross_CompileHLSL_to_XXX(void *args)
         SDL_DestroyProperties(hlsl_info.props);
         SDL_ClearError();
 
+        SDLTest_AssertPass("Compile a valid HLSL vertex shader to %s with automatic roundtrip detection", cases[i].formatname);
+        SDL_zero(hlsl_info);
+        hlsl_info.source = (const char *)simple_vert_hlsl;
+        hlsl_info.entrypoint = "main";
+        hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
+        hlsl_info.props = SDL_CreateProperties();
+        SDL_SetStringProperty(hlsl_info.props, SDL_SHADERCROSS_PROP_SHADER_HLSL_ROUNDTRIP_STRING, "auto");
+        shader_size = 0;
+        shader = cases[i].compile_XXXFromHLSL(&hlsl_info, &shader_size);
+        SDLTest_AssertCheck(shader != NULL, "%s should return a valid compiled shader (%s)", cases[i].funcname, SDL_GetError());
+        SDLTest_AssertCheck(shader_size != 0, "Size of shader returned by %s should be size > 0", cases[i].funcname);
+        SDL_free(shader);
+        SDL_DestroyProperties(hlsl_info.props);
+        SDL_ClearError();
+
         SDLTest_AssertPass("Break a HLSL vertex shader by defining a macro");
         SDL_zero(hlsl_info);
         SDL_zero(hlsl_defines);
@@ -96,6 +117,251 @@ static int SDLCALL shadercross_CompileHLSL_to_XXX(void *args)
     return TEST_COMPLETED;
 }
 
+static int SDLCALL shadercross_CompileHLSL_RoundtripAuto(void *args)
+{
+    // Only the register space of the read-write buffer differs, space0 gets rewritten by the roundtrip
+    static const char direct_comp_hlsl[] =
+        "RWStructuredBuffer<uint> Output : register(u0, space1);\n"
+        "[numthreads(64, 1, 1)]\n"
+        "void main(uint3 id : SV_DispatchThreadID) { Output[id.x] = id.x; }\n";
+    static const char roundtrip_comp_hlsl[] =
+        "RWStructuredBuffer<uint> Output : register(u0);\n"
+        "[numthreads(64, 1, 1)]\n"
+        "void main(uint3 id : SV_DispatchThreadID) { Output[id.x] = id.x; }\n";
+    static const char commented_comp_hlsl[] =
+        "// #include \"common.hlsl\"\n"
+        "/* RWTexture2D<float> Unused : register(u1); [[vk::binding(1)]] */\n"
+        "static const uint templateCount = 1;\n"
+        "RWStructuredBuffer<uint> Output : register(u0, space1); // WaveActiveSum\n"
+        "[numthreads(64, 1, 1)]\n"
+        "void main(uint3 id : SV_DispatchThreadID) { Output[id.x] = id.x * templateCount; }\n";
+    static const char identifier_comp_hlsl[] =
+        "RWStructuredBuffer<uint> myspace1 : register(u0);\n"
+        "[numthreads(64, 1, 1)]\n"
+        "void main(uint3 id : SV_DispatchThreadID) { myspace1[id.x] = id.x; }\n";
+    static const char space10_comp_hlsl[] =
+        "RWStructuredBuffer<uint> Output : register(u0, space10);\n"
+        "[numthreads(64, 1, 1)]\n"
+        "void main(uint3 id : SV_DispatchThreadID) { Output[id.x] = id.x; }\n";
+    size_t i;
+    size_t j;
+    struct {
+        const char *formatname;
+        const char *funcname;
+        void * (SDLCALL * compile_XXXFromHLSL)(const SDL_ShaderCross_HLSL_Info *, size_t *);
+        SDL_GPUShaderFormat format;
+    } cases[] = {
+        { "DXBC", "SDL_ShaderCross_CompileDXBCFromHLSL", SDL_ShaderCross_CompileDXBCFromHLSL, SDL_GPU_SHADERFORMAT_DXBC },
+        { "DXIL", "SDL_ShaderCross_CompileDXILFromHLSL", SDL_ShaderCross_CompileDXILFromHLSL, SDL_GPU_SHADERFORMAT_DXIL },
+    };
+    struct {
+        const char *description;
+        const char *source;
+        bool roundtrip;
+    } shaders[] = {
+        { "a compute shader with its read-write buffer in space1", direct_comp_hlsl, false },
+        { "a compute shader with its read-write buffer in space0", roundtrip_comp_hlsl, true },
+        { "a compute shader with roundtrip triggers only in comments", commented_comp_hlsl, false },
+        { "a compute shader with a read-write buffer named myspace1", identifier_comp_hlsl, true },
+        { "a compute shader with its read-write buffer in space10", space10_comp_hlsl, true },
+    };
+
+    (void)args;
+    for (i = 0; i < SDL_arraysize(cases); i++) {
+        if (!(SDL_ShaderCross_GetHLSLShaderFormats() & cases[i].format)) {
+            SDLTest_Log("SDL_shadercross does not support HLSL -> %s", cases[i].formatname);
+            continue;
+        }
+
+        for (j = 0; j < SDL_arraysize(shaders); j++) {
+            SDL_ShaderCross_HLSL_Info hlsl_info;
+            SDL_ShaderCross_TimingStats timing_stats;
+            void *shader;
+            size_t shader_size;
+            Uint64 spirv_calls;
+
+            SDLTest_AssertPass("Compile %s to %s with automatic roundtrip detection", shaders[j].description, cases[i].formatname);
+            SDL_zero(hlsl_info);
+            hlsl_info.source = shaders[j].source;
+            hlsl_info.entrypoint = "main";
+            hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
+            hlsl_info.props = SDL_CreateProperties();
+            SDL_SetStringProperty(hlsl_info.props, SDL_SHADERCROSS_PROP_SHADER_HLSL_ROUNDTRIP_STRING, "auto");
+            SDL_ShaderCross_ResetTimingStats();
+            shader_size = 0;
+            shader = cases[i].compile_XXXFromHLSL(&hlsl_info, &shader_size);
+            SDLTest_AssertCheck(shader != NULL, "%s should return a valid compiled shader (%s)", cases[i].funcname, SDL_GetError());
+            SDLTest_AssertCheck(shader_size != 0, "Size of shader returned by %s should be size > 0", cases[i].funcname);
+
+            // The roundtrip is the only way the HLSL to SPIRV and transpile stages run
+            SDLTest_AssertCheck(SDL_ShaderCross_GetTimingStats(&timing_stats), "SDL_ShaderCross_GetTimingStats succeeds (%s)", SDL_GetError());
+            spirv_calls = timing_stats.stages[SDL_SHADERCROSS_TIMINGSTAGE_HLSL_TO_SPIRV].num_calls;
+            SDLTest_AssertCheck((spirv_calls != 0) == shaders[j].roundtrip, "HLSL to SPIRV stage ran %d times, the shader should %sroundtrip", (int)spirv_calls, shaders[j].roundtrip ? "" : "not ");
+            SDLTest_AssertCheck((timing_stats.stages[SDL_SHADERCROSS_TIMINGSTAGE_TRANSPILE].num_calls != 0) == shaders[j].roundtrip, "Transpile stage ran %d times, the shader should %sroundtrip", (int)timing_stats.stages[SDL_SHADERCROSS_TIMINGSTAGE_TRANSPILE].num_calls, shaders[j].roundtrip ? "" : "not ");
+            SDL_free(shader);
+            SDL_DestroyProperties(hlsl_info.props);
+            SDL_ClearError();
+        }
+
+        {
+            SDL_ShaderCross_HLSL_Info hlsl_info;
+            void *shader;
+            size_t shader_size;
+
+            SDLTest_AssertPass("Compile to %s with an unknown roundtrip mode", cases[i].formatname);
+            SDL_zero(hlsl_info);
+            hlsl_info.source = direct_comp_hlsl;
+            hlsl_info.entrypoint = "main";
+            hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
+            hlsl_info.props = SDL_CreateProperties();
+            SDL_SetStringProperty(hlsl_info.props, SDL_SHADERCROSS_PROP_SHADER_HLSL_ROUNDTRIP_STRING, "sometimes");
+            shader_size = 0;
+            shader = cases[i].compile_XXXFromHLSL(&hlsl_info, &shader_size);
+            SDLTest_AssertCheck(shader == NULL, "%s should fail with an unknown roundtrip mode", cases[i].funcname);
+            SDLTest_AssertCheck(SDL_strstr(SDL_GetError(), "roundtrip mode") != NULL, "Error should name the roundtrip mode (%s)", SDL_GetError());
+            SDL_free(shader);
+            SDL_DestroyProperties(hlsl_info.props);
+            SDL_ClearError();
+        }
+    }
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL shadercross_CompileHLSL_ShaderModel(void *args)
+{
+    size_t i;
+    struct {
+        const char *description;
+        Sint64 shader_model; // 0 for the default
+        bool enable_16bit_types;
+        bool valid;
+    } cases[] = {
+        { "shader model 6.5", 65, false, true },
+        { "shader model 7.0", 70, false, false },
+        { "16-bit types", 0, true, true },
+        { "16-bit types and shader model 6.0", 60, true, false },
+    };
+
+    (void)args;
+    if (!(SDL_ShaderCross_GetHLSLShaderFormats() & SDL_GPU_SHADERFORMAT_DXIL)) {
+        SDLTest_AssertPass("SDL_ShaderCross does not support HLSL -> DXIL");
+        return TEST_SKIPPED;
+    }
+
+    for (i = 0; i < SDL_arraysize(cases); i++) {
+        SDL_ShaderCross_HLSL_Info hlsl_info;
+        void *shader;
+        size_t shader_size;
+
+        SDLTest_AssertPass("Compile a HLSL vertex shader to DXIL with %s", cases[i].description);
+        SDL_zero(hlsl_info);
+        hlsl_info.source = (const char *)simple_vert_hlsl;
+        hlsl_info.entrypoint = "main";
+        hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
+        hlsl_info.props = SDL_CreateProperties();
+        if (cases[i].shader_model != 0) {
+            SDL_SetNumberProperty(hlsl_info.props, SDL_SHADERCROSS_PROP_SHADER_DXIL_SHADER_MODEL_NUMBER, cases[i].shader_model);
+        }
+        SDL_SetBooleanProperty(hlsl_info.props, SDL_SHADERCROSS_PROP_SHADER_ENABLE_16BIT_TYPES_BOOLEAN, cases[i].enable_16bit_types);
+        shader_size = 0;
+        shader = SDL_ShaderCross_CompileDXILFromHLSL(&hlsl_info, &shader_size);
+        if (cases[i].valid) {
+            SDLTest_AssertCheck(shader != NULL, "SDL_ShaderCross_CompileDXILFromHLSL should return a valid compiled shader (%s)", SDL_GetError());
+            SDLTest_AssertCheck(shader_size != 0, "Size of shader returned by SDL_ShaderCross_CompileDXILFromHLSL should be size > 0");
+        } else {
+            SDLTest_AssertCheck(shader == NULL, "SDL_ShaderCross_CompileDXILFromHLSL should fail (%s)", SDL_GetError());
+        }
+        SDL_free(shader);
+        SDL_DestroyProperties(hlsl_info.props);
+        SDL_ClearError();
+    }
+    return TEST_COMPLETED;
+}
+
+static void SDLCALL record_include(void *userdata, const char *path)
+{
+    char **included = (char **)userdata;
+    SDL_free(*included);
+    *included = SDL_strdup(path);
+}
+
+static int SDLCALL shadercross_CompileHLSL_IncludeBaseDirectory(void *args)
+{
+    static const char include_frag_hlsl[] =
+        "#include \"include_base.hlsl\"\n"
+        "float4 main() : SV_Target0 { return SCALE; }\n";
+    static const char include_base_hlsl[] = "#define SCALE 2.0\n";
+    SDL_ShaderCross_HLSL_Info hlsl_info;
+    char *cwd;
+    char *base_dir = NULL;
+    char *include_path = NULL;
+    char *included = NULL;
+    SDL_ShaderCross_IncludeCallbackInfo include_callback;
+    void *shader;
+    void *shader_with_include_dir;
+    size_t shader_size = 0;
+    size_t shader_with_include_dir_size = 0;
+
+    (void)args;
+    if (!(SDL_ShaderCross_GetHLSLShaderFormats() & SDL_GPU_SHADERFORMAT_SPIRV)) {
+        SDLTest_AssertPass("SDL_ShaderCross does not support HLSL -> SPIRV");
+        return TEST_SKIPPED;
+    }
+
+    // Outside of the working directory, where a plain #include can't find it
+    cwd = SDL_GetCurrentDirectory();
+    SDL_asprintf(&base_dir, "%sshadercross_include_base", cwd ? cwd : "");
+    SDL_asprintf(&include_path, "%s/include_base.hlsl", base_dir);
+    SDL_free(cwd);
+    SDLTest_AssertCheck(base_dir != NULL && include_path != NULL && SDL_CreateDirectory(base_dir) &&
+        SDL_SaveFile(include_path, include_base_hlsl, SDL_strlen(include_base_hlsl)), "Write %s (%s)", include_path, SDL_GetError());
+
+    SDLTest_AssertPass("Compile a HLSL fragment shader whose include is relative to the include base directory");
+    SDL_zero(hlsl_info);
+    hlsl_info.source = include_frag_hlsl;
+    hlsl_info.entrypoint = "main";
+    hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
+    hlsl_info.props = SDL_CreateProperties();
+    SDL_SetStringProperty(hlsl_info.props, SDL_SHADERCROSS_PROP_SHADER_INCLUDE_BASE_DIRECTORY_STRING, base_dir);
+    include_callback.callback = record_include;
+    include_callback.userdata = &included;
+    SDL_SetPointerProperty(hlsl_info.props, SDL_SHADERCROSS_PROP_SHADER_INCLUDE_CALLBACK_POINTER, &include_callback);
+    shader = SDL_ShaderCross_CompileSPIRVFromHLSL(&hlsl_info, &shader_size);
+    SDLTest_AssertCheck(shader != NULL, "SDL_ShaderCross_CompileSPIRVFromHLSL should return a valid compiled shader (%s)", SDL_GetError());
+    // Reported as DXC named it, the way a compile from within the base directory would
+    SDLTest_AssertCheck(included != NULL && SDL_strstr(included, "include_base.hlsl") != NULL && SDL_strstr(included, "shadercross_include_base") == NULL,
+        "The include is reported as \"%s\", should be relative", included ? included : "(none)");
+    SDL_DestroyProperties(hlsl_info.props);
+
+    SDLTest_AssertPass("Compile the same shader with the directory as its include directory");
+    hlsl_info.include_dir = base_dir;
+    hlsl_info.props = 0;
+    shader_with_include_dir = SDL_ShaderCross_CompileSPIRVFromHLSL(&hlsl_info, &shader_with_include_dir_size);
+    SDLTest_AssertCheck(shader_with_include_dir != NULL, "SDL_ShaderCross_CompileSPIRVFromHLSL should return a valid compiled shader (%s)", SDL_GetError());
+    SDLTest_AssertCheck(shader != NULL && shader_with_include_dir != NULL && shader_size == shader_with_include_dir_size &&
+        SDL_memcmp(shader, shader_with_include_dir, shader_size) == 0, "Both compiles should give the same SPIRV");
+    SDL_free(shader_with_include_dir);
+    SDL_free(shader);
+
+    SDLTest_AssertPass("Compile the same shader without an include base directory");
+    hlsl_info.include_dir = NULL;
+    shader = SDL_ShaderCross_CompileSPIRVFromHLSL(&hlsl_info, &shader_size);
+    SDLTest_AssertCheck(shader == NULL, "SDL_ShaderCross_CompileSPIRVFromHLSL should fail to find the include (%s)", SDL_GetError());
+    SDL_free(shader);
+    SDL_ClearError();
+
+    if (include_path != NULL) {
+        SDL_RemovePath(include_path);
+    }
+    if (base_dir != NULL) {
+        SDL_RemovePath(base_dir);
+    }
+    SDL_free(included);
+    SDL_free(include_path);
+    SDL_free(base_dir);
+    return TEST_COMPLETED;
+}
+
 static int SDLCALL shadercross_CompileSPIRV_to_XXX(void *args)
 {
     size_t i;
@@ -134,6 +400,17 @@ static int SDLCALL shadercross_CompileSPIRV_to_XXX(void *args)
         }
     }
 
+    {
+        void *stripped_shader;
+        size_t stripped_shader_size = 0;
+
+        SDLTest_AssertPass("Strip debug information from SPIRV");
+        stripped_shader = SDL_ShaderCross_StripSPIRV(spirv_shader, spirv_shader_size, &stripped_shader_size);
+        SDLTest_AssertCheck(stripped_shader != NULL, "SDL_ShaderCross_StripSPIRV must return a non-NULL shader (%s)", SDL_GetError());
+        SDLTest_AssertCheck(stripped_shader_size != 0 && stripped_shader_size <= spirv_shader_size, "Stripped size is %d, should be > 0 and <= %d", (int)stripped_shader_size, (int)spirv_shader_size);
+        SDL_free(stripped_shader);
+    }
+
     for (i = 0; i < SDL_arraysize(cases); i++) {
         SDL_ShaderCross_SPIRV_Info spirv_info;
         void *shader;
@@ -180,6 +457,49 @@ static int SDLCALL shadercross_CompileSPIRV_to_XXX(void *args)
     return TEST_COMPLETED;
 }
 
+/* A module with two entry points, assembled by hand since DXC only emits one:
+ * vs_main writes gl_Position from the uniform buffer at set 1 binding 0, and
+ * fs_main writes the sum of the uniform buffers at set 3 bindings 0 and 1.
+ */
+static const Uint32 two_entrypoints_spv[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000001b, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000000,
+    0x00000001, 0x6d5f7376, 0x006e6961, 0x00000010, 0x0006000f, 0x00000004,
+    0x00000002, 0x6d5f7366, 0x006e6961, 0x00000011, 0x00030010, 0x00000002,
+    0x00000007, 0x00040005, 0x00000001, 0x6d5f7376, 0x006e6961, 0x00040005,
+    0x00000002, 0x6d5f7366, 0x006e6961, 0x00050005, 0x00000007, 0x6e617254,
+    0x726f6673, 0x0000006d, 0x00050006, 0x00000007, 0x00000000, 0x6f6c6f63,
+    0x00000072, 0x00060005, 0x0000000d, 0x74726556, 0x6e557865, 0x726f6669,
+    0x0000736d, 0x00070005, 0x0000000e, 0x67617246, 0x746e656d, 0x66696e55,
+    0x736d726f, 0x00000000, 0x00060005, 0x0000000f, 0x67617246, 0x746e656d,
+    0x746e6954, 0x00000000, 0x00040047, 0x00000010, 0x0000000b, 0x00000000,
+    0x00040047, 0x00000011, 0x0000001e, 0x00000000, 0x00030047, 0x00000007,
+    0x00000002, 0x00050048, 0x00000007, 0x00000000, 0x00000023, 0x00000000,
+    0x00040047, 0x0000000d, 0x00000022, 0x00000001, 0x00040047, 0x0000000d,
+    0x00000021, 0x00000000, 0x00040047, 0x0000000e, 0x00000022, 0x00000003,
+    0x00040047, 0x0000000e, 0x00000021, 0x00000000, 0x00040047, 0x0000000f,
+    0x00000022, 0x00000003, 0x00040047, 0x0000000f, 0x00000021, 0x00000001,
+    0x00020013, 0x00000003, 0x00030021, 0x00000004, 0x00000003, 0x00030016,
+    0x00000005, 0x00000020, 0x00040017, 0x00000006, 0x00000005, 0x00000004,
+    0x0003001e, 0x00000007, 0x00000006, 0x00040020, 0x00000008, 0x00000002,
+    0x00000007, 0x00040020, 0x00000009, 0x00000002, 0x00000006, 0x00040020,
+    0x0000000a, 0x00000003, 0x00000006, 0x00040015, 0x0000000b, 0x00000020,
+    0x00000001, 0x0004002b, 0x0000000b, 0x0000000c, 0x00000000, 0x0004003b,
+    0x00000008, 0x0000000d, 0x00000002, 0x0004003b, 0x00000008, 0x0000000e,
+    0x00000002, 0x0004003b, 0x00000008, 0x0000000f, 0x00000002, 0x0004003b,
+    0x0000000a, 0x00000010, 0x00000003, 0x0004003b, 0x0000000a, 0x00000011,
+    0x00000003, 0x00050036, 0x00000003, 0x00000001, 0x00000000, 0x00000004,
+    0x000200f8, 0x00000012, 0x00050041, 0x00000009, 0x00000013, 0x0000000d,
+    0x0000000c, 0x0004003d, 0x00000006, 0x00000014, 0x00000013, 0x0003003e,
+    0x00000010, 0x00000014, 0x000100fd, 0x00010038, 0x00050036, 0x00000003,
+    0x00000002, 0x00000000, 0x00000004, 0x000200f8, 0x00000015, 0x00050041,
+    0x00000009, 0x00000016, 0x0000000e, 0x0000000c, 0x0004003d, 0x00000006,
+    0x00000017, 0x00000016, 0x00050041, 0x00000009, 0x00000018, 0x0000000f,
+    0x0000000c, 0x0004003d, 0x00000006, 0x00000019, 0x00000018, 0x00050081,
+    0x00000006, 0x0000001a, 0x00000017, 0x00000019, 0x0003003e, 0x00000011,
+    0x0000001a, 0x000100fd, 0x00010038,
+};
+
 static int SDLCALL shadercross_TranspileSPIRV_to_MSL(void *args)
 {
     void *spirv_shader;
@@ -206,6 +526,7 @@ static int SDLCALL shadercross_TranspileSPIRV_to_MSL(void *args)
         hlsl_info.source = (const char *)simple_vert_hlsl;
         hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
         hlsl_info.entrypoint = "main";
+        SDL_ShaderCross_ResetTimingStats();
         spirv_shader = SDL_ShaderCross_CompileSPIRVFromHLSL(&hlsl_info, &spirv_shader_size);
         SDLTest_AssertCheck(spirv_shader != NULL, "SDL_ShaderCross_CompileSPIRVFromHLSL must return a non-NULL shader (%s)", SDL_GetError());
         if (spirv_shader == NULL) {
@@ -213,15 +534,299 @@ static int SDLCALL shadercross_TranspileSPIRV_to_MSL(void *args)
         }
     }
 
+    {
+        SDL_ShaderCross_TimingStats timing_stats;
+
+        SDLTest_AssertCheck(SDL_ShaderCross_GetTimingStats(&timing_stats), "SDL_ShaderCross_GetTimingStats succeeds (%s)", SDL_GetError());
+        SDLTest_AssertCheck(timing_stats.stages[SDL_SHADERCROSS_TIMINGSTAGE_HLSL_TO_SPIRV].num_calls == 1, "HLSL to SPIRV stage ran %d times for one compile, should be 1", (int)timing_stats.stages[SDL_SHADERCROSS_TIMINGSTAGE_HLSL_TO_SPIRV].num_calls);
+    }
+
     SDLTest_AssertPass("Transpile SPIRV -> MSL");
     SDL_zero(spirv_info);
     spirv_info.bytecode = spirv_shader;
     spirv_info.bytecode_size = spirv_shader_size;
     spirv_info.entrypoint = "main";
+    SDLTest_AssertCheck(SDL_ShaderCross_ResetTimingStats(), "SDL_ShaderCross_ResetTimingStats succeeds (%s)", SDL_GetError());
     msl_shader = SDL_ShaderCross_TranspileMSLFromSPIRV(&spirv_info);
     SDLTest_AssertCheck(msl_shader != NULL, "SDL_ShaderCross_TranspileMSLFromSPIRV returns non-NULL shader (%s)", SDL_GetError());
     SDL_free(msl_shader);
+    {
+        SDL_ShaderCross_TimingStats timing_stats;
+
+        SDLTest_AssertCheck(SDL_ShaderCross_GetTimingStats(&timing_stats), "SDL_ShaderCross_GetTimingStats succeeds (%s)", SDL_GetError());
+        SDLTest_AssertCheck(timing_stats.stages[SDL_SHADERCROSS_TIMINGSTAGE_TRANSPILE].num_calls == 1, "Transpile stage ran %d times, should be 1", (int)timing_stats.stages[SDL_SHADERCROSS_TIMINGSTAGE_TRANSPILE].num_calls);
+        SDLTest_AssertCheck(timing_stats.stages[SDL_SHADERCROSS_TIMINGSTAGE_HLSL_TO_SPIRV].num_calls == 0, "HLSL to SPIRV stage ran %d times, should be 0", (int)timing_stats.stages[SDL_SHADERCROSS_TIMINGSTAGE_HLSL_TO_SPIRV].num_calls);
+    }
+
+    {
+        SDL_ShaderCross_GraphicsShaderMetadata *metadata = NULL;
+        size_t msl_shader_size = 0;
+
+        SDLTest_AssertPass("Transpile and reflect SPIRV -> MSL");
+        msl_shader = SDL_ShaderCross_CompileAndReflectGraphicsSPIRV(&spirv_info, SDL_GPU_SHADERFORMAT_MSL, &msl_shader_size, &metadata);
+        SDLTest_AssertCheck(msl_shader != NULL, "SDL_ShaderCross_CompileAndReflectGraphicsSPIRV returns non-NULL shader (%s)", SDL_GetError());
+        SDLTest_AssertCheck(metadata != NULL, "SDL_ShaderCross_CompileAndReflectGraphicsSPIRV returns non-NULL metadata");
+        if (metadata != NULL) {
+            SDLTest_AssertCheck(metadata->resource_info.num_uniform_buffers == 1, "num_uniform_buffers is %d, should be 1", metadata->resource_info.num_uniform_buffers);
+        }
+        SDL_free(metadata);
+        SDL_free(msl_shader);
+    }
+
+    {
+        SDL_ShaderCross_SPIRVEntryPointOutput *output;
+
+        SDLTest_AssertPass("Compile one SPIRV entry point -> MSL");
+        output = SDL_ShaderCross_CompileSPIRVEntryPoint(&spirv_info, SDL_GPU_SHADERFORMAT_MSL);
+        SDLTest_AssertCheck(output != NULL, "SDL_ShaderCross_CompileSPIRVEntryPoint returns non-NULL output (%s)", SDL_GetError());
+        if (output != NULL) {
+            SDLTest_AssertCheck(SDL_strcmp(output->spirv_entrypoint, "main") == 0, "spirv_entrypoint is \"%s\", should be \"main\"", output->spirv_entrypoint);
+            SDLTest_AssertCheck(SDL_strcmp(output->entrypoint, "main0") == 0, "entrypoint is \"%s\", should be \"main0\" as main is reserved in MSL", output->entrypoint);
+            SDLTest_AssertCheck(output->code != NULL && SDL_strstr((const char *)output->code, output->entrypoint) != NULL, "The MSL defines %s", output->entrypoint);
+            SDLTest_AssertCheck(output->graphics_metadata != NULL && output->graphics_metadata->resource_info.num_uniform_buffers == 1, "The vertex shader has 1 uniform buffer");
+            SDLTest_AssertCheck(output->compute_metadata == NULL, "A vertex shader has no compute metadata");
+            SDL_free(output->code);
+            SDL_free(output->graphics_metadata);
+            SDL_free(output);
+        }
+    }
+
+    {
+        SDL_ShaderCross_MSLArgumentBuffer *argument_buffers;
+        int num_argument_buffers = -1;
+
+        SDLTest_AssertPass("Transpile SPIRV -> MSL with argument buffers");
+        spirv_info.props = SDL_CreateProperties();
+        SDL_SetBooleanProperty(spirv_info.props, SDL_SHADERCROSS_PROP_SPIRV_MSL_ARGUMENT_BUFFERS_BOOLEAN, true);
+        msl_shader = SDL_ShaderCross_TranspileMSLFromSPIRV(&spirv_info);
+        SDLTest_AssertCheck(msl_shader != NULL, "SDL_ShaderCross_TranspileMSLFromSPIRV returns non-NULL shader (%s)", SDL_GetError());
+        SDL_free(msl_shader);
+
+        // The uniform buffer stays discrete, so there is nothing to put in an argument buffer
+        argument_buffers = SDL_ShaderCross_ReflectMSLArgumentBuffers(&spirv_info, &num_argument_buffers);
+        SDLTest_AssertCheck(argument_buffers != NULL, "SDL_ShaderCross_ReflectMSLArgumentBuffers returns non-NULL layout (%s)", SDL_GetError());
+        SDLTest_AssertCheck(num_argument_buffers == 0, "num_argument_buffers is %d, should be 0", num_argument_buffers);
+        SDL_free(argument_buffers);
+        SDL_DestroyProperties(spirv_info.props);
+        spirv_info.props = 0;
+    }
+
+    {
+        SDL_ShaderCross_SPIRVEntryPointOutput *outputs;
+        int num_outputs = 0;
+        int j;
+
+        SDLTest_AssertPass("Transpile every entry point SPIRV -> MSL");
+        outputs = SDL_ShaderCross_CompileAllSPIRVEntryPoints(spirv_shader, spirv_shader_size, 0, SDL_GPU_SHADERFORMAT_MSL, &num_outputs);
+        SDLTest_AssertCheck(outputs != NULL, "SDL_ShaderCross_CompileAllSPIRVEntryPoints returns non-NULL outputs (%s)", SDL_GetError());
+        SDLTest_AssertCheck(num_outputs == 1, "num_outputs is %d, should be 1", num_outputs);
+        if (outputs != NULL && num_outputs == 1) {
+            SDLTest_AssertCheck(SDL_strcmp(outputs[0].spirv_entrypoint, "main") == 0, "spirv_entrypoint is \"%s\", should be \"main\"", outputs[0].spirv_entrypoint);
+            SDLTest_AssertCheck(outputs[0].shader_stage == SDL_SHADERCROSS_SHADERSTAGE_VERTEX, "shader_stage should be vertex");
+            SDLTest_AssertCheck(outputs[0].graphics_metadata != NULL, "graphics_metadata should be non-NULL");
+            SDL_free(outputs[0].code);
+            SDL_free(outputs[0].graphics_metadata);
+        }
+        SDL_free(outputs);
+
+        SDLTest_AssertPass("Transpile a SPIRV module with a vertex and a fragment entry point -> MSL");
+        outputs = SDL_ShaderCross_CompileAllSPIRVEntryPoints((const Uint8 *)two_entrypoints_spv, sizeof(two_entrypoints_spv), 0, SDL_GPU_SHADERFORMAT_MSL, &num_outputs);
+        SDLTest_AssertCheck(outputs != NULL, "SDL_ShaderCross_CompileAllSPIRVEntryPoints returns non-NULL outputs (%s)", SDL_GetError());
+        SDLTest_AssertCheck(num_outputs == 2, "num_outputs is %d, should be 2", num_outputs);
+        if (outputs != NULL && num_outputs == 2) {
+            // Each entry point only counts the resources it uses
+            SDLTest_AssertCheck(SDL_strcmp(outputs[0].spirv_entrypoint, "vs_main") == 0, "spirv_entrypoint is \"%s\", should be \"vs_main\"", outputs[0].spirv_entrypoint);
+            SDLTest_AssertCheck(outputs[0].shader_stage == SDL_SHADERCROSS_SHADERSTAGE_VERTEX, "shader_stage of vs_main should be vertex");
+            SDLTest_AssertCheck(outputs[0].code != NULL && SDL_strstr((const char *)outputs[0].code, "vertex") != NULL, "vs_main should be a vertex function");
+            SDLTest_AssertCheck(outputs[0].graphics_metadata != NULL && outputs[0].graphics_metadata->resource_info.num_uniform_buffers == 1, "vs_main should use 1 uniform buffer");
+            SDLTest_AssertCheck(SDL_strcmp(outputs[1].spirv_entrypoint, "fs_main") == 0, "spirv_entrypoint is \"%s\", should be \"fs_main\"", outputs[1].spirv_entrypoint);
+            SDLTest_AssertCheck(outputs[1].shader_stage == SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT, "shader_stage of fs_main should be fragment");
+            SDLTest_AssertCheck(outputs[1].code != NULL && SDL_strstr((const char *)outputs[1].code, "fragment") != NULL, "fs_main should be a fragment function");
+            SDLTest_AssertCheck(outputs[1].graphics_metadata != NULL && outputs[1].graphics_metadata->resource_info.num_uniform_buffers == 2, "fs_main should use 2 uniform buffers");
+        }
+        for (j = 0; outputs != NULL && j < num_outputs; j++) {
+            SDL_free(outputs[j].code);
+            SDL_free(outputs[j].graphics_metadata);
+            SDL_free(outputs[j].compute_metadata);
+        }
+        SDL_free(outputs);
+    }
+
+    SDL_free(spirv_shader);
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL shadercross_MSLArgumentBuffers(void *args)
+{
+    // The texture and its sampler share binding 0 of set 2, the storage buffer is binding 1 and the uniform buffer is alone in set 3
+    static const char resources_frag_hlsl[] =
+        "Texture2D<float4> Tex : register(t0, space2);\n"
+        "SamplerState Samp : register(s0, space2);\n"
+        "StructuredBuffer<float4> Buf : register(t1, space2);\n"
+        "cbuffer Uniforms : register(b0, space3) { float4 Tint; };\n"
+        "float4 main(float2 uv : TEXCOORD0) : SV_Target0 { return Tex.Sample(Samp, uv) * Tint + Buf[0]; }\n";
+    void *spirv_shader;
+    size_t spirv_shader_size;
+    char *msl_shader;
+    SDL_ShaderCross_SPIRV_Info spirv_info;
+    SDL_ShaderCross_MSLArgumentBuffer *argument_buffers;
+    int num_argument_buffers = -1;
+
+    (void)args;
+    if (!(SDL_ShaderCross_GetSPIRVShaderFormats() & SDL_GPU_SHADERFORMAT_MSL)) {
+        SDLTest_AssertPass("SDL_ShaderCross does not support SPIRV -> MSL");
+        return TEST_SKIPPED;
+    }
+
+    {
+        SDL_ShaderCross_HLSL_Info hlsl_info;
+
+        SDLTest_AssertPass("Prepare SPIRV fragment shader with a texture, a sampler and a storage buffer (HLSL -> SPIRV)");
+        if (!(SDL_ShaderCross_GetHLSLShaderFormats() & SDL_GPU_SHADERFORMAT_SPIRV)) {
+            SDLTest_AssertPass("SDL_ShaderCross does not support HLSL -> SPIRV");
+            return TEST_SKIPPED;
+        }
+
+        SDL_zero(hlsl_info);
+        hlsl_info.source = resources_frag_hlsl;
+        hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
+        hlsl_info.entrypoint = "main";
+        spirv_shader = SDL_ShaderCross_CompileSPIRVFromHLSL(&hlsl_info, &spirv_shader_size);
+        SDLTest_AssertCheck(spirv_shader != NULL, "SDL_ShaderCross_CompileSPIRVFromHLSL must return a non-NULL shader (%s)", SDL_GetError());
+        if (spirv_shader == NULL) {
+            return TEST_ABORTED;
+        }
+    }
+
+    SDL_zero(spirv_info);
+    spirv_info.bytecode = spirv_shader;
+    spirv_info.bytecode_size = spirv_shader_size;
+    spirv_info.entrypoint = "main";
+    spirv_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
+    spirv_info.props = SDL_CreateProperties();
+    SDL_SetBooleanProperty(spirv_info.props, SDL_SHADERCROSS_PROP_SPIRV_MSL_ARGUMENT_BUFFERS_BOOLEAN, true);
+
+    SDLTest_AssertPass("Reflect the MSL argument buffers");
+    argument_buffers = SDL_ShaderCross_ReflectMSLArgumentBuffers(&spirv_info, &num_argument_buffers);
+    SDLTest_AssertCheck(argument_buffers != NULL, "SDL_ShaderCross_ReflectMSLArgumentBuffers returns non-NULL layout (%s)", SDL_GetError());
+    SDLTest_AssertCheck(num_argument_buffers == 1, "num_argument_buffers is %d, should be 1", num_argument_buffers);
+    if (argument_buffers != NULL && num_argument_buffers == 1) {
+        const SDL_ShaderCross_MSLArgument *arguments = argument_buffers[0].arguments;
+
+        SDLTest_AssertCheck(argument_buffers[0].descriptor_set == 2, "descriptor_set is %d, should be 2", (int)argument_buffers[0].descriptor_set);
+        // The uniform buffer takes [[buffer(0)]]
+        SDLTest_AssertCheck(argument_buffers[0].buffer_index == 1, "buffer_index is %d, should be 1", (int)argument_buffers[0].buffer_index);
+        SDLTest_AssertCheck(argument_buffers[0].num_arguments == 2, "num_arguments is %d, should be 2", (int)argument_buffers[0].num_arguments);
+        if (argument_buffers[0].num_arguments == 2) {
+            SDLTest_AssertCheck(arguments[0].binding == 0 && arguments[0].type == SDL_SHADERCROSS_MSLARGUMENTTYPE_SAMPLED_TEXTURE, "The first argument should be the sampled texture at binding 0");
+            SDLTest_AssertCheck(arguments[0].id == 0 && arguments[0].sampler_id == 1, "The sampled texture ids are %d and %d, should be 0 and 1", (int)arguments[0].id, (int)arguments[0].sampler_id);
+            SDLTest_AssertCheck(arguments[1].binding == 1 && arguments[1].type == SDL_SHADERCROSS_MSLARGUMENTTYPE_STORAGE_BUFFER, "The second argument should be the storage buffer at binding 1");
+            SDLTest_AssertCheck(arguments[1].id == 2, "The storage buffer id is %d, should be 2", (int)arguments[1].id);
+        }
+    }
+    SDL_free(argument_buffers);
+
+    SDLTest_AssertPass("Transpile SPIRV -> MSL with argument buffers");
+    msl_shader = (char *)SDL_ShaderCross_TranspileMSLFromSPIRV(&spirv_info);
+    SDLTest_AssertCheck(msl_shader != NULL, "SDL_ShaderCross_TranspileMSLFromSPIRV returns non-NULL shader (%s)", SDL_GetError());
+    if (msl_shader != NULL) {
+        SDLTest_AssertCheck(SDL_strstr(msl_shader, "[[id(2)]]") != NULL, "The MSL should give the storage buffer [[id(2)]]");
+        SDLTest_AssertCheck(SDL_strstr(msl_shader, "[[buffer(1)]]") != NULL, "The MSL should bind the argument buffer to [[buffer(1)]]");
+    }
+    SDL_free(msl_shader);
+
+    SDL_DestroyProperties(spirv_info.props);
+    SDL_free(spirv_shader);
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL shadercross_SpecializeSPIRV(void *args)
+{
+    static const char spec_frag_hlsl[] =
+        "[[vk::constant_id(7)]] const int Count = 3;\n"
+        "[[vk::constant_id(8)]] const bool UseRed = false;\n"
+        "float4 main() : SV_Target0 { return UseRed ? float4(Count, 0, 0, 1) : float4(0, Count, 0, 1); }\n";
+    void *spirv_shader;
+    size_t spirv_shader_size;
+    char *msl_shader;
+    SDL_ShaderCross_SPIRV_Info spirv_info;
+    SDL_ShaderCross_SpecializationConstant constants[2];
+
+    (void)args;
+    if (!(SDL_ShaderCross_GetSPIRVShaderFormats() & SDL_GPU_SHADERFORMAT_MSL)) {
+        SDLTest_AssertPass("SDL_ShaderCross does not support SPIRV -> MSL");
+        return TEST_SKIPPED;
+    }
+
+    {
+        SDL_ShaderCross_HLSL_Info hlsl_info;
+
+        SDLTest_AssertPass("Prepare SPIRV fragment shader with specialization constants (HLSL -> SPIRV)");
+        if (!(SDL_ShaderCross_GetHLSLShaderFormats() & SDL_GPU_SHADERFORMAT_SPIRV)) {
+            SDLTest_AssertPass("SDL_ShaderCross does not support HLSL -> SPIRV");
+            return TEST_SKIPPED;
+        }
+
+        SDL_zero(hlsl_info);
+        hlsl_info.source = spec_frag_hlsl;
+        hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
+        hlsl_info.entrypoint = "main";
+        spirv_shader = SDL_ShaderCross_CompileSPIRVFromHLSL(&hlsl_info, &spirv_shader_size);
+        SDLTest_AssertCheck(spirv_shader != NULL, "SDL_ShaderCross_CompileSPIRVFromHLSL must return a non-NULL shader (%s)", SDL_GetError());
+        if (spirv_shader == NULL) {
+            return TEST_ABORTED;
+        }
+    }
+
+    SDL_zero(spirv_info);
+    spirv_info.bytecode = spirv_shader;
+    spirv_info.bytecode_size = spirv_shader_size;
+    spirv_info.entrypoint = "main";
+    spirv_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT;
+
+    SDLTest_AssertPass("Transpile SPIRV -> MSL without overrides");
+    msl_shader = (char *)SDL_ShaderCross_TranspileMSLFromSPIRV(&spirv_info);
+    SDLTest_AssertCheck(msl_shader != NULL, "SDL_ShaderCross_TranspileMSLFromSPIRV returns non-NULL shader (%s)", SDL_GetError());
+    if (msl_shader != NULL) {
+        SDLTest_AssertCheck(SDL_strstr(msl_shader, "function_constant(7)") != NULL, "Count should be a function constant");
+        SDLTest_AssertCheck(SDL_strstr(msl_shader, "function_constant(8)") != NULL, "UseRed should be a function constant");
+    }
+    SDL_free(msl_shader);
 
+    SDLTest_AssertPass("Transpile SPIRV -> MSL with overrides by constant_id and by name");
+    SDL_zero(constants);
+    constants[0].constant_id = 7;
+    constants[0].value = 1234567;
+    constants[1].name = "UseRed";
+    constants[1].value = 1;
+    spirv_info.props = SDL_CreateProperties();
+    SDL_SetPointerProperty(spirv_info.props, SDL_SHADERCROSS_PROP_SPIRV_SPECIALIZATION_CONSTANTS_POINTER, constants);
+    SDL_SetNumberProperty(spirv_info.props, SDL_SHADERCROSS_PROP_SPIRV_NUM_SPECIALIZATION_CONSTANTS_NUMBER, SDL_arraysize(constants));
+    msl_shader = (char *)SDL_ShaderCross_TranspileMSLFromSPIRV(&spirv_info);
+    SDLTest_AssertCheck(msl_shader != NULL, "SDL_ShaderCross_TranspileMSLFromSPIRV returns non-NULL shader (%s)", SDL_GetError());
+    if (msl_shader != NULL) {
+        SDLTest_AssertCheck(SDL_strstr(msl_shader, "function_constant") == NULL, "No function constants should be left");
+        SDLTest_AssertCheck(SDL_strstr(msl_shader, "1234567") != NULL, "The MSL should contain the new value of Count");
+        SDLTest_AssertCheck(SDL_strstr(msl_shader, "true") != NULL, "The MSL should contain the new value of UseRed");
+    }
+    SDL_free(msl_shader);
+
+    SDLTest_AssertPass("Transpile SPIRV -> MSL with an override of an unknown name");
+    constants[1].name = "UseBlue";
+    msl_shader = (char *)SDL_ShaderCross_TranspileMSLFromSPIRV(&spirv_info);
+    SDLTest_AssertCheck(msl_shader == NULL, "SDL_ShaderCross_TranspileMSLFromSPIRV should fail (%s)", SDL_GetError());
+    SDL_free(msl_shader);
+    SDL_ClearError();
+
+    SDLTest_AssertPass("Transpile SPIRV -> MSL with an override of an unknown constant_id");
+    constants[1].name = "UseRed";
+    constants[0].constant_id = 9;
+    msl_shader = (char *)SDL_ShaderCross_TranspileMSLFromSPIRV(&spirv_info);
+    SDLTest_AssertCheck(msl_shader == NULL, "SDL_ShaderCross_TranspileMSLFromSPIRV should fail (%s)", SDL_GetError());
+    SDL_free(msl_shader);
+    SDL_ClearError();
+
+    SDL_DestroyProperties(spirv_info.props);
     SDL_free(spirv_shader);
     return TEST_COMPLETED;
 }
@@ -317,12 +922,395 @@ static int SDLCALL shadercross_ReflectSPIRV(void *args)
         log_SDL_ShaderCross_IOVarMetadata(i, &shader_gfx_metadata->outputs[i]);
     }
 
+    SDLTest_AssertPass("Reflect SPIRV into caller-owned storage");
+
+    {
+        size_t buffer_size = 0;
+        void *buffer;
+        SDL_ShaderCross_GraphicsShaderMetadata *buffer_metadata;
+
+        SDLTest_AssertCheck(SDL_ShaderCross_ReflectGraphicsSPIRVInto(spirv_shader, spirv_shader_size, 0, NULL, &buffer_size), "SDL_ShaderCross_ReflectGraphicsSPIRVInto size query succeeds (%s)", SDL_GetError());
+        SDLTest_AssertCheck(buffer_size >= sizeof(SDL_ShaderCross_GraphicsShaderMetadata), "buffer_size is %d, should be at least %d", (int)buffer_size, (int)sizeof(SDL_ShaderCross_GraphicsShaderMetadata));
+
+        buffer = SDL_malloc(buffer_size);
+        SDLTest_AssertCheck(SDL_ShaderCross_ReflectGraphicsSPIRVInto(spirv_shader, spirv_shader_size, 0, buffer, &buffer_size), "SDL_ShaderCross_ReflectGraphicsSPIRVInto succeeds (%s)", SDL_GetError());
+        buffer_metadata = (SDL_ShaderCross_GraphicsShaderMetadata *)buffer;
+        SDLTest_AssertCheck(buffer_metadata->resource_info.num_uniform_buffers == shader_gfx_metadata->resource_info.num_uniform_buffers, "num_uniform_buffers is %d, should be %d", buffer_metadata->resource_info.num_uniform_buffers, shader_gfx_metadata->resource_info.num_uniform_buffers);
+        SDLTest_AssertCheck(buffer_metadata->num_inputs == shader_gfx_metadata->num_inputs, "num_inputs is %d, should be %d", buffer_metadata->num_inputs, shader_gfx_metadata->num_inputs);
+        SDLTest_AssertCheck(buffer_metadata->num_outputs == shader_gfx_metadata->num_outputs, "num_outputs is %d, should be %d", buffer_metadata->num_outputs, shader_gfx_metadata->num_outputs);
+        for (i = 0; i < buffer_metadata->num_inputs; i++) {
+            SDLTest_AssertCheck(SDL_strcmp(buffer_metadata->inputs[i].name, shader_gfx_metadata->inputs[i].name) == 0, "input %d is named \"%s\", should be \"%s\"", i, buffer_metadata->inputs[i].name, shader_gfx_metadata->inputs[i].name);
+        }
+
+        buffer_size -= 1;
+        SDLTest_AssertCheck(!SDL_ShaderCross_ReflectGraphicsSPIRVInto(spirv_shader, spirv_shader_size, 0, buffer, &buffer_size), "SDL_ShaderCross_ReflectGraphicsSPIRVInto fails with a buffer that is too small");
+        SDL_free(buffer);
+    }
+
     SDL_free(shader_gfx_metadata);
 
     SDL_free(spirv_shader);
     return TEST_COMPLETED;
 }
 
+static int SDLCALL shadercross_ReflectManyResources(void *args)
+{
+    /* More resources than the 32-entry binding tables the MSL remapping used to have */
+    enum { NUM_BUFFERS = 40 };
+    char source[4096];
+    size_t length = 0;
+    Uint32 i;
+    SDL_ShaderCross_HLSL_Info hlsl_info;
+    SDL_ShaderCross_SPIRV_Info spirv_info;
+    SDL_ShaderCross_ComputePipelineMetadata *metadata;
+    void *spirv_shader;
+    size_t spirv_shader_size;
+    char *msl_shader;
+    size_t msl_shader_size;
+
+    (void)args;
+    if (!(SDL_ShaderCross_GetHLSLShaderFormats() & SDL_GPU_SHADERFORMAT_SPIRV)) {
+        SDLTest_AssertPass("SDL_ShaderCross does not support HLSL -> SPIRV");
+        return TEST_SKIPPED;
+    }
+    if (!(SDL_ShaderCross_GetSPIRVShaderFormats() & SDL_GPU_SHADERFORMAT_MSL)) {
+        SDLTest_AssertPass("SDL_ShaderCross does not support SPIRV -> MSL");
+        return TEST_SKIPPED;
+    }
+
+    /* Every buffer is read so that none of them is optimized away */
+    for (i = 0; i < NUM_BUFFERS; i++) {
+        length += SDL_snprintf(source + length, sizeof(source) - length, "StructuredBuffer<uint> b%u : register(t%u, space0);\n", (unsigned)i, (unsigned)i);
+    }
+    length += SDL_snprintf(source + length, sizeof(source) - length,
+        "RWStructuredBuffer<uint> Output : register(u0, space1);\n"
+        "[numthreads(64, 1, 1)]\n"
+        "void main(uint3 id : SV_DispatchThreadID)\n"
+        "{\n"
+        "    uint sum = 0;\n");
+    for (i = 0; i < NUM_BUFFERS; i++) {
+        length += SDL_snprintf(source + length, sizeof(source) - length, "    sum += b%u[id.x];\n", (unsigned)i);
+    }
+    length += SDL_snprintf(source + length, sizeof(source) - length,
+        "    Output[id.x] = sum;\n"
+        "}\n");
+    SDL_assert(length < sizeof(source));
+
+    SDLTest_AssertPass("Prepare SPIRV compute shader with %d storage buffers (HLSL -> SPIRV)", NUM_BUFFERS);
+    SDL_zero(hlsl_info);
+    hlsl_info.source = source;
+    hlsl_info.entrypoint = "main";
+    hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
+    spirv_shader = SDL_ShaderCross_CompileSPIRVFromHLSL(&hlsl_info, &spirv_shader_size);
+    SDLTest_AssertCheck(spirv_shader != NULL, "SDL_ShaderCross_CompileSPIRVFromHLSL must return a non-NULL shader (%s)", SDL_GetError());
+    if (spirv_shader == NULL) {
+        return TEST_ABORTED;
+    }
+
+    SDLTest_AssertPass("Reflect SPIRV");
+    metadata = SDL_ShaderCross_ReflectComputeSPIRV(spirv_shader, spirv_shader_size, 0);
+    SDLTest_AssertCheck(metadata != NULL, "SDL_ShaderCross_ReflectComputeSPIRV returns non-NULL metadata (%s)", SDL_GetError());
+    if (metadata != NULL) {
+        SDLTest_AssertCheck(metadata->num_readonly_storage_buffers == NUM_BUFFERS, "num_readonly_storage_buffers is %d, should be %d", metadata->num_readonly_storage_buffers, NUM_BUFFERS);
+        SDLTest_AssertCheck(metadata->num_readwrite_storage_buffers == 1, "num_readwrite_storage_buffers is %d, should be 1", metadata->num_readwrite_storage_buffers);
+    }
+    SDL_free(metadata);
+
+    SDLTest_AssertPass("Transpile and reflect SPIRV -> MSL");
+    SDL_zero(spirv_info);
+    spirv_info.bytecode = spirv_shader;
+    spirv_info.bytecode_size = spirv_shader_size;
+    spirv_info.entrypoint = "main";
+    spirv_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
+    metadata = NULL;
+    msl_shader_size = 0;
+    msl_shader = (char *)SDL_ShaderCross_CompileAndReflectComputeSPIRV(&spirv_info, SDL_GPU_SHADERFORMAT_MSL, &msl_shader_size, &metadata);
+    SDLTest_AssertCheck(msl_shader != NULL, "SDL_ShaderCross_CompileAndReflectComputeSPIRV returns non-NULL shader (%s)", SDL_GetError());
+    SDLTest_AssertCheck(metadata != NULL, "SDL_ShaderCross_CompileAndReflectComputeSPIRV returns non-NULL metadata");
+    if (metadata != NULL) {
+        SDLTest_AssertCheck(metadata->num_readonly_storage_buffers == NUM_BUFFERS, "num_readonly_storage_buffers is %d, should be %d", metadata->num_readonly_storage_buffers, NUM_BUFFERS);
+        SDLTest_AssertCheck(metadata->num_readwrite_storage_buffers == 1, "num_readwrite_storage_buffers is %d, should be 1", metadata->num_readwrite_storage_buffers);
+    }
+    if (msl_shader != NULL) {
+        /* The read-write buffer is bound after all the read-only ones */
+        SDLTest_AssertCheck(SDL_strstr(msl_shader, "[[buffer(40)]]") != NULL, "MSL binds the read-write buffer at index %d", NUM_BUFFERS);
+    }
+    SDL_free(metadata);
+    SDL_free(msl_shader);
+
+    SDL_free(spirv_shader);
+    return TEST_COMPLETED;
+}
+
+static Uint64 hash_bundle_name(const char *name)
+{
+    Uint64 hash = 0xcbf29ce484222325ULL;
+    for (; *name != '\0'; name++) {
+        hash = (hash ^ (Uint8)*name) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static void init_bundle_entry(SDL_ShaderCross_BundleEntry *entry, const char *name, Uint32 name_offset, Uint32 shader_stage, Uint64 code_offset)
+{
+    SDL_zerop(entry);
+    entry->hash = SDL_Swap64LE(hash_bundle_name(name));
+    entry->code_offset = SDL_Swap64LE(code_offset);
+    entry->code_size = SDL_Swap64LE(SDL_SHADERCROSS_BUNDLE_ALIGNMENT);
+    entry->name_offset = SDL_Swap32LE(name_offset);
+    entry->entrypoint_offset = SDL_Swap32LE(5); /* "main" */
+    entry->format = SDL_Swap32LE(SDL_GPU_SHADERFORMAT_PRIVATE);
+    entry->shader_stage = SDL_Swap32LE(shader_stage);
+}
+
+/* Lays out a bundle the way the CLI writes it: the header, the entries sorted by hash, the string table and the aligned code */
+static size_t build_test_bundle(Uint8 *data, size_t capacity)
+{
+    static const char strings[] = "good\0main\0bad";
+    SDL_ShaderCross_BundleHeader header;
+    SDL_ShaderCross_BundleEntry entries[2];
+    Uint64 entries_offset = sizeof(header);
+    Uint64 strings_offset = entries_offset + sizeof(entries);
+    Uint64 code_offset = (strings_offset + sizeof(strings) + SDL_SHADERCROSS_BUNDLE_ALIGNMENT - 1) & ~(Uint64)(SDL_SHADERCROSS_BUNDLE_ALIGNMENT - 1);
+    size_t size = (size_t)code_offset + SDL_SHADERCROSS_BUNDLE_ALIGNMENT;
+    bool good_first = hash_bundle_name("good") < hash_bundle_name("bad");
+
+    SDL_assert(size <= capacity);
+    SDL_memset(data, 0, size);
+
+    SDL_zero(header);
+    header.magic = SDL_Swap32LE(SDL_SHADERCROSS_BUNDLE_MAGIC);
+    header.version = SDL_Swap32LE(SDL_SHADERCROSS_BUNDLE_VERSION);
+    header.num_entries = SDL_Swap32LE(SDL_arraysize(entries));
+    header.entry_size = SDL_Swap32LE(sizeof(SDL_ShaderCross_BundleEntry));
+    header.entries_offset = SDL_Swap64LE(entries_offset);
+    header.strings_offset = SDL_Swap64LE(strings_offset);
+    header.strings_size = SDL_Swap64LE(sizeof(strings));
+
+    /* Both entries share the code, and "bad" has a shader stage past SDL_SHADERCROSS_SHADERSTAGE_COMPUTE */
+    init_bundle_entry(&entries[good_first ? 0 : 1], "good", 0, SDL_SHADERCROSS_SHADERSTAGE_FRAGMENT, code_offset);
+    init_bundle_entry(&entries[good_first ? 1 : 0], "bad", 10, 7, code_offset);
+
+    SDL_memcpy(data, &header, sizeof(header));
+    SDL_memcpy(data + entries_offset, entries, sizeof(entries));
+    SDL_memcpy(data + strings_offset, strings, sizeof(strings));
+    return size;
+}
+
+static int SDLCALL shadercross_OpenBundle(void *args)
+{
+    Uint8 data[512];
+    Uint8 corrupt[512];
+    size_t size;
+    SDL_GPUDevice *device;
+    SDL_ShaderCross_Bundle *bundle;
+    SDL_ShaderCross_BundleHeader header;
+
+    (void)args;
+    device = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXBC | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL, false, NULL);
+    if (device == NULL) {
+        SDLTest_AssertPass("No GPU device to open bundles for (%s)", SDL_GetError());
+        return TEST_SKIPPED;
+    }
+    size = build_test_bundle(data, sizeof(data));
+
+    SDLTest_AssertPass("Open a valid bundle");
+    bundle = SDL_ShaderCross_OpenBundleFromMemory(device, data, size);
+    SDLTest_AssertCheck(bundle != NULL, "SDL_ShaderCross_OpenBundleFromMemory succeeds (%s)", SDL_GetError());
+    if (bundle != NULL) {
+        SDLTest_AssertCheck(SDL_ShaderCross_GetBundleGraphicsShader(bundle, "missing") == NULL, "A shader that is not in the bundle is not found");
+        SDLTest_AssertCheck(SDL_ShaderCross_GetBundleGraphicsShader(bundle, "bad") == NULL, "An entry with an invalid shader stage is rejected");
+        SDLTest_AssertCheck(SDL_strstr(SDL_GetError(), "corrupt") != NULL, "The entry is reported as corrupt (%s)", SDL_GetError());
+        SDL_ShaderCross_CloseBundle(bundle);
+    }
+
+    SDLTest_AssertPass("Open a bundle with a truncated header");
+    SDLTest_AssertCheck(SDL_ShaderCross_OpenBundleFromMemory(device, data, sizeof(header) - 1) == NULL, "SDL_ShaderCross_OpenBundleFromMemory fails (%s)", SDL_GetError());
+
+    SDLTest_AssertPass("Open a bundle with entries past its end");
+    SDL_memcpy(corrupt, data, size);
+    SDL_memcpy(&header, corrupt, sizeof(header));
+    header.entries_offset = SDL_Swap64LE(size - sizeof(SDL_ShaderCross_BundleEntry) + 1);
+    SDL_memcpy(corrupt, &header, sizeof(header));
+    SDLTest_AssertCheck(SDL_ShaderCross_OpenBundleFromMemory(device, corrupt, size) == NULL, "SDL_ShaderCross_OpenBundleFromMemory fails (%s)", SDL_GetError());
+
+    SDLTest_AssertPass("Open a bundle with a string table past its end");
+    SDL_memcpy(corrupt, data, size);
+    SDL_memcpy(&header, corrupt, sizeof(header));
+    header.strings_offset = SDL_Swap64LE(size + 1);
+    SDL_memcpy(corrupt, &header, sizeof(header));
+    SDLTest_AssertCheck(SDL_ShaderCross_OpenBundleFromMemory(device, corrupt, size) == NULL, "SDL_ShaderCross_OpenBundleFromMemory fails (%s)", SDL_GetError());
+
+    SDLTest_AssertPass("Open a bundle with an unterminated string table");
+    SDL_memcpy(corrupt, data, size);
+    SDL_memcpy(&header, corrupt, sizeof(header));
+    header.strings_size = SDL_Swap64LE(SDL_Swap64LE(header.strings_size) - 1);
+    SDL_memcpy(corrupt, &header, sizeof(header));
+    SDLTest_AssertCheck(SDL_ShaderCross_OpenBundleFromMemory(device, corrupt, size) == NULL, "SDL_ShaderCross_OpenBundleFromMemory fails (%s)", SDL_GetError());
+
+    SDL_DestroyGPUDevice(device);
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL shadercross_WriteBundle(void *args)
+{
+    SDL_ShaderCross_BundleHeader header;
+    SDL_ShaderCross_BundleEntry entries[4];
+    const char *names[4];
+    Uint8 *data;
+    size_t size;
+    Uint64 strings_offset;
+    Uint64 strings_size;
+    Uint32 num_entries;
+    Uint32 i;
+    int num_spirv = 0;
+    int num_shared = 0;
+
+    (void)args;
+    if (written_bundle_path == NULL) {
+        SDLTest_AssertPass("No bundle given with --bundle");
+        return TEST_SKIPPED;
+    }
+
+    data = (Uint8 *)SDL_LoadFile(written_bundle_path, &size);
+    SDLTest_AssertCheck(data != NULL, "SDL_LoadFile(\"%s\") succeeds (%s)", written_bundle_path, SDL_GetError());
+    if (data == NULL) {
+        return TEST_ABORTED;
+    }
+
+    SDLTest_AssertPass("Check the header");
+    SDLTest_AssertCheck(size >= sizeof(header), "Bundle is %d bytes, should hold a header", (int)size);
+    if (size < sizeof(header)) {
+        SDL_free(data);
+        return TEST_ABORTED;
+    }
+    SDL_memcpy(&header, data, sizeof(header));
+    num_entries = SDL_Swap32LE(header.num_entries);
+    strings_offset = SDL_Swap64LE(header.strings_offset);
+    strings_size = SDL_Swap64LE(header.strings_size);
+    SDLTest_AssertCheck(SDL_Swap32LE(header.magic) == SDL_SHADERCROSS_BUNDLE_MAGIC, "magic is 0x%08x, should be 0x%08x", SDL_Swap32LE(header.magic), SDL_SHADERCROSS_BUNDLE_MAGIC);
+    SDLTest_AssertCheck(SDL_Swap32LE(header.entry_size) == sizeof(SDL_ShaderCross_BundleEntry), "entry_size is %d, should be %d", (int)SDL_Swap32LE(header.entry_size), (int)sizeof(SDL_ShaderCross_BundleEntry));
+    /* "second" has a MSL and a SPIRV target, "first" and "copy" a SPIRV one */
+    SDLTest_AssertCheck(num_entries == SDL_arraysize(entries), "num_entries is %d, should be %d", (int)num_entries, (int)SDL_arraysize(entries));
+    if (num_entries != SDL_arraysize(entries) ||
+        SDL_Swap64LE(header.entries_offset) + sizeof(entries) > size ||
+        strings_offset + strings_size > size || strings_size == 0 || data[strings_offset + strings_size - 1] != '\0') {
+        SDL_free(data);
+        return TEST_ABORTED;
+    }
+    SDL_memcpy(entries, data + SDL_Swap64LE(header.entries_offset), sizeof(entries));
+
+    for (i = 0; i < num_entries; i++) {
+        Uint64 code_offset = SDL_Swap64LE(entries[i].code_offset);
+        Uint32 name_offset = SDL_Swap32LE(entries[i].name_offset);
+
+        SDLTest_AssertCheck(name_offset < strings_size, "Entry %d has its name in the string table", (int)i);
+        names[i] = name_offset < strings_size ? (const char *)data + strings_offset + name_offset : "";
+        SDLTest_AssertCheck(SDL_Swap64LE(entries[i].hash) == hash_bundle_name(names[i]), "Entry %d is hashed from its name \"%s\"", (int)i, names[i]);
+        SDLTest_AssertCheck(code_offset % SDL_SHADERCROSS_BUNDLE_ALIGNMENT == 0, "Entry %d has aligned code", (int)i);
+        SDLTest_AssertCheck(code_offset + SDL_Swap64LE(entries[i].code_size) <= size, "Entry %d has its code in the bundle", (int)i);
+        if (SDL_Swap32LE(entries[i].format) == SDL_GPU_SHADERFORMAT_SPIRV) {
+            num_spirv++;
+        }
+    }
+
+    SDLTest_AssertPass("Check the entries are sorted by hash, name and format, without duplicates");
+    for (i = 1; i < num_entries; i++) {
+        Uint64 previous_hash = SDL_Swap64LE(entries[i - 1].hash);
+        Uint64 hash = SDL_Swap64LE(entries[i].hash);
+        int names_order = SDL_strcmp(names[i - 1], names[i]);
+        bool ordered = previous_hash < hash ||
+            (previous_hash == hash && (names_order < 0 ||
+            (names_order == 0 && SDL_Swap32LE(entries[i - 1].format) < SDL_Swap32LE(entries[i].format))));
+        SDLTest_AssertCheck(ordered, "Entry %d (\"%s\") sorts strictly after entry %d (\"%s\")", (int)i, names[i], (int)i - 1, names[i - 1]);
+    }
+
+    SDLTest_AssertPass("Check the SPIRV code is stored once");
+    SDLTest_AssertCheck(num_spirv == 3, "%d entries are SPIRV, should be 3", num_spirv);
+    for (i = 0; i < num_entries; i++) {
+        if (SDL_Swap32LE(entries[i].format) == SDL_GPU_SHADERFORMAT_SPIRV) {
+            break;
+        }
+    }
+    if (i < num_entries) {
+        Uint64 spirv_offset = SDL_Swap64LE(entries[i].code_offset);
+        for (i = 0; i < num_entries; i++) {
+            if (SDL_Swap32LE(entries[i].format) == SDL_GPU_SHADERFORMAT_SPIRV && SDL_Swap64LE(entries[i].code_offset) == spirv_offset) {
+                num_shared++;
+            }
+        }
+    }
+    SDLTest_AssertCheck(num_shared == 3, "%d SPIRV entries share their code, should be 3", num_shared);
+
+    SDL_free(data);
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL allocate_on_thread(void *data)
+{
+    void *block = SDL_malloc(*(size_t *)data);
+    SDL_free(block);
+    return block != NULL;
+}
+
+static int SDLCALL shadercross_MemoryStats(void *args)
+{
+    SDL_ShaderCross_MemoryStats stats;
+    SDL_Thread *thread;
+    size_t thread_size = 1 << 20;
+    void *block;
+
+    (void)args;
+    if (!memory_stats_enabled) {
+        SDLTest_AssertPass("Memory statistics could not be enabled");
+        return TEST_SKIPPED;
+    }
+
+    SDLTest_AssertPass("Reset the memory statistics");
+    SDLTest_AssertCheck(SDL_ShaderCross_ResetMemoryStats(), "SDL_ShaderCross_ResetMemoryStats succeeds (%s)", SDL_GetError());
+    SDLTest_AssertCheck(SDL_ShaderCross_GetMemoryStats(&stats), "SDL_ShaderCross_GetMemoryStats succeeds (%s)", SDL_GetError());
+    SDLTest_AssertCheck(stats.total.num_allocations == 0, "num_allocations is %d, should be 0", (int)stats.total.num_allocations);
+    SDLTest_AssertCheck(!SDL_ShaderCross_GetMemoryStats(NULL), "SDL_ShaderCross_GetMemoryStats fails without stats");
+
+    SDLTest_AssertPass("Count an allocation of the calling thread");
+    SDL_ShaderCross_ResetMemoryStats();
+    block = SDL_malloc(1000);
+    SDL_free(block);
+    SDL_ShaderCross_GetMemoryStats(&stats);
+    SDLTest_AssertCheck(stats.total.num_allocations == 1, "num_allocations is %d, should be 1", (int)stats.total.num_allocations);
+    SDLTest_AssertCheck(stats.total.total_bytes == 1000, "total_bytes is %d, should be 1000", (int)stats.total.total_bytes);
+    SDLTest_AssertCheck(stats.total.peak_bytes == 1000, "peak_bytes is %d, should be 1000", (int)stats.total.peak_bytes);
+    SDLTest_AssertCheck(stats.stages[SDL_SHADERCROSS_MEMORYSTAGE_SHADERCROSS].total_bytes == 1000, "The allocation is charged to SDL_shadercross");
+
+    SDLTest_AssertPass("Don't count the allocations of other threads");
+    SDL_ShaderCross_ResetMemoryStats();
+    thread = SDL_CreateThread(allocate_on_thread, "allocate", &thread_size);
+    SDLTest_AssertCheck(thread != NULL, "SDL_CreateThread succeeds (%s)", SDL_GetError());
+    SDL_WaitThread(thread, NULL);
+    SDL_ShaderCross_GetMemoryStats(&stats);
+    SDLTest_AssertCheck(stats.total.peak_bytes < thread_size, "peak_bytes is %d, should not include the %d bytes of the other thread", (int)stats.total.peak_bytes, (int)thread_size);
+
+    if (SDL_ShaderCross_GetHLSLShaderFormats() & SDL_GPU_SHADERFORMAT_SPIRV) {
+        SDL_ShaderCross_HLSL_Info hlsl_info;
+        size_t spirv_size;
+        void *spirv;
+
+        SDLTest_AssertPass("Charge the allocations of DXC to its stage");
+        SDL_zero(hlsl_info);
+        hlsl_info.source = (const char *)simple_vert_hlsl;
+        hlsl_info.entrypoint = "main";
+        hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_VERTEX;
+        SDL_ShaderCross_ResetMemoryStats();
+        spirv = SDL_ShaderCross_CompileSPIRVFromHLSL(&hlsl_info, &spirv_size);
+        SDL_ShaderCross_GetMemoryStats(&stats);
+        SDLTest_AssertCheck(spirv != NULL, "SDL_ShaderCross_CompileSPIRVFromHLSL succeeds (%s)", SDL_GetError());
+        SDLTest_AssertCheck(stats.stages[SDL_SHADERCROSS_MEMORYSTAGE_DXC].num_allocations > 0, "DXC made %d allocations, should be more than 0", (int)stats.stages[SDL_SHADERCROSS_MEMORYSTAGE_DXC].num_allocations);
+        SDLTest_AssertCheck(stats.total.num_allocations >= stats.stages[SDL_SHADERCROSS_MEMORYSTAGE_DXC].num_allocations, "The total includes DXC");
+        SDL_free(spirv);
+    }
+    return TEST_COMPLETED;
+}
+
 static const SDLTest_TestCaseReference shadercrossInitQuit = {
     shadercross_testInitQuit, "shadercrossInitQuit", "Test SDL_ShaderCross_Init and SDL_ShaderCross_Quit", TEST_ENABLED
 };
@@ -331,6 +1319,18 @@ static const SDLTest_TestCaseReference shadercrossCompileHLSL = {
     shadercross_CompileHLSL_to_XXX, "shadercross_CompileHLSL", "Compile HLSL -> {DXBC, DXIL, SPIRV}", TEST_ENABLED
 };
 
+static const SDLTest_TestCaseReference shadercrossCompileHLSLRoundtripAuto = {
+    shadercross_CompileHLSL_RoundtripAuto, "shadercross_CompileHLSLRoundtripAuto", "Compile HLSL -> {DXBC, DXIL} with automatic roundtrip detection", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference shadercrossCompileHLSLShaderModel = {
+    shadercross_CompileHLSL_ShaderModel, "shadercross_CompileHLSLShaderModel", "Compile HLSL -> DXIL with a shader model and 16-bit types", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference shadercrossCompileHLSLIncludeBaseDirectory = {
+    shadercross_CompileHLSL_IncludeBaseDirectory, "shadercross_CompileHLSLIncludeBaseDirectory", "Compile HLSL -> SPIRV with includes relative to another directory", TEST_ENABLED
+};
+
 static const SDLTest_TestCaseReference shadercrossCompileSPIRV = {
     shadercross_CompileSPIRV_to_XXX, "shadercross_CompileSPIRV", "Compile SPIRV -> {DXBC, DXIL}", TEST_ENABLED
 };
@@ -343,12 +1343,45 @@ static const SDLTest_TestCaseReference shadercrossTranspileSPIRVToMSL = {
     shadercross_ReflectSPIRV, "shadercross_ReflectSPIRV", "Reflect SPIRV", TEST_ENABLED
 };
 
+static const SDLTest_TestCaseReference shadercrossReflectManyResources = {
+    shadercross_ReflectManyResources, "shadercross_ReflectManyResources", "Reflect and transpile a shader with more than 32 resources", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference shadercrossMSLArgumentBuffers = {
+    shadercross_MSLArgumentBuffers, "shadercross_MSLArgumentBuffers", "Transpile SPIRV -> MSL with argument buffers", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference shadercrossSpecializeSPIRV = {
+    shadercross_SpecializeSPIRV, "shadercross_SpecializeSPIRV", "Override SPIRV specialization constants", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference shadercrossWriteBundle = {
+    shadercross_WriteBundle, "shadercross_WriteBundle", "Check a bundle written by the command line tool", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference shadercrossMemoryStats = {
+    shadercross_MemoryStats, "shadercross_MemoryStats", "Track memory statistics per thread and per stage", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference shadercrossOpenBundle = {
+    shadercross_OpenBundle, "shadercross_OpenBundle", "Open valid and corrupt shader bundles from memory", TEST_ENABLED
+};
+
 static const SDLTest_TestCaseReference *shadercrossTests[] = {
     &shadercrossInitQuit,
     &shadercrossCompileHLSL,
+    &shadercrossCompileHLSLRoundtripAuto,
+    &shadercrossCompileHLSLShaderModel,
+    &shadercrossCompileHLSLIncludeBaseDirectory,
     &shadercrossCompileSPIRV,
     &shadercrossTranspileSPIRVToMSL,
     &shadercrossReflectSPIRV,
+    &shadercrossReflectManyResources,
+    &shadercrossMSLArgumentBuffers,
+    &shadercrossSpecializeSPIRV,
+    &shadercrossMemoryStats,
+    &shadercrossOpenBundle,
+    &shadercrossWriteBundle,
     NULL
 };
 
@@ -387,6 +1420,8 @@ int main(int argc, char *argv[])
     SDLTest_CommonState *state;
     SDLTest_TestSuiteRunner *runner;
 
+    memory_stats_enabled = SDL_ShaderCross_EnableMemoryStats();
+
     /* Initialize test framework */
     state = SDLTest_CommonCreateState(argv, 0);
     if (!state) {
@@ -402,9 +1437,14 @@ int main(int argc, char *argv[])
         consumed = SDLTest_CommonArg(state, i);
         if (!consumed) {
             /* Parse custom arguments here */
+            if (SDL_strcmp(argv[i], "--bundle") == 0 && argv[i + 1] != NULL) {
+                written_bundle_path = argv[i + 1];
+                consumed = 2;
+            }
         }
         if (consumed <= 0) {
             const char *options[] = {
+                "[--bundle FILE]",
                 NULL
             };
             SDLTest_CommonLogUsage(state, argv[0], options);